@@ -0,0 +1,37 @@
+#include "AllocatorEngine.h"
+
+// Instantiates the allocator specializations: 3 fit policies x 3 free indexes
+// x 2 header layouts. Strategy switches at runtime go through
+// AllocatorEngine::withStrategy, which keeps the index and layout.
+
+template <class Layout>
+static std::unique_ptr<AllocatorEngine> makeWithLayout(size_t totalSize, size_t capacity,
+                                                       MemoryManager::AllocationStrategy strategy,
+                                                       MemoryManager::FreeIndex index) {
+    switch (index) {
+        case MemoryManager::SIZE_TREE:
+            return makeEngineFromCore<SizeTreeIndex<Layout>, Layout>(
+                strategy, HeapCore<SizeTreeIndex<Layout>, Layout>(totalSize, capacity));
+        case MemoryManager::IN_BAND:
+            return makeEngineFromCore<SegregatedBinsIndex<Layout>, Layout>(
+                strategy, HeapCore<SegregatedBinsIndex<Layout>, Layout>(totalSize, capacity));
+        case MemoryManager::FREE_LIST:
+        default:
+            return makeEngineFromCore<FreeListIndex<Layout>, Layout>(
+                strategy, HeapCore<FreeListIndex<Layout>, Layout>(totalSize, capacity));
+    }
+}
+
+std::unique_ptr<AllocatorEngine> makeAllocatorEngine(size_t totalSize,
+                                                     MemoryManager::AllocationStrategy strategy,
+                                                     MemoryManager::FreeIndex index,
+                                                     MemoryManager::HeaderLayout layout,
+                                                     size_t capacity) {
+    switch (layout) {
+        case MemoryManager::COMPACT_HEADER:
+            return makeWithLayout<CompactHeaderLayout>(totalSize, capacity, strategy, index);
+        case MemoryManager::STANDARD_HEADER:
+        default:
+            return makeWithLayout<StandardHeaderLayout>(totalSize, capacity, strategy, index);
+    }
+}
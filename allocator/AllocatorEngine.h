@@ -0,0 +1,763 @@
+#ifndef ALLOCATOR_ENGINE_H
+#define ALLOCATOR_ENGINE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <cstdint>
+#include <vector>
+#include <map>
+#include <memory>
+#include <iostream>
+#include <iomanip>
+#include "MemoryManager.h"
+#include "AllocatorPolicies.h"
+#include "HeapScan.h"
+#include "PageMap.h"
+#include "PagePurger.h"
+
+// Type-erased allocator engine behind the MemoryManager facade.
+class AllocatorEngine {
+public:
+    virtual ~AllocatorEngine() {}
+
+    virtual void* allocate(size_t size) = 0;
+    virtual bool deallocate(void* ptr) = 0;
+    virtual bool deallocate(size_t block_id) = 0;
+
+    // Returns an engine with a different fit policy that takes over this
+    // engine's heap (same index and layout). This engine is left empty.
+    virtual std::unique_ptr<AllocatorEngine> withStrategy(MemoryManager::AllocationStrategy strategy) = 0;
+
+    virtual void dumpMemory() const = 0;
+    virtual double getInternalFragmentation() const = 0;
+    virtual double getExternalFragmentation() const = 0;
+    virtual size_t getUsedMemory() const = 0;
+    virtual size_t getLargestFreeBlock() const = 0;
+    // Walks every block (in parallel on large heaps); with `verify`, also
+    // checks the heap's invariants and lists violations in problems
+    virtual HeapScanTotals scanHeap(bool verify) const = 0;
+    // Page residency at `pageSize` (a power of two >= PageMap::GRANULE)
+    virtual MemoryManager::PageStats getPageStats(size_t pageSize) const = 0;
+    // Purging runs on pages of `pageSize`; a new page size restarts it
+    virtual void configurePurging(const MemoryManager::PurgeConfig& config, size_t pageSize) = 0;
+    virtual MemoryManager::PurgeStats getPurgeStats() const = 0;
+    virtual void purgeNow() = 0;
+
+    // Out-of-memory recovery (see MemoryManager::OomPolicy). compact() slides
+    // every allocated block to the bottom of the heap, leaving one free block
+    // on top, and calls `relocated` for each block it moves, in address order;
+    // returns the number of blocks moved. Blocks for which `pinned` returns
+    // true stay where they are, with free blocks below them. grow() extends the heap in place up
+    // to the capacity reserved when the engine was built.
+    virtual size_t compact(const MemoryManager::RelocationCallback& relocated,
+                           const MemoryManager::PinnedCallback& pinned, size_t& movedBytes) = 0;
+    virtual bool grow(size_t newSize) = 0;
+    virtual size_t getCapacity() const = 0;
+    // User pointer of an allocated block, or nullptr
+    virtual void* findBlock(size_t block_id) const = 0;
+    virtual size_t getAllocationSuccessCount() const = 0;
+    virtual size_t getAllocationFailureCount() const = 0;
+    virtual size_t getHeaderSize() const = 0;
+    // Start of the simulated heap (physical address 0)
+    virtual const char* getBaseAddress() const = 0;
+
+    virtual MemoryManager::BlockInfo getBlockInfo(void* ptr) const = 0;
+    virtual std::vector<MemoryManager::BlockInfo> getAllBlocks() const = 0;
+};
+
+// Heap state shared by every fit policy over the same index and layout, so a
+// strategy switch can move it into a differently specialized engine.
+template <class Index, class Layout>
+struct HeapCore {
+    typedef typename Layout::Header Header;
+
+    size_t totalMemorySize;
+    std::vector<char> physicalMemory;
+    Header* firstBlock;           // First block in memory
+    Index freeIndex;
+    BlockStartMap blockStarts;    // Offsets of all block headers
+    PageMap touched;              // Bytes written and not purged since
+    PagePurger purger;            // Page states and decay timers
+    uint64_t clock;               // Allocator operations so far
+
+    // Block tracking. The maps stay empty with an in-band index (IN_BAND),
+    // which keeps the requested size in the header and finds blocks through
+    // blockStarts instead.
+    size_t nextBlockId;
+    size_t allocatedBlocks;
+    std::map<void*, Header*> addressToHeader;
+    std::map<size_t, Header*> idToHeader;
+    std::map<size_t, size_t> idToRequestedSize;  // Track requested size per block
+
+    // Statistics
+    size_t allocationSuccessCount;
+    size_t allocationFailureCount;
+    size_t totalRequestedSize;
+    size_t totalAllocatedSize;
+
+    // `capacity` bytes are reserved up front so that grow() never moves the heap
+    explicit HeapCore(size_t totalSize, size_t capacity = 0)
+        : totalMemorySize(totalSize), firstBlock(nullptr),
+          clock(0), nextBlockId(1), allocatedBlocks(0), allocationSuccessCount(0), allocationFailureCount(0),
+          totalRequestedSize(0), totalAllocatedSize(0) {
+        physicalMemory.reserve(std::max(totalSize, capacity));
+        physicalMemory.resize(totalSize, 0);
+
+        // Create initial free block covering entire memory
+        freeIndex.reset(base());
+        firstBlock = reinterpret_cast<Header*>(base());
+        Layout::init(base(), firstBlock, totalMemorySize);
+        freeIndex.insert(firstBlock);
+        blockStarts.reset(totalMemorySize);
+        blockStarts.set(0);
+        touched.reset(totalMemorySize);
+        touched.touch(0, Layout::HEADER_SIZE);
+        purger.reset(totalMemorySize, 4096);
+        purger.write(0, Layout::HEADER_SIZE);
+    }
+
+    char* base() { return physicalMemory.data(); }
+    const char* base() const { return physicalMemory.data(); }
+};
+
+template <class Index, class Layout>
+std::unique_ptr<AllocatorEngine> makeEngineFromCore(MemoryManager::AllocationStrategy strategy,
+                                                    HeapCore<Index, Layout>&& core);
+
+// One allocator specialization. Fit, Index and Layout are resolved at compile
+// time, so allocate/free contain no strategy switch and header accesses are
+// direct field operations for the chosen layout.
+template <class Fit, class Index, class Layout>
+class AllocatorEngineT : public AllocatorEngine {
+public:
+    typedef typename Layout::Header Header;
+    static const size_t HEADER_SIZE = Layout::HEADER_SIZE;
+
+    explicit AllocatorEngineT(size_t totalSize, const Fit& fit = Fit())
+        : core(totalSize), fit(fit) {}
+
+    AllocatorEngineT(HeapCore<Index, Layout>&& core, const Fit& fit = Fit())
+        : core(std::move(core)), fit(fit) {}
+
+    // Every call is one tick of the purge clock, whether or not it succeeds
+    void* allocate(size_t size) override {
+        void* userPtr = allocateBlock(size);
+        advanceClock();
+        return userPtr;
+    }
+
+    bool deallocate(void* ptr) override {
+        bool freed = deallocateBlock(ptr);
+        advanceClock();
+        return freed;
+    }
+
+    bool deallocate(size_t block_id) override {
+        void* ptr = findBlock(block_id);
+        if (ptr == nullptr) {
+            advanceClock();
+            return false;
+        }
+        return deallocate(ptr);
+    }
+
+    std::unique_ptr<AllocatorEngine> withStrategy(MemoryManager::AllocationStrategy strategy) override {
+        return makeEngineFromCore<Index, Layout>(strategy, std::move(core));
+    }
+
+    void configurePurging(const MemoryManager::PurgeConfig& config, size_t pageSize) override {
+        bool wasEnabled = core.purger.enabled();
+        core.purger.configure(config);
+        if (pageSize == core.purger.getPageSize()) {
+            // Free pages were not tracked while purging was off
+            if (!wasEnabled && core.purger.enabled()) {
+                for (const Header* block = core.firstBlock; block != nullptr; block = nextPhysical(block)) {
+                    if (Layout::isFree(block)) {
+                        core.purger.freed(offsetOf(block) + HEADER_SIZE, Layout::blockSize(block) - HEADER_SIZE, core.clock);
+                    }
+                }
+            }
+            return;
+        }
+
+        // Rebuild page states at the new size: touched pages are resident,
+        // and pages inside free blocks start decaying now
+        core.purger.reset(core.totalMemorySize, pageSize);
+        for (size_t offset = 0; offset < core.totalMemorySize; offset += pageSize) {
+            size_t bytes = std::min(pageSize, core.totalMemorySize - offset);
+            if (core.touched.touched(offset, bytes)) core.purger.write(offset, bytes);
+        }
+        for (const Header* block = core.firstBlock; block != nullptr; block = nextPhysical(block)) {
+            if (Layout::isFree(block)) {
+                core.purger.freed(offsetOf(block) + HEADER_SIZE, Layout::blockSize(block) - HEADER_SIZE, core.clock);
+            }
+        }
+    }
+
+    MemoryManager::PurgeStats getPurgeStats() const override { return core.purger.stats(core.clock); }
+    void purgeNow() override {
+        if (core.purger.enabled()) {
+            core.purger.purgeAll(core.touched);
+            return;
+        }
+        // With purging off free pages are not tracked: find them by walking the heap
+        for (const Header* block = core.firstBlock; block != nullptr; block = nextPhysical(block)) {
+            if (Layout::isFree(block)) {
+                core.purger.purgeFree(offsetOf(block) + HEADER_SIZE, Layout::blockSize(block) - HEADER_SIZE, core.touched);
+            }
+        }
+    }
+
+    size_t compact(const MemoryManager::RelocationCallback& relocated,
+                   const MemoryManager::PinnedCallback& pinned, size_t& movedBytes) override {
+        size_t movedBlocks = 0;
+        movedBytes = 0;
+        core.freeIndex.reset(core.base());
+        core.blockStarts.reset(core.totalMemorySize);
+
+        // Moves only go down, so a block never overwrites one not yet visited
+        size_t dest = 0;
+        Header* last = nullptr;
+        for (size_t offset = 0; offset < core.totalMemorySize;) {
+            Header* block = reinterpret_cast<Header*>(core.base() + offset);
+            size_t size = Layout::blockSize(block);
+            if (!Layout::isFree(block)) {
+                if (dest != offset && pinned && pinned(core.base() + offset + HEADER_SIZE)) {
+                    // A pinned block stays put: the gap below it becomes a
+                    // free block, or slack in the block before it
+                    if (offset - dest >= HEADER_SIZE || last == nullptr) {
+                        placeFreeBlock(dest, offset - dest);
+                    } else {
+                        Layout::setBlockSize(last, Layout::blockSize(last) + (offset - dest));
+                        core.totalAllocatedSize += offset - dest;
+                    }
+                    dest = offset;
+                }
+                last = reinterpret_cast<Header*>(core.base() + dest);
+                if (dest != offset) {
+                    void* oldPtr = core.base() + offset + HEADER_SIZE;
+                    void* newPtr = core.base() + dest + HEADER_SIZE;
+                    std::memmove(last, block, size);
+                    if constexpr (!Index::IN_BAND) {
+                        core.addressToHeader.erase(oldPtr);
+                        core.addressToHeader[newPtr] = last;
+                        core.idToHeader[Layout::blockId(last)] = last;
+                    }
+                    core.touched.touch(dest, HEADER_SIZE + requestedSize(last));
+                    core.purger.write(dest, HEADER_SIZE + requestedSize(last));
+                    movedBlocks++;
+                    movedBytes += size;
+                    if (relocated) relocated(oldPtr, newPtr);
+                }
+                core.blockStarts.set(dest);
+                dest += size;
+            }
+            offset += size;
+        }
+
+        // Everything above `dest` becomes one free block, or slack in the
+        // last block if it cannot hold a header
+        size_t remaining = core.totalMemorySize - dest;
+        if (remaining >= HEADER_SIZE || last == nullptr) {
+            placeFreeBlock(dest, remaining);
+        } else if (remaining > 0) {
+            Layout::setBlockSize(last, Layout::blockSize(last) + remaining);
+            core.totalAllocatedSize += remaining;
+        }
+        core.firstBlock = reinterpret_cast<Header*>(core.base());
+        return movedBlocks;
+    }
+
+    bool grow(size_t newSize) override {
+        if (newSize <= core.totalMemorySize || newSize > core.physicalMemory.capacity()) {
+            return false;
+        }
+        Header* last = core.firstBlock;
+        for (Header* next = nextPhysical(last); next != nullptr; next = nextPhysical(next)) {
+            last = next;
+        }
+
+        size_t oldSize = core.totalMemorySize;
+        core.physicalMemory.resize(newSize, 0);   // Within capacity: the heap does not move
+        core.totalMemorySize = newSize;
+        core.blockStarts.resize(newSize);
+        core.touched.resize(newSize);
+        core.purger.resize(newSize);
+
+        // Extend a free last block, or append a new free block
+        if (Layout::isFree(last)) {
+            size_t lastSize = Layout::blockSize(last);
+            Layout::setBlockSize(last, lastSize + newSize - oldSize);
+            core.freeIndex.resized(last, lastSize);
+        } else {
+            Header* tail = reinterpret_cast<Header*>(core.base() + oldSize);
+            Layout::init(core.base(), tail, newSize - oldSize);
+            core.blockStarts.set(oldSize);
+            core.freeIndex.insert(tail);
+            core.touched.touch(oldSize, HEADER_SIZE);
+            core.purger.write(oldSize, HEADER_SIZE);
+        }
+        return true;
+    }
+
+    size_t getCapacity() const override { return core.physicalMemory.capacity(); }
+
+    // In-band tracking has no id map: this walks the heap
+    void* findBlock(size_t block_id) const override {
+        const Header* found = nullptr;
+        if constexpr (Index::IN_BAND) {
+            forEachAllocated([&found, block_id](const Header* block) {
+                if (Layout::blockId(block) != block_id) return true;
+                found = block;
+                return false;
+            });
+        } else {
+            auto it = core.idToHeader.find(block_id);
+            if (it != core.idToHeader.end()) found = it->second;
+        }
+        return found == nullptr ? nullptr : const_cast<char*>(reinterpret_cast<const char*>(found)) + HEADER_SIZE;
+    }
+
+    size_t getLargestFreeBlock() const override {
+        return scanHeap(false).largestFree;
+    }
+
+    double getInternalFragmentation() const override {
+        // Calculate internal fragmentation by iterating through allocated blocks
+        size_t totalAllocated = 0;
+        size_t totalRequested = 0;
+
+        forEachAllocated([this, &totalAllocated, &totalRequested](const Header* block) {
+            totalAllocated += Layout::blockSize(block) - HEADER_SIZE;
+            totalRequested += requestedSize(block);
+            return true;
+        });
+
+        if (totalAllocated == 0) return 0.0;
+
+        size_t wasted = totalAllocated - totalRequested;
+        return (static_cast<double>(wasted) / totalAllocated) * 100.0;
+    }
+
+    double getExternalFragmentation() const override {
+        if (core.totalMemorySize == 0) return 0.0;
+
+        // Usable space in free blocks, and in the largest one
+        HeapScanTotals totals = scanHeap(false);
+        if (totals.freeBlocks == 0) return 0.0;
+        size_t totalFreeUsable = totals.freeBytes - totals.freeBlocks * HEADER_SIZE;
+        size_t largestFreeUsable = totals.largestFree - HEADER_SIZE;
+
+        // External fragmentation = (total free - largest free) / total memory
+        size_t externalFrag = (totalFreeUsable > largestFreeUsable) ?
+                              (totalFreeUsable - largestFreeUsable) : 0;
+        return (static_cast<double>(externalFrag) / core.totalMemorySize) * 100.0;
+    }
+
+    HeapScanTotals scanHeap(bool verify) const override {
+        if (!verify) {
+            return ::scanHeap<Layout>(core.base(), core.totalMemorySize, core.blockStarts, false,
+                                      [](const Header*, size_t, HeapScanTotals&) {});
+        }
+
+        // Every allocated block must be tracked under its user pointer
+        HeapScanTotals totals = ::scanHeap<Layout>(
+            core.base(), core.totalMemorySize, core.blockStarts, true,
+            [this](const Header* block, size_t offset, HeapScanTotals& chunk) {
+                if (Index::IN_BAND || Layout::isFree(block)) return;
+                void* userPtr = const_cast<char*>(reinterpret_cast<const char*>(block)) + HEADER_SIZE;
+                auto it = core.addressToHeader.find(userPtr);
+                if (it == core.addressToHeader.end() || it->second != block) {
+                    chunk.report("allocated block at offset " + std::to_string(offset) + " is not tracked");
+                }
+            });
+
+        if (totals.blocks == 0 || totals.firstStart != 0 || totals.endOffset != core.totalMemorySize) {
+            totals.report("blocks do not cover the heap (walk reached offset " +
+                          std::to_string(totals.endOffset) + " of " + std::to_string(core.totalMemorySize) + ")");
+        }
+        if (totals.usedBlocks != core.allocatedBlocks) {
+            totals.report(std::to_string(totals.usedBlocks) + " allocated blocks in the heap, " +
+                          std::to_string(core.allocatedBlocks) + " tracked");
+        }
+        if (totals.usedBytes - totals.usedBlocks * HEADER_SIZE != core.totalAllocatedSize) {
+            totals.report("allocated bytes in the heap differ from the running total");
+        }
+
+        size_t indexed = 0;
+        size_t indexedUsed = 0;
+        core.freeIndex.forEach([&indexed, &indexedUsed](Header* block) {
+            indexed++;
+            if (!Layout::isFree(block)) indexedUsed++;
+            return true;
+        });
+        if (indexed != totals.freeBlocks) {
+            totals.report(std::to_string(totals.freeBlocks) + " free blocks in the heap, " +
+                          std::to_string(indexed) + " in the free index");
+        }
+        if (indexedUsed > 0) {
+            totals.report(std::to_string(indexedUsed) + " allocated blocks in the free index");
+        }
+        return totals;
+    }
+
+    MemoryManager::PageStats getPageStats(size_t pageSize) const override {
+        MemoryManager::PageStats stats = {pageSize, 0, 0, 0, 0, 0, 0};
+        stats.pages = (core.totalMemorySize + pageSize - 1) / pageSize;
+
+        // Mark pages overlapping an allocated block, and pages holding a free
+        // block's header; whatever is left is free payload only
+        enum { LIVE = 1, HEADER = 2 };
+        std::vector<uint8_t> flags(stats.pages, 0);
+        auto mark = [&flags, pageSize](size_t offset, size_t bytes, uint8_t flag) {
+            for (size_t page = offset / pageSize; page <= (offset + bytes - 1) / pageSize; page++) {
+                flags[page] |= flag;
+            }
+        };
+        for (const Header* block = core.firstBlock; block != nullptr; block = nextPhysical(block)) {
+            if (Layout::isFree(block)) {
+                mark(offsetOf(block), HEADER_SIZE, HEADER);
+            } else {
+                mark(offsetOf(block), Layout::blockSize(block), LIVE);
+            }
+        }
+
+        for (size_t page = 0; page < stats.pages; page++) {
+            size_t offset = page * pageSize;
+            size_t bytes = std::min(pageSize, core.totalMemorySize - offset);
+            bool resident = core.touched.touched(offset, bytes);
+            if (resident) {
+                stats.residentPages++;
+                stats.residentBytes += bytes;
+            }
+            if (flags[page] & LIVE) stats.livePages++;
+            if (flags[page] == 0) {
+                stats.freePages++;
+                if (resident) stats.reclaimablePages++;
+            }
+        }
+        return stats;
+    }
+
+    size_t getUsedMemory() const override {
+        size_t used = 0;
+
+        // Iterate through all allocated blocks and sum their actual sizes (including headers)
+        forEachAllocated([&used](const Header* block) {
+            used += Layout::blockSize(block);
+            return true;
+        });
+        return used;
+    }
+
+    size_t getAllocationSuccessCount() const override { return core.allocationSuccessCount; }
+    size_t getAllocationFailureCount() const override { return core.allocationFailureCount; }
+    size_t getHeaderSize() const override { return HEADER_SIZE; }
+    const char* getBaseAddress() const override { return core.base(); }
+
+    void dumpMemory() const override {
+        std::cout << "\n=== Memory Dump ===\n";
+
+        size_t maxIterations = 1000;
+        size_t iterations = 0;
+        for (const Header* current = core.firstBlock; current != nullptr && iterations < maxIterations;
+             current = nextPhysical(current), iterations++) {
+            size_t address = offsetOf(current);
+            size_t blockSize = Layout::blockSize(current);
+
+            std::cout << std::hex << std::setfill('0');
+            std::cout << "[0x" << std::setw(8) << address << " - 0x"
+                      << std::setw(8) << (address + blockSize - 1) << "] ";
+            std::cout << std::dec;
+
+            if (Layout::isFree(current)) {
+                std::cout << "FREE";
+            } else {
+                std::cout << "USED (id=" << Layout::blockId(current) << ", size="
+                          << (blockSize - HEADER_SIZE) << " bytes)";
+            }
+            std::cout << "\n";
+        }
+        std::cout << "==================\n\n";
+    }
+
+    MemoryManager::BlockInfo getBlockInfo(void* ptr) const override {
+        MemoryManager::BlockInfo info = {0, nullptr, 0, false};
+        Header* header = getHeader(ptr);
+        if (header != nullptr) {
+            info.block_id = Layout::blockId(header);
+            info.address = ptr;
+            info.size = Layout::blockSize(header) - HEADER_SIZE;
+            info.is_free = Layout::isFree(header);
+        }
+        return info;
+    }
+
+    std::vector<MemoryManager::BlockInfo> getAllBlocks() const override {
+        std::vector<MemoryManager::BlockInfo> blocks;
+        forEachAllocated([&blocks](const Header* header) {
+            MemoryManager::BlockInfo info;
+            info.block_id = Layout::blockId(header);
+            info.address = const_cast<char*>(reinterpret_cast<const char*>(header)) + HEADER_SIZE;
+            info.size = Layout::blockSize(header) - HEADER_SIZE;
+            info.is_free = Layout::isFree(header);
+            blocks.push_back(info);
+            return true;
+        });
+        return blocks;
+    }
+
+private:
+    HeapCore<Index, Layout> core;
+    Fit fit;
+
+    void* allocateBlock(size_t size) {
+        if (size == 0 || size > core.totalMemorySize) {
+            core.allocationFailureCount++;
+            return nullptr;
+        }
+
+        // Add header size to requested size
+        size_t requiredSize = size + HEADER_SIZE;
+        core.totalRequestedSize += size;
+
+        Header* block = fit.template find<Layout>(core.freeIndex, core.blockStarts, requiredSize);
+        if (block == nullptr) {
+            core.allocationFailureCount++;
+            return nullptr;
+        }
+
+        // Remove from free index, then split off the remainder if it is large
+        // enough to hold another block
+        core.freeIndex.remove(block);
+        if (Layout::blockSize(block) >= requiredSize + HEADER_SIZE + 8) {
+            splitBlock(block, requiredSize);
+        }
+
+        // Mark as allocated
+        Layout::setFree(block, false);
+        Layout::setBlockId(block, core.nextBlockId++);
+
+        // Track allocation
+        void* userPtr = reinterpret_cast<char*>(block) + HEADER_SIZE;
+        if constexpr (Index::IN_BAND) {
+            Layout::setRequestedSize(block, size);
+        } else {
+            size_t id = Layout::blockId(block);
+            core.addressToHeader[userPtr] = block;
+            core.idToHeader[id] = block;
+            core.idToRequestedSize[id] = size;  // Store requested size
+        }
+        core.allocatedBlocks++;
+
+        core.totalAllocatedSize += (Layout::blockSize(block) - HEADER_SIZE);
+        core.allocationSuccessCount++;
+        // Assume the program writes what it asked for
+        core.touched.touch(offsetOf(block), HEADER_SIZE + size);
+        core.purger.write(offsetOf(block), HEADER_SIZE + size);
+
+        return userPtr;
+    }
+
+    bool deallocateBlock(void* ptr) {
+        if (!isValidPointer(ptr)) {
+            return false;
+        }
+
+        Header* block = getHeader(ptr);
+        if (block == nullptr || Layout::isFree(block)) {
+            return false;
+        }
+
+        // Mark as free
+        size_t id = Layout::blockId(block);
+        Layout::setFree(block, true);
+        core.totalAllocatedSize -= (Layout::blockSize(block) - HEADER_SIZE);
+
+        // Add to free index
+        size_t blockStart = offsetOf(block);
+        size_t blockEnd = blockStart + Layout::blockSize(block);
+        core.freeIndex.insert(block);
+        Header* merged = coalesceBlocks(block);
+
+        // Only the pages this free can complete are new to the purger: those
+        // under the block itself, its header, and the next block's header
+        // if that was absorbed. The rest of the merged block was already free.
+        if (core.purger.enabled()) {
+            size_t pageSize = core.purger.getPageSize();
+            size_t from = std::max(offsetOf(merged) + HEADER_SIZE, blockStart / pageSize * pageSize);
+            size_t to = std::min(offsetOf(merged) + Layout::blockSize(merged),
+                                 (blockEnd + HEADER_SIZE + pageSize - 1) / pageSize * pageSize);
+            if (to > from) core.purger.freed(from, to - from, core.clock);
+        }
+
+        // Remove from tracking
+        if constexpr (!Index::IN_BAND) {
+            core.idToRequestedSize.erase(id);
+            core.addressToHeader.erase(ptr);
+            core.idToHeader.erase(id);
+        }
+        core.allocatedBlocks--;
+
+        return true;
+    }
+
+    // Writes a free block header over [offset, offset + size) during compaction
+    void placeFreeBlock(size_t offset, size_t size) {
+        Header* block = reinterpret_cast<Header*>(core.base() + offset);
+        Layout::init(core.base(), block, size);
+        core.blockStarts.set(offset);
+        core.freeIndex.insert(block);
+        core.touched.touch(offset, HEADER_SIZE);
+        core.purger.write(offset, HEADER_SIZE);
+        core.purger.freed(offset + HEADER_SIZE, size - HEADER_SIZE, core.clock);
+    }
+
+    void advanceClock() {
+        core.clock++;
+        core.purger.tick(core.clock, core.touched);
+    }
+
+    size_t offsetOf(const Header* block) const {
+        return reinterpret_cast<const char*>(block) - core.base();
+    }
+
+    // Next block in physical memory, or nullptr past the end
+    const Header* nextPhysical(const Header* block) const {
+        size_t next = offsetOf(block) + Layout::blockSize(block);
+        if (next >= core.totalMemorySize) return nullptr;
+        return reinterpret_cast<const Header*>(core.base() + next);
+    }
+
+    Header* nextPhysical(Header* block) {
+        return const_cast<Header*>(static_cast<const AllocatorEngineT*>(this)->nextPhysical(block));
+    }
+
+    void splitBlock(Header* block, size_t requestedSize) {
+        size_t remainingSize = Layout::blockSize(block) - requestedSize;
+        // Need at least HEADER_SIZE to create a new block
+        // Add a small threshold (8 bytes) to avoid creating blocks with very little usable space
+        if (remainingSize < HEADER_SIZE + 8) { // Too small to split
+            return;
+        }
+
+        // Create new free block from remaining space
+        Header* newBlock = reinterpret_cast<Header*>(reinterpret_cast<char*>(block) + requestedSize);
+        Layout::init(core.base(), newBlock, remainingSize);
+        Layout::setBlockSize(block, requestedSize);
+        core.blockStarts.set(offsetOf(newBlock));
+        core.touched.touch(offsetOf(newBlock), HEADER_SIZE);
+        core.purger.write(offsetOf(newBlock), HEADER_SIZE);
+
+        core.freeIndex.insert(newBlock);
+    }
+
+    // Returns the free block that `block` ended up in
+    Header* coalesceBlocks(Header* block) {
+        // Try to merge with next block in physical memory
+        Header* next = nextPhysical(block);
+        if (next != nullptr && Layout::isFree(next)) {
+            core.freeIndex.remove(next);
+            size_t oldSize = Layout::blockSize(block);
+            Layout::setBlockSize(block, oldSize + Layout::blockSize(next));
+            core.freeIndex.resized(block, oldSize);
+            core.blockStarts.clear(offsetOf(next));
+        }
+
+        // Try to merge with previous block in physical memory: the nearest
+        // block start below this one in the block-start bitmap
+        size_t offset = offsetOf(block);
+        size_t prevOffset = core.blockStarts.findPrev(offset);
+        Header* prev = prevOffset < offset ? reinterpret_cast<Header*>(core.base() + prevOffset) : nullptr;
+
+        if (prev != nullptr && Layout::isFree(prev)) {
+            core.freeIndex.remove(block);
+            size_t oldSize = Layout::blockSize(prev);
+            Layout::setBlockSize(prev, oldSize + Layout::blockSize(block));
+            core.freeIndex.resized(prev, oldSize);
+            core.blockStarts.clear(offsetOf(block));
+            // Recursively try to coalesce the merged block
+            return coalesceBlocks(prev);
+        }
+        return block;
+    }
+
+    bool isValidPointer(void* ptr) const {
+        if (ptr == nullptr) return false;
+        uintptr_t addr = reinterpret_cast<uintptr_t>(ptr);
+        uintptr_t base = reinterpret_cast<uintptr_t>(core.base());
+        uintptr_t end = base + core.totalMemorySize;
+        return addr >= base && addr < end;
+    }
+
+    // Header of an allocated block from its user pointer, or nullptr
+    Header* getHeader(void* ptr) const {
+        if constexpr (Index::IN_BAND) {
+            // The header sits right before the data, so this reads memory the
+            // caller has likely just touched
+            if (!isValidPointer(ptr)) return nullptr;
+            size_t offset = static_cast<char*>(ptr) - core.base();
+            if (offset < HEADER_SIZE || !core.blockStarts.test(offset - HEADER_SIZE)) return nullptr;
+            Header* block = reinterpret_cast<Header*>(static_cast<char*>(ptr) - HEADER_SIZE);
+            return Layout::isFree(block) ? nullptr : block;
+        } else {
+            auto it = core.addressToHeader.find(ptr);
+            if (it != core.addressToHeader.end()) {
+                return it->second;
+            }
+            return nullptr;
+        }
+    }
+
+    size_t requestedSize(const Header* block) const {
+        if constexpr (Index::IN_BAND) {
+            return Layout::requestedSize(block);
+        } else {
+            auto it = core.idToRequestedSize.find(Layout::blockId(block));
+            return it == core.idToRequestedSize.end() ? 0 : it->second;
+        }
+    }
+
+    // Visits allocated blocks until fn returns false: in id order from the
+    // side maps, or in address order through the heap with in-band tracking
+    template <class Fn>
+    void forEachAllocated(Fn fn) const {
+        if constexpr (Index::IN_BAND) {
+            for (const Header* block = core.firstBlock; block != nullptr; block = nextPhysical(block)) {
+                if (!Layout::isFree(block) && !fn(block)) return;
+            }
+        } else {
+            for (const auto& pair : core.idToHeader) {
+                if (!Layout::isFree(pair.second) && !fn(pair.second)) return;
+            }
+        }
+    }
+};
+
+template <class Index, class Layout>
+std::unique_ptr<AllocatorEngine> makeEngineFromCore(MemoryManager::AllocationStrategy strategy,
+                                                    HeapCore<Index, Layout>&& core) {
+    switch (strategy) {
+        case MemoryManager::BEST_FIT:
+            return std::unique_ptr<AllocatorEngine>(
+                new AllocatorEngineT<BestFitPolicy, Index, Layout>(std::move(core)));
+        case MemoryManager::WORST_FIT:
+            return std::unique_ptr<AllocatorEngine>(
+                new AllocatorEngineT<WorstFitPolicy, Index, Layout>(std::move(core)));
+        case MemoryManager::FIRST_FIT:
+        default:
+            return std::unique_ptr<AllocatorEngine>(
+                new AllocatorEngineT<FirstFitPolicy, Index, Layout>(std::move(core)));
+    }
+}
+
+// Builds the engine for a (strategy, index, layout) combination, reserving
+// `capacity` bytes for heap growth (AllocatorDispatch.cpp)
+std::unique_ptr<AllocatorEngine> makeAllocatorEngine(size_t totalSize,
+                                                     MemoryManager::AllocationStrategy strategy,
+                                                     MemoryManager::FreeIndex index,
+                                                     MemoryManager::HeaderLayout layout,
+                                                     size_t capacity = 0);
+
+#endif // ALLOCATOR_ENGINE_H
@@ -0,0 +1,617 @@
+#ifndef ALLOCATOR_POLICIES_H
+#define ALLOCATOR_POLICIES_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <vector>
+#include "MemoryManager.h"
+#include "HeapScan.h"
+
+// Policies that AllocatorEngineT<Fit, Index, Layout> is composed from.
+//
+//   Layout - how a block header is laid out in physicalMemory
+//   Index  - how free blocks are found (built on the Layout's link fields)
+//   Fit    - which free block an allocation takes (built on the Index)
+//
+// Every combination compiles into its own code path; MemoryManager picks one
+// at runtime through AllocatorEngine (AllocatorEngine.h).
+
+// ---------------------------------------------------------------------------
+// Header layouts
+// ---------------------------------------------------------------------------
+
+// The original header: native pointers for the free-list links.
+struct StandardHeaderLayout {
+    struct Header {
+        size_t size;              // Size of this block (including header)
+        bool is_free;             // Allocation status
+        size_t block_id;          // Unique block identifier
+        union {
+            Header* next;         // Next block in the free list
+            size_t requested;     // Requested size of an allocated block (in-band tracking)
+        };
+        Header* prev;             // Previous block in the free list
+    };
+
+    static const size_t HEADER_SIZE = sizeof(Header);
+    static const size_t MAX_HEAP_SIZE = SIZE_MAX;
+
+    static void init(char*, Header* h, size_t size) {
+        h->size = size;
+        h->is_free = true;
+        h->block_id = 0;
+        h->next = nullptr;
+        h->prev = nullptr;
+    }
+
+    static size_t blockSize(const Header* h) { return h->size; }
+    static void setBlockSize(Header* h, size_t size) { h->size = size; }
+    static bool isFree(const Header* h) { return h->is_free; }
+    static void setFree(Header* h, bool is_free) { h->is_free = is_free; }
+    static size_t blockId(const Header* h) { return h->block_id; }
+    static void setBlockId(Header* h, size_t id) { h->block_id = id; }
+
+    static Header* next(char*, const Header* h) { return h->next; }
+    static Header* prev(char*, const Header* h) { return h->prev; }
+    static void setNext(char*, Header* h, Header* next) { h->next = next; }
+    static void setPrev(char*, Header* h, Header* prev) { h->prev = prev; }
+
+    // Allocated blocks are not linked, so the link field is free to use
+    static size_t requestedSize(const Header* h) { return h->requested; }
+    static void setRequestedSize(Header* h, size_t size) { h->requested = size; }
+};
+
+// 16-byte header: 31-bit size with the free flag in the top bit, a 32-bit id,
+// and free-list links stored as 32-bit offsets (+1, so 0 means null).
+// Halves per-block overhead for heaps up to 2 GB.
+struct CompactHeaderLayout {
+    struct Header {
+        uint32_t size_and_flags;
+        uint32_t block_id;
+        uint32_t next;            // Requested size while allocated (in-band tracking)
+        uint32_t prev;
+    };
+
+    static const size_t HEADER_SIZE = sizeof(Header);
+    static const size_t MAX_HEAP_SIZE = 0x7FFFFFFFu;
+    static const uint32_t FREE_FLAG = 0x80000000u;
+
+    static void init(char*, Header* h, size_t size) {
+        h->size_and_flags = static_cast<uint32_t>(size) | FREE_FLAG;
+        h->block_id = 0;
+        h->next = 0;
+        h->prev = 0;
+    }
+
+    static size_t blockSize(const Header* h) { return h->size_and_flags & ~FREE_FLAG; }
+    static void setBlockSize(Header* h, size_t size) {
+        h->size_and_flags = static_cast<uint32_t>(size) | (h->size_and_flags & FREE_FLAG);
+    }
+    static bool isFree(const Header* h) { return (h->size_and_flags & FREE_FLAG) != 0; }
+    static void setFree(Header* h, bool is_free) {
+        h->size_and_flags = is_free ? (h->size_and_flags | FREE_FLAG) : (h->size_and_flags & ~FREE_FLAG);
+    }
+    static size_t blockId(const Header* h) { return h->block_id; }
+    static void setBlockId(Header* h, size_t id) { h->block_id = static_cast<uint32_t>(id); }
+
+    static Header* next(char* base, const Header* h) { return fromLink(base, h->next); }
+    static Header* prev(char* base, const Header* h) { return fromLink(base, h->prev); }
+    static void setNext(char* base, Header* h, Header* next) { h->next = toLink(base, next); }
+    static void setPrev(char* base, Header* h, Header* prev) { h->prev = toLink(base, prev); }
+
+    static size_t requestedSize(const Header* h) { return h->next; }
+    static void setRequestedSize(Header* h, size_t size) { h->next = static_cast<uint32_t>(size); }
+
+private:
+    static Header* fromLink(char* base, uint32_t link) {
+        return link == 0 ? nullptr : reinterpret_cast<Header*>(base + (link - 1));
+    }
+    static uint32_t toLink(char* base, const Header* h) {
+        return h == nullptr ? 0 : static_cast<uint32_t>(reinterpret_cast<const char*>(h) - base) + 1;
+    }
+};
+
+// ---------------------------------------------------------------------------
+// Free-block indexes
+// ---------------------------------------------------------------------------
+
+// The original LIFO doubly-linked free list threaded through the headers.
+template <class Layout>
+class FreeListIndex {
+public:
+    typedef typename Layout::Header Header;
+    static const bool SIZE_ORDERED = false;
+    static const bool IN_BAND = false;
+
+    FreeListIndex() : base(nullptr), head(nullptr) {}
+
+    void reset(char* heap_base) {
+        base = heap_base;
+        head = nullptr;
+    }
+
+    void insert(Header* block) {
+        Layout::setNext(base, block, head);
+        Layout::setPrev(base, block, nullptr);
+        if (head != nullptr) {
+            Layout::setPrev(base, head, block);
+        }
+        head = block;
+    }
+
+    void remove(Header* block) {
+        Header* prev = Layout::prev(base, block);
+        Header* next = Layout::next(base, block);
+        if (prev != nullptr) {
+            Layout::setNext(base, prev, next);
+        } else {
+            head = next;
+        }
+        if (next != nullptr) {
+            Layout::setPrev(base, next, prev);
+        }
+        Layout::setNext(base, block, nullptr);
+        Layout::setPrev(base, block, nullptr);
+    }
+
+    // A free block grew or shrank in place; list order is unaffected
+    void resized(Header*, size_t) {}
+
+    // Visits free blocks in list order until fn returns false
+    template <class Fn>
+    void forEach(Fn fn) const {
+        for (Header* current = head; current != nullptr; current = Layout::next(base, current)) {
+            if (!fn(current)) return;
+        }
+    }
+
+private:
+    char* base;
+    Header* head;
+};
+
+// Address order for the size-ordered indexes, so first fit can take the
+// lowest-address block that fits instead of the smallest one. Each
+// CHUNK_BYTES of the heap has an upper bound on the free blocks starting in
+// it, kept in a max-tree (16 bytes per chunk, about heap / 1024). A lookup
+// descends to the first chunk whose bound fits and walks that chunk's blocks
+// through the engine's block-start bitmap, checking each header's free bit;
+// a chunk with nothing big enough gets its exact maximum as the new bound.
+// Frees only ever raise bounds, so they stay O(log chunks).
+template <class Layout>
+class AddressOrder {
+public:
+    typedef typename Layout::Header Header;
+    static const size_t CHUNK_BITS = 14;
+    static const size_t CHUNK_BYTES = size_t(1) << CHUNK_BITS;
+
+    void reset(char* heap_base) {
+        base = heap_base;
+        chunks = 0;
+        bounds.clear();
+    }
+
+    void insert(const Header* block) {
+        size_t offset = offsetOf(block);
+        reserve(offset + 1);
+        raise(offset >> CHUNK_BITS, Layout::blockSize(block));
+    }
+
+    // Nothing to do on remove: the chunk's bound is still an upper bound
+
+    void resized(const Header* block) { raise(offsetOf(block) >> CHUNK_BITS, Layout::blockSize(block)); }
+
+    // Lowest-address free block of at least `size` bytes; `starts` marks
+    // every block. Tightens the bounds it disproves, hence const with
+    // mutable bounds.
+    Header* first(size_t size, const BlockStartMap& starts) const {
+        for (size_t chunk = firstChunk(1, 0, chunks, 0, size); chunk < chunks;
+             chunk = firstChunk(1, 0, chunks, chunk + 1, size)) {
+            size_t begin = chunk << CHUNK_BITS;
+            size_t end = std::min(begin + CHUNK_BYTES, starts.coverage());
+            size_t largest = 0;
+            for (size_t offset = starts.findNext(begin, end); offset < end; offset = starts.findNext(offset + 1, end)) {
+                Header* block = reinterpret_cast<Header*>(base + offset);
+                if (!Layout::isFree(block)) continue;
+                size_t blockSize = Layout::blockSize(block);
+                if (blockSize >= size) return block;
+                largest = std::max(largest, blockSize);
+            }
+            lower(chunk, largest);
+        }
+        return nullptr;
+    }
+
+private:
+    char* base = nullptr;
+    size_t chunks = 0;                      // Leaves of the max-tree (a power of two)
+    mutable std::vector<size_t> bounds;     // Max-tree, leaves at [chunks, 2 * chunks)
+
+    size_t offsetOf(const Header* block) const { return reinterpret_cast<const char*>(block) - base; }
+
+    void reserve(size_t bytes) {
+        size_t needed = (bytes + CHUNK_BYTES - 1) >> CHUNK_BITS;
+        if (needed <= chunks) return;
+        size_t grown = std::max<size_t>(chunks, 1);
+        while (grown < needed) grown *= 2;
+        std::vector<size_t> tree(2 * grown, 0);
+        for (size_t chunk = 0; chunk < chunks; chunk++) tree[grown + chunk] = bounds[chunks + chunk];
+        for (size_t node = grown - 1; node > 0; node--) tree[node] = std::max(tree[2 * node], tree[2 * node + 1]);
+        bounds.swap(tree);
+        chunks = grown;
+    }
+
+    void raise(size_t chunk, size_t size) {
+        for (size_t node = chunks + chunk; node > 0 && bounds[node] < size; node /= 2) bounds[node] = size;
+    }
+
+    void lower(size_t chunk, size_t size) const {
+        size_t node = chunks + chunk;
+        bounds[node] = size;
+        for (node /= 2; node > 0; node /= 2) bounds[node] = std::max(bounds[2 * node], bounds[2 * node + 1]);
+    }
+
+    // First chunk at or after `from` in node's range [lo, hi) whose bound is at least `size`
+    size_t firstChunk(size_t node, size_t lo, size_t hi, size_t from, size_t size) const {
+        if (hi <= from || bounds.empty() || bounds[node] < size) return chunks;
+        if (hi - lo == 1) return lo;
+        size_t mid = (lo + hi) / 2;
+        size_t found = firstChunk(2 * node, lo, mid, from, size);
+        return found < chunks ? found : firstChunk(2 * node + 1, mid, hi, from, size);
+    }
+};
+
+// Free blocks ordered by (size, address) in a side tree: best and worst fit
+// become O(log n) lookups instead of full scans.
+template <class Layout>
+class SizeTreeIndex {
+public:
+    typedef typename Layout::Header Header;
+    static const bool SIZE_ORDERED = true;
+    static const bool IN_BAND = false;
+
+    SizeTreeIndex() {}
+
+    void reset(char* heap_base) {
+        bySize.clear();
+        byAddress.reset(heap_base);
+    }
+
+    void insert(Header* block) {
+        bySize.insert(std::make_pair(Layout::blockSize(block), block));
+        byAddress.insert(block);
+    }
+
+    void remove(Header* block) {
+        erase(Layout::blockSize(block), block);
+    }
+
+    void resized(Header* block, size_t old_size) {
+        erase(old_size, block);
+        bySize.insert(std::make_pair(Layout::blockSize(block), block));
+        byAddress.resized(block);
+    }
+
+    // Lowest-address free block of at least `size` bytes; `starts` marks
+    // every block in the heap
+    Header* firstByAddress(size_t size, const BlockStartMap& starts) const {
+        return byAddress.first(size, starts);
+    }
+
+    // Smallest free block of at least `size` bytes (lowest address among equals)
+    Header* lowerBound(size_t size) const {
+        auto it = bySize.lower_bound(size);
+        return it == bySize.end() ? nullptr : it->second;
+    }
+
+    // Largest free block (lowest address among equals)
+    Header* largest() const {
+        if (bySize.empty()) return nullptr;
+        auto it = bySize.lower_bound(std::prev(bySize.end())->first);
+        return it->second;
+    }
+
+    // Visits free blocks of at least `size` bytes in size order until fn returns false
+    template <class Fn>
+    void forEachAtLeast(size_t size, Fn fn) const {
+        for (auto it = bySize.lower_bound(size); it != bySize.end(); ++it) {
+            if (!fn(it->second)) return;
+        }
+    }
+
+    template <class Fn>
+    void forEach(Fn fn) const {
+        forEachAtLeast(0, fn);
+    }
+
+private:
+    std::multimap<size_t, Header*> bySize;
+    AddressOrder<Layout> byAddress;
+
+    void erase(size_t size, Header* block) {
+        auto range = bySize.equal_range(size);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second == block) {
+                bySize.erase(it);
+                return;
+            }
+        }
+    }
+};
+
+// Free blocks in size bins, each a list threaded through the headers like
+// FreeListIndex and sorted by (size, address). Sizes below 1 KB get a bin
+// each; above, every power of two is split into 8 bins, so a bin spans at
+// most 1/8 of its sizes. Answers the same queries as SizeTreeIndex (smallest
+// fitting block, largest block; lowest address among equals) from a bin's
+// head or tail, walking only the request's own bin past blocks too small for
+// it, with no per-block memory outside the heap. With this index the engine
+// also keeps block tracking in the headers (IN_BAND).
+template <class Layout>
+class SegregatedBinsIndex {
+public:
+    typedef typename Layout::Header Header;
+    static const bool SIZE_ORDERED = true;
+    static const bool IN_BAND = true;
+    static const size_t EXACT_BINS = 1024;     // One bin per size below this
+    static const size_t SUB_BINS = 8;
+    static const size_t BIN_COUNT = EXACT_BINS + (64 - 10) * SUB_BINS;
+    static const size_t BIN_WORDS = (BIN_COUNT + 63) / 64;
+
+    SegregatedBinsIndex() { reset(nullptr); }
+
+    void reset(char* heap_base) {
+        base = heap_base;
+        byAddress.reset(heap_base);
+        summary = 0;
+        for (size_t word = 0; word < BIN_WORDS; word++) nonEmpty[word] = 0;
+        for (size_t bin = 0; bin < BIN_COUNT; bin++) heads[bin] = tails[bin] = nullptr;
+    }
+
+    // Each bin is kept sorted by (size, address), so lookups take a head or
+    // tail. Inserting at either end is O(1); otherwise it walks the bin.
+    void insert(Header* block) {
+        size_t bin = binFor(Layout::blockSize(block));
+        Header* prev = nullptr;
+        Header* next = heads[bin];
+        if (next != nullptr && !before(block, next)) {
+            if (!before(block, tails[bin])) {
+                prev = tails[bin];
+                next = nullptr;
+            } else {
+                while (!before(block, next)) {
+                    prev = next;
+                    next = Layout::next(base, next);
+                }
+            }
+        }
+        Layout::setNext(base, block, next);
+        Layout::setPrev(base, block, prev);
+        if (prev != nullptr) {
+            Layout::setNext(base, prev, block);
+        } else {
+            heads[bin] = block;
+        }
+        if (next != nullptr) {
+            Layout::setPrev(base, next, block);
+        } else {
+            tails[bin] = block;
+        }
+        nonEmpty[bin >> 6] |= uint64_t(1) << (bin & 63);
+        summary |= uint64_t(1) << (bin >> 6);
+        byAddress.insert(block);
+    }
+
+    void remove(Header* block) {
+        unlink(block, binFor(Layout::blockSize(block)));
+    }
+
+    void resized(Header* block, size_t old_size) {
+        unlink(block, binFor(old_size));
+        insert(block);
+    }
+
+    // Lowest-address free block of at least `size` bytes; `starts` marks
+    // every block in the heap
+    Header* firstByAddress(size_t size, const BlockStartMap& starts) const {
+        return byAddress.first(size, starts);
+    }
+
+    // Smallest free block of at least `size` bytes (lowest address among equals)
+    Header* lowerBound(size_t size) const {
+        size_t bin = binFor(size);
+        // Only the request's own bin can hold blocks too small for it
+        if (tails[bin] != nullptr && Layout::blockSize(tails[bin]) >= size) {
+            Header* current = heads[bin];
+            while (Layout::blockSize(current) < size) current = Layout::next(base, current);
+            return current;
+        }
+        size_t higher = nextBin(bin + 1);
+        return higher == BIN_COUNT ? nullptr : heads[higher];
+    }
+
+    // Largest free block (lowest address among equals)
+    Header* largest() const {
+        if (summary == 0) return nullptr;
+        size_t word = 63 - static_cast<size_t>(__builtin_clzll(summary));
+        size_t bin = word * 64 + 63 - static_cast<size_t>(__builtin_clzll(nonEmpty[word]));
+        Header* found = tails[bin];
+        size_t size = Layout::blockSize(found);
+        for (Header* prev = Layout::prev(base, found); prev != nullptr && Layout::blockSize(prev) == size;
+             prev = Layout::prev(base, prev)) {
+            found = prev;
+        }
+        return found;
+    }
+
+    // Visits free blocks bin by bin (smallest bin first) until fn returns false
+    template <class Fn>
+    void forEach(Fn fn) const {
+        for (size_t bin = nextBin(0); bin < BIN_COUNT; bin = nextBin(bin + 1)) {
+            for (Header* current = heads[bin]; current != nullptr; current = Layout::next(base, current)) {
+                if (!fn(current)) return;
+            }
+        }
+    }
+
+private:
+    char* base;
+    AddressOrder<Layout> byAddress;
+    Header* heads[BIN_COUNT];           // Smallest block of each bin
+    Header* tails[BIN_COUNT];           // Largest block of each bin
+    uint64_t nonEmpty[BIN_WORDS];       // Bit per bin with at least one block
+    uint64_t summary;                   // Bit per non-zero nonEmpty word
+
+    // Sizes below EXACT_BINS get a bin each; above, the bin is the power of
+    // two and the next 3 bits below the top one
+    static size_t binFor(size_t size) {
+        if (size < EXACT_BINS) return size;
+        size_t top = 63 - static_cast<size_t>(__builtin_clzll(size));
+        return EXACT_BINS + (top - 10) * SUB_BINS + ((size >> (top - 3)) & (SUB_BINS - 1));
+    }
+
+    // First non-empty bin at or above `bin`, or BIN_COUNT
+    size_t nextBin(size_t bin) const {
+        if (bin >= BIN_COUNT) return BIN_COUNT;
+        size_t word = bin >> 6;
+        uint64_t bits = nonEmpty[word] & (~uint64_t(0) << (bin & 63));
+        if (bits == 0) {
+            uint64_t words = word + 1 < BIN_WORDS ? summary & (~uint64_t(0) << (word + 1)) : 0;
+            if (words == 0) return BIN_COUNT;
+            word = static_cast<size_t>(__builtin_ctzll(words));
+            bits = nonEmpty[word];
+        }
+        return word * 64 + static_cast<size_t>(__builtin_ctzll(bits));
+    }
+
+    // Bin order: by size, then by address
+    static bool before(const Header* a, const Header* b) {
+        size_t sizeA = Layout::blockSize(a);
+        size_t sizeB = Layout::blockSize(b);
+        return sizeA < sizeB || (sizeA == sizeB && a < b);
+    }
+
+    void unlink(Header* block, size_t bin) {
+        Header* prev = Layout::prev(base, block);
+        Header* next = Layout::next(base, block);
+        if (prev != nullptr) {
+            Layout::setNext(base, prev, next);
+        } else {
+            heads[bin] = next;
+            if (next == nullptr) {
+                nonEmpty[bin >> 6] &= ~(uint64_t(1) << (bin & 63));
+                if (nonEmpty[bin >> 6] == 0) summary &= ~(uint64_t(1) << (bin >> 6));
+            }
+        }
+        if (next != nullptr) {
+            Layout::setPrev(base, next, prev);
+        } else {
+            tails[bin] = prev;
+        }
+        Layout::setNext(base, block, nullptr);
+        Layout::setPrev(base, block, nullptr);
+    }
+};
+
+// ---------------------------------------------------------------------------
+// Fit policies
+// ---------------------------------------------------------------------------
+
+// Every policy gets the index and the heap's block-start bitmap, which marks
+// all blocks, free or not, and returns a free block of at least `size` bytes.
+
+// First block that fits: in free-list order on a list index, and the
+// lowest-address one on a size-ordered index (whose own order would make it
+// best fit)
+struct FirstFitPolicy {
+    template <class Layout, class Index>
+    typename Layout::Header* find(const Index& index, const BlockStartMap& starts, size_t size) const {
+        typedef typename Layout::Header Header;
+        if constexpr (Index::SIZE_ORDERED) {
+            return index.firstByAddress(size, starts);
+        } else {
+            (void)starts;
+            Header* found = nullptr;
+            index.forEach([&found, size](Header* block) {
+                if (Layout::isFree(block) && Layout::blockSize(block) >= size) {
+                    found = block;
+                    return false;
+                }
+                return true;
+            });
+            return found;
+        }
+    }
+};
+
+// Smallest block that fits
+struct BestFitPolicy {
+    template <class Layout, class Index>
+    typename Layout::Header* find(const Index& index, const BlockStartMap&, size_t size) const {
+        typedef typename Layout::Header Header;
+        if constexpr (Index::SIZE_ORDERED) {
+            return index.lowerBound(size);
+        } else {
+            Header* best = nullptr;
+            size_t iterations = 0;
+            const size_t maxIterations = 10000; // Safety limit to prevent infinite loops
+            index.forEach([&best, &iterations, size](Header* block) {
+                if (Layout::isFree(block) && Layout::blockSize(block) >= size) {
+                    if (best == nullptr || Layout::blockSize(block) < Layout::blockSize(best)) {
+                        best = block;
+                    }
+                }
+                return ++iterations < maxIterations;
+            });
+            return best;
+        }
+    }
+};
+
+// Largest block (if it fits)
+struct WorstFitPolicy {
+    template <class Layout, class Index>
+    typename Layout::Header* find(const Index& index, const BlockStartMap&, size_t size) const {
+        typedef typename Layout::Header Header;
+        if constexpr (Index::SIZE_ORDERED) {
+            Header* largest = index.largest();
+            return (largest != nullptr && Layout::blockSize(largest) >= size) ? largest : nullptr;
+        } else {
+            Header* worst = nullptr;
+            index.forEach([&worst, size](Header* block) {
+                if (Layout::isFree(block) && Layout::blockSize(block) >= size) {
+                    if (worst == nullptr || Layout::blockSize(block) > Layout::blockSize(worst)) {
+                        worst = block;
+                    }
+                }
+                return true;
+            });
+            return worst;
+        }
+    }
+};
+
+// The pre-template behaviour: switch on a runtime strategy for every call.
+// Not used by MemoryManager; kept as the baseline for the allocator benchmark.
+struct RuntimeFitPolicy {
+    MemoryManager::AllocationStrategy strategy;
+
+    explicit RuntimeFitPolicy(MemoryManager::AllocationStrategy strategy = MemoryManager::FIRST_FIT)
+        : strategy(strategy) {}
+
+    template <class Layout, class Index>
+    typename Layout::Header* find(const Index& index, const BlockStartMap& starts, size_t size) const {
+        switch (strategy) {
+            case MemoryManager::FIRST_FIT:
+                return FirstFitPolicy().find<Layout>(index, starts, size);
+            case MemoryManager::BEST_FIT:
+                return BestFitPolicy().find<Layout>(index, starts, size);
+            case MemoryManager::WORST_FIT:
+                return WorstFitPolicy().find<Layout>(index, starts, size);
+        }
+        return nullptr;
+    }
+};
+
+#endif // ALLOCATOR_POLICIES_H
@@ -0,0 +1,244 @@
+#ifndef HEAP_SCAN_H
+#define HEAP_SCAN_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../stats/Histogram.h"
+
+// One bit per heap byte, set where a block header starts. Block sizes are
+// not rounded, so any byte can be a boundary. A scan that starts at an
+// arbitrary offset finds the next boundary here, which lets the heap be cut
+// into chunks that are walked independently.
+class BlockStartMap {
+public:
+    void reset(size_t heap_bytes) {
+        words.assign((heap_bytes + 63) / 64, 0);
+        summary.assign((words.size() + 63) / 64, 0);
+    }
+    // Extends the map to a larger heap, keeping the existing bits
+    void resize(size_t heap_bytes) {
+        words.resize((heap_bytes + 63) / 64, 0);
+        summary.resize((words.size() + 63) / 64, 0);
+    }
+
+    void set(size_t offset) {
+        words[offset >> 6] |= uint64_t(1) << (offset & 63);
+        summary[offset >> 12] |= uint64_t(1) << ((offset >> 6) & 63);
+    }
+    void clear(size_t offset) {
+        words[offset >> 6] &= ~(uint64_t(1) << (offset & 63));
+        if (words[offset >> 6] == 0) summary[offset >> 12] &= ~(uint64_t(1) << ((offset >> 6) & 63));
+    }
+    bool test(size_t offset) const { return (words[offset >> 6] >> (offset & 63)) & 1; }
+    // Offsets the map covers: the heap size rounded up to 64
+    size_t coverage() const { return words.size() << 6; }
+
+    // First block start in [offset, limit), or `limit` if there is none
+    size_t findNext(size_t offset, size_t limit) const {
+        if (offset >= limit) return limit;
+        size_t word = offset >> 6;
+        uint64_t bits = words[word] & (~uint64_t(0) << (offset & 63));
+        size_t lastWord = (limit - 1) >> 6;
+        while (bits == 0) {
+            if (++word > lastWord) return limit;
+            bits = words[word];
+        }
+        size_t found = (word << 6) + static_cast<size_t>(__builtin_ctzll(bits));
+        return found < limit ? found : limit;
+    }
+
+    // Last block start before `offset`, or `offset` if there is none. Skips
+    // empty words through the summary, so a large block costs one summary
+    // bit per 4 KB rather than a word per 64 bytes.
+    size_t findPrev(size_t offset) const {
+        if (offset == 0) return offset;
+        size_t last = offset - 1;
+        size_t word = last >> 6;
+        uint64_t bits = words[word] & (~uint64_t(0) >> (63 - (last & 63)));
+        if (bits == 0) {
+            if (word == 0) return offset;
+            // Non-empty words strictly below `word`
+            size_t group = (word - 1) >> 6;
+            uint64_t groupBits = summary[group] & (~uint64_t(0) >> (63 - ((word - 1) & 63)));
+            while (groupBits == 0) {
+                if (group == 0) return offset;
+                groupBits = summary[--group];
+            }
+            word = (group << 6) + 63 - static_cast<size_t>(__builtin_clzll(groupBits));
+            bits = words[word];
+        }
+        return (word << 6) + 63 - static_cast<size_t>(__builtin_clzll(bits));
+    }
+
+private:
+    std::vector<uint64_t> words;
+    std::vector<uint64_t> summary;   // Bit per word: set if the word has a start
+};
+
+// Totals of a heap walk over one chunk, or over the whole heap once the
+// chunks are merged in address order.
+struct HeapScanTotals {
+    size_t blocks;
+    size_t usedBlocks;
+    size_t usedBytes;          // Including headers
+    size_t freeBlocks;
+    size_t freeBytes;          // Including headers
+    size_t largestFree;        // Block size including header
+    size_t adjacentFree;       // Free blocks directly after another free block
+    Histogram freeSizes;       // Usable bytes of each free block
+
+    // Chunk boundaries, so the merge can check that walks meet
+    size_t firstStart;         // First block start in the chunk (chunk end if none)
+    size_t endOffset;          // Where the walk stopped (a start in a later chunk)
+    bool firstFree;
+    bool lastFree;
+
+    std::vector<std::string> problems;
+
+    static const size_t MAX_PROBLEMS = 16;
+
+    HeapScanTotals()
+        : blocks(0), usedBlocks(0), usedBytes(0), freeBlocks(0), freeBytes(0), largestFree(0),
+          adjacentFree(0), firstStart(0), endOffset(0), firstFree(false), lastFree(false) {}
+
+    void report(const std::string& problem) {
+        if (problems.size() < MAX_PROBLEMS) problems.push_back(problem);
+    }
+
+    // Appends the totals of the chunk that follows this one
+    void merge(const HeapScanTotals& next) {
+        if (next.blocks > 0 && blocks > 0) {
+            if (endOffset != next.firstStart) {
+                report("walk ended at offset " + std::to_string(endOffset) +
+                       " but the next block starts at " + std::to_string(next.firstStart));
+            }
+            if (lastFree && next.firstFree) adjacentFree++;
+        }
+        if (blocks == 0) {
+            firstStart = next.firstStart;
+            firstFree = next.firstFree;
+        }
+        if (next.blocks > 0) {
+            lastFree = next.lastFree;
+            endOffset = next.endOffset;
+        }
+        blocks += next.blocks;
+        usedBlocks += next.usedBlocks;
+        usedBytes += next.usedBytes;
+        freeBlocks += next.freeBlocks;
+        freeBytes += next.freeBytes;
+        largestFree = std::max(largestFree, next.largestFree);
+        adjacentFree += next.adjacentFree;
+        freeSizes.merge(next.freeSizes);
+        for (const std::string& problem : next.problems) report(problem);
+    }
+};
+
+// Walks the blocks whose headers start in [lo, hi). With `verify`, also
+// checks each header against the heap bounds and the start bitmap, and calls
+// checkBlock(header, offset, totals) for engine-specific checks.
+template <class Layout, class Check>
+HeapScanTotals scanHeapChunk(const char* base, size_t total, const BlockStartMap& starts,
+                             size_t lo, size_t hi, bool verify, const Check& checkBlock) {
+    typedef typename Layout::Header Header;
+    HeapScanTotals totals;
+    size_t offset = starts.findNext(lo, hi);
+    totals.firstStart = offset;
+    totals.endOffset = offset;
+    bool previousFree = false;
+
+    while (offset < hi) {
+        const Header* block = reinterpret_cast<const Header*>(base + offset);
+        size_t size = Layout::blockSize(block);
+        if (size < Layout::HEADER_SIZE || size > total - offset) {
+            totals.report("block at offset " + std::to_string(offset) + " has invalid size " +
+                          std::to_string(size));
+            totals.endOffset = hi;
+            break;
+        }
+        size_t next = offset + size;
+
+        if (verify) {
+            if (starts.findNext(offset + 1, next) != next) {
+                totals.report("block start bit inside block at offset " + std::to_string(offset));
+            }
+            if (next < total && !starts.test(next)) {
+                totals.report("no start bit for the block after offset " + std::to_string(offset));
+            }
+            checkBlock(block, offset, totals);
+        }
+
+        bool isFree = Layout::isFree(block);
+        if (totals.blocks == 0) {
+            totals.firstFree = isFree;
+        } else if (isFree && previousFree) {
+            totals.adjacentFree++;
+        }
+        totals.blocks++;
+        if (isFree) {
+            totals.freeBlocks++;
+            totals.freeBytes += size;
+            totals.largestFree = std::max(totals.largestFree, size);
+            totals.freeSizes.add(size - Layout::HEADER_SIZE);
+        } else {
+            totals.usedBlocks++;
+            totals.usedBytes += size;
+        }
+        previousFree = isFree;
+        totals.lastFree = isFree;
+        totals.endOffset = next;
+        offset = next;
+    }
+    return totals;
+}
+
+// Scans the whole heap. Heaps below PARALLEL_MIN_BYTES per worker are walked
+// on the calling thread; larger ones are cut into chunks that worker threads
+// claim from a shared counter, and the per-chunk totals are merged in address
+// order, so the result is the same for any number of threads.
+template <class Layout, class Check>
+HeapScanTotals scanHeap(const char* base, size_t total, const BlockStartMap& starts,
+                        bool verify, const Check& checkBlock) {
+    const size_t PARALLEL_MIN_BYTES = 8 << 20;
+    const size_t CHUNKS_PER_WORKER = 4;
+
+    size_t workers = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()),
+                                      total / PARALLEL_MIN_BYTES);
+    if (workers <= 1) {
+        return scanHeapChunk<Layout>(base, total, starts, 0, total, verify, checkBlock);
+    }
+
+    size_t chunkCount = workers * CHUNKS_PER_WORKER;
+    size_t chunkBytes = (total + chunkCount - 1) / chunkCount;
+    std::vector<HeapScanTotals> chunks(chunkCount);
+    std::atomic<size_t> nextChunk(0);
+    auto worker = [&]() {
+        for (size_t c = nextChunk++; c < chunkCount; c = nextChunk++) {
+            size_t lo = std::min(total, c * chunkBytes);
+            size_t hi = std::min(total, lo + chunkBytes);
+            chunks[c] = scanHeapChunk<Layout>(base, total, starts, lo, hi, verify, checkBlock);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t t = 1; t < workers; t++) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    HeapScanTotals totals;
+    for (const HeapScanTotals& chunk : chunks) {
+        totals.merge(chunk);
+    }
+    return totals;
+}
+
+#endif // HEAP_SCAN_H
@@ -1,395 +1,356 @@
 #include "MemoryManager.h"
-#include <iostream>
+#include "AllocatorEngine.h"
 #include <algorithm>
-#include <cmath>
-#include <iomanip>
-#include <sstream>
 
-MemoryManager::MemoryManager(size_t totalSize, AllocationStrategy strategy)
-    : totalMemorySize(totalSize), currentStrategy(strategy),
-      physicalMemory(totalSize, 0), firstBlock(nullptr), freeListHead(nullptr),
-      nextBlockId(1), allocationSuccessCount(0), allocationFailureCount(0),
-      totalRequestedSize(0), totalAllocatedSize(0) {
-    initializeMemory();
+MemoryManager::MemoryManager(size_t totalSize, AllocationStrategy strategy,
+                             FreeIndex index, HeaderLayout layout)
+    : totalMemorySize(totalSize), currentStrategy(strategy), freeIndex(index), headerLayout(layout),
+      pageSize(4096), transientFailures(0), deferredCapacity(0), pinnedHandles(0), handleRelocations(0),
+      staleHandleUses(0) {
+    if (totalSize > getMaxHeapSize(layout)) {
+        headerLayout = STANDARD_HEADER;
+    }
+    engine = makeAllocatorEngine(totalMemorySize, currentStrategy, freeIndex, headerLayout);
 }
 
 MemoryManager::~MemoryManager() {
-    // Memory is managed by vector, no explicit cleanup needed
-}
-
-void MemoryManager::initializeMemory() {
-    // Create initial free block covering entire memory
-    firstBlock = reinterpret_cast<BlockHeader*>(physicalMemory.data());
-    firstBlock->size = totalMemorySize;
-    firstBlock->is_free = true;
-    firstBlock->block_id = 0; // Special ID for initial block
-    firstBlock->next = nullptr;
-    firstBlock->prev = nullptr;
-    
-    freeListHead = firstBlock;
-    addressToHeader[reinterpret_cast<void*>(firstBlock)] = firstBlock;
+    // Memory is owned by the engine
 }
 
 void* MemoryManager::allocate(size_t size) {
-    if (size == 0) {
-        allocationFailureCount++;
-        return nullptr;
-    }
-    
-    // Add header size to requested size
-    size_t requiredSize = size + sizeof(BlockHeader);
-    totalRequestedSize += size;
-    
-    BlockHeader* block = nullptr;
-    
-    switch (currentStrategy) {
-        case FIRST_FIT:
-            block = findFirstFit(requiredSize);
-            break;
-        case BEST_FIT:
-            block = findBestFit(requiredSize);
-            break;
-        case WORST_FIT:
-            block = findWorstFit(requiredSize);
-            break;
-    }
-    
-    if (block == nullptr) {
-        allocationFailureCount++;
-        return nullptr;
-    }
-    
-    // Split block if it's large enough to create another block
-    if (block->size >= requiredSize + sizeof(BlockHeader) + 8) {
-        splitBlock(block, requiredSize);
+    void* ptr = engine->allocate(size);
+    if (ptr != nullptr || size == 0) {
+        return ptr;
     }
-    
-    // Mark as allocated
-    block->is_free = false;
-    block->block_id = nextBlockId++;
-    
-    // Remove from free list
-    removeFromFreeList(block);
-    
-    // Track allocation
-    void* userPtr = reinterpret_cast<char*>(block) + sizeof(BlockHeader);
-    addressToHeader[userPtr] = block;
-    idToHeader[block->block_id] = block;
-    idToRequestedSize[block->block_id] = size;  // Store requested size
-    
-    totalAllocatedSize += (block->size - sizeof(BlockHeader));
-    allocationSuccessCount++;
-    
-    return userPtr;
+    bool canRecover = (oomPolicy.flushDeferred && !deferred.empty()) ||
+                      (oomPolicy.reclaim && reclaimCallback) || oomPolicy.compact ||
+                      oomPolicy.growLimit > totalMemorySize;
+    return canRecover ? recover(size) : nullptr;
 }
 
 bool MemoryManager::deallocate(void* ptr) {
-    if (!isValidPointer(ptr)) {
-        return false;
+    if (deferredCapacity == 0) {
+        if (!engine->deallocate(ptr)) {
+            return false;
+        }
+    } else {
+        // Queue it; the block stays allocated until the queue is flushed
+        BlockInfo info = engine->getBlockInfo(ptr);
+        if (info.address == nullptr || info.is_free ||
+            std::find(deferred.begin(), deferred.end(), ptr) != deferred.end()) {
+            return false;
+        }
+        deferred.push_back(ptr);
+        if (deferred.size() >= deferredCapacity) {
+            flushDeferredFrees();
+        }
     }
-    
-    BlockHeader* block = getHeader(ptr);
-    if (block == nullptr || block->is_free) {
-        return false;
+
+    // A handle block freed by pointer or ID takes its handle with it
+    if (!handleSlotByAddress.empty()) {
+        auto it = handleSlotByAddress.find(ptr);
+        if (it != handleSlotByAddress.end()) {
+            retireHandleSlot(it->second);
+        }
     }
-    
-    // Mark as free
-    block->is_free = true;
-    totalAllocatedSize -= (block->size - sizeof(BlockHeader));
-    
-    // Remove requested size tracking
-    idToRequestedSize.erase(block->block_id);
-    
-    // Add to free list
-    addToFreeList(block);
-    coalesceBlocks(block);
-    
-    // Remove from tracking
-    addressToHeader.erase(ptr);
-    idToHeader.erase(block->block_id);
-    
     return true;
 }
 
 bool MemoryManager::deallocate(size_t block_id) {
-    auto it = idToHeader.find(block_id);
-    if (it == idToHeader.end()) {
-        return false;
+    if (deferredCapacity == 0 && handleSlotByAddress.empty()) {
+        return engine->deallocate(block_id);
     }
-    
-    BlockHeader* block = it->second;
-    void* userPtr = reinterpret_cast<char*>(block) + sizeof(BlockHeader);
-    return deallocate(userPtr);
+    void* ptr = engine->findBlock(block_id);
+    return ptr != nullptr && deallocate(ptr);
 }
 
-void MemoryManager::setAllocationStrategy(AllocationStrategy strategy) {
-    if (strategy == currentStrategy) {
-        return;
+void MemoryManager::setDeferredFrees(size_t capacity) {
+    deferredCapacity = capacity;
+    if (deferred.size() >= capacity) {
+        flushDeferredFrees();
     }
-    
-    // Rebuild free lists for new strategy (Just reset strategy variable for list-based strategies)
-    // Actually, all current strategies (First, Best, Worst) share the same freeList structure/logic.
-    // They just traverse it differently. So no need to rebuild free list unless we had separate lists.
-    // In this implementation, `freeListHead` seems to be a single list.
-    
-    currentStrategy = strategy;
 }
 
-// First Fit: Find first block that fits
-MemoryManager::BlockHeader* MemoryManager::findFirstFit(size_t size) {
-    BlockHeader* current = freeListHead;
-    while (current != nullptr) {
-        if (current->is_free && current->size >= size) {
-            return current;
-        }
-        current = current->next;
+size_t MemoryManager::flushDeferredFrees() {
+    std::vector<void*> batch;
+    batch.swap(deferred);
+    for (void* ptr : batch) {
+        engine->deallocate(ptr);
     }
-    return nullptr;
+    return batch.size();
 }
 
-// Best Fit: Find smallest block that fits
-MemoryManager::BlockHeader* MemoryManager::findBestFit(size_t size) {
-    BlockHeader* best = nullptr;
-    BlockHeader* current = freeListHead;
-    size_t iterations = 0;
-    const size_t maxIterations = 10000; // Safety limit to prevent infinite loops
-    
-    while (current != nullptr && iterations < maxIterations) {
-        if (current->is_free && current->size >= size) {
-            if (best == nullptr || current->size < best->size) {
-                best = current;
-            }
+bool MemoryManager::setOomPolicy(const OomPolicy& policy) {
+    if (policy.growLimit > getMaxHeapSize(headerLayout)) {
+        return false;
+    }
+    if (policy.growLimit > engine->getCapacity()) {
+        // Reserving moves the heap, which is only safe while nothing points into it
+        if (engine->getAllocationSuccessCount() + engine->getAllocationFailureCount() > 0) {
+            return false;
         }
-        current = current->next;
-        iterations++;
+        engine = makeAllocatorEngine(totalMemorySize, currentStrategy, freeIndex, headerLayout, policy.growLimit);
+        engine->configurePurging(purgeConfig, pageSize);
     }
-    
-    return best;
+    oomPolicy = policy;
+    return true;
 }
 
-// Worst Fit: Find largest block that fits
-MemoryManager::BlockHeader* MemoryManager::findWorstFit(size_t size) {
-    BlockHeader* worst = nullptr;
-    BlockHeader* current = freeListHead;
-    
-    while (current != nullptr) {
-        if (current->is_free && current->size >= size) {
-            if (worst == nullptr || current->size > worst->size) {
-                worst = current;
+// Runs the enabled recovery steps after `size` failed to allocate, cheapest
+// first, retrying after each. Every retry is one more engine allocation, so
+// the failed attempts before it are not counted as allocation failures.
+void* MemoryManager::recover(size_t size) {
+    oomStats.pressureEvents++;
+    oomStats.lastStep = nullptr;
+    uint64_t cycles = 0;
+    void* ptr = nullptr;
+    auto retry = [this, size](const char* step) {
+        transientFailures++;
+        void* result = engine->allocate(size);
+        if (result != nullptr) oomStats.lastStep = step;
+        return result;
+    };
+    auto charge = [&cycles](uint64_t stepCycles, uint64_t& stepTotal, Histogram& stepLatency) {
+        cycles += stepCycles;
+        stepTotal += stepCycles;
+        stepLatency.add(stepCycles);
+    };
+
+    if (oomPolicy.flushDeferred && !deferred.empty()) {
+        size_t flushed = flushDeferredFrees();
+        oomStats.flushes++;
+        oomStats.flushedFrees += flushed;
+        charge(flushed * oomPolicy.flushCost, oomStats.flushCycles, oomStats.flushLatency);
+        ptr = retry("flush");
+    }
+
+    if (ptr == nullptr && oomPolicy.reclaim && reclaimCallback) {
+        oomStats.reclaims++;
+        charge(oomPolicy.reclaimCost, oomStats.reclaimCycles, oomStats.reclaimLatency);
+        size_t freed = reclaimCallback(size);
+        oomStats.reclaimedBytes += freed;
+        if (deferredCapacity > 0) {
+            flushDeferredFrees();   // The callback's frees may have been queued
+        }
+        if (freed > 0) {
+            ptr = retry("reclaim");
+        }
+    }
+
+    if (ptr == nullptr && oomPolicy.compact) {
+        // Queued frees and handle slots hold user pointers too
+        size_t movedBytes = 0;
+        MemoryManager::PinnedCallback pinned;
+        if (pinnedHandles > 0) {
+            pinned = [this](void* block) {
+                auto it = handleSlotByAddress.find(block);
+                return it != handleSlotByAddress.end() && handleSlots[it->second].pins > 0;
+            };
+        }
+        size_t moved = engine->compact([this](void* from, void* to) {
+            std::replace(deferred.begin(), deferred.end(), from, to);
+            auto it = handleSlotByAddress.find(from);
+            if (it != handleSlotByAddress.end()) {
+                uint32_t index = it->second;
+                handleSlotByAddress.erase(it);
+                handleSlotByAddress[to] = index;
+                handleSlots[index].ptr = to;
+                handleRelocations++;
             }
+            if (relocationCallback) relocationCallback(from, to);
+        }, pinned, movedBytes);
+        oomStats.compactions++;
+        oomStats.movedBlocks += moved;
+        oomStats.movedBytes += movedBytes;
+        charge(moved * oomPolicy.compactBlockCost + (movedBytes * oomPolicy.compactKiBCost + 1023) / 1024,
+               oomStats.compactCycles, oomStats.compactLatency);
+        if (moved > 0) {
+            ptr = retry("compact");
         }
-        current = current->next;
     }
-    
-    return worst;
-}
 
+    if (ptr == nullptr && oomPolicy.growLimit > totalMemorySize) {
+        // Grow by whole pages, enough for the block even if the top block is allocated
+        size_t needed = size + getHeaderSize();
+        size_t newSize = std::min(oomPolicy.growLimit,
+                                  totalMemorySize + (needed + pageSize - 1) / pageSize * pageSize);
+        if (engine->grow(newSize)) {
+            oomStats.grows++;
+            oomStats.grownBytes += newSize - totalMemorySize;
+            totalMemorySize = newSize;
+            charge(oomPolicy.growCost, oomStats.growCycles, oomStats.growLatency);
+            ptr = retry("grow");
+        }
+    }
 
+    if (ptr != nullptr) {
+        oomStats.recovered++;
+    }
+    oomStats.recoveryCycles += cycles;
+    oomStats.latency.add(cycles);
+    return ptr;
+}
 
-void MemoryManager::splitBlock(BlockHeader* block, size_t requestedSize) {
-    size_t remainingSize = block->size - requestedSize;
-    // Need at least sizeof(BlockHeader) to create a new block
-    // Add a small threshold (8 bytes) to avoid creating blocks with very little usable space
-    if (remainingSize < sizeof(BlockHeader) + 8) { // Too small to split
-        return;
+MemoryManager::Handle MemoryManager::allocHandle(size_t size) {
+    if (freeHandleSlots.empty() && handleSlots.size() >= (size_t(1) << HANDLE_INDEX_BITS)) {
+        return NULL_HANDLE;
     }
-    
-    // Create new free block from remaining space
-    BlockHeader* newBlock = reinterpret_cast<BlockHeader*>(
-        reinterpret_cast<char*>(block) + requestedSize);
-    newBlock->size = remainingSize;
-    newBlock->is_free = true;
-    newBlock->block_id = 0;
-    // Don't set prev/next here - they're used for free list, not physical order
-    // Physical order is determined by address arithmetic
-    
-    block->size = requestedSize;
-    
-    // Add new block to free list (this will set its next/prev for free list)
-    addToFreeList(newBlock);
-}
-
-void MemoryManager::coalesceBlocks(BlockHeader* block) {
-    // Try to merge with next block in physical memory
-    char* blockEnd = reinterpret_cast<char*>(block) + block->size;
-    if (blockEnd < physicalMemory.data() + totalMemorySize) {
-        BlockHeader* next = reinterpret_cast<BlockHeader*>(blockEnd);
-        if (next->is_free) {
-            removeFromFreeList(next);
-            block->size += next->size;
-        }
+    void* ptr = allocate(size);
+    if (ptr == nullptr) {
+        return NULL_HANDLE;
     }
-    
-    // Try to merge with previous block in physical memory
-    // Find the block that ends just before this block starts
-    BlockHeader* current = firstBlock;
-    char* blockStart = reinterpret_cast<char*>(block);
-    BlockHeader* prev = nullptr;
-    size_t iterations = 0;
-    const size_t maxIterations = 10000; // Safety limit
-    
-    while (current != nullptr && current != block && iterations < maxIterations) {
-        char* currentEnd = reinterpret_cast<char*>(current) + current->size;
-        if (currentEnd == blockStart) {
-            prev = current;
-            break;
-        }
-        // Move to next block in physical memory
-        if (currentEnd < physicalMemory.data() + totalMemorySize) {
-            current = reinterpret_cast<BlockHeader*>(currentEnd);
-        } else {
-            break;
+
+    uint32_t index;
+    if (freeHandleSlots.empty()) {
+        index = static_cast<uint32_t>(handleSlots.size());
+        HandleSlot slot = {nullptr, 1, 0};
+        handleSlots.push_back(slot);
+    } else {
+        index = freeHandleSlots.back();
+        freeHandleSlots.pop_back();
+    }
+    HandleSlot& slot = handleSlots[index];
+    slot.ptr = ptr;
+    slot.pins = 0;
+    handleSlotByAddress[ptr] = index;
+    return (slot.generation << HANDLE_INDEX_BITS) | index;
+}
+
+const MemoryManager::HandleSlot* MemoryManager::resolve(Handle handle) const {
+    uint32_t index = handle & ((uint32_t(1) << HANDLE_INDEX_BITS) - 1);
+    if (index < handleSlots.size()) {
+        const HandleSlot& slot = handleSlots[index];
+        if (slot.ptr != nullptr && slot.generation == handle >> HANDLE_INDEX_BITS) {
+            return &slot;
         }
-        iterations++;
     }
-    
-    if (prev != nullptr && prev->is_free) {
-        removeFromFreeList(block);
-        prev->size += block->size;
-        // Recursively try to coalesce the merged block
-        coalesceBlocks(prev);
+    staleHandleUses++;
+    return nullptr;
+}
+
+bool MemoryManager::freeHandle(Handle handle) {
+    // deallocate() retires the slot
+    const HandleSlot* slot = resolve(handle);
+    return slot != nullptr && deallocate(slot->ptr);
+}
+
+void MemoryManager::retireHandleSlot(uint32_t index) {
+    HandleSlot& slot = handleSlots[index];
+    if (slot.pins > 0) {
+        pinnedHandles--;
     }
+    handleSlotByAddress.erase(slot.ptr);
+    slot.ptr = nullptr;
+    slot.pins = 0;
+    // Generation 0 is skipped so that no handle is ever NULL_HANDLE
+    slot.generation = slot.generation + 1 == HANDLE_GENERATIONS ? 1 : slot.generation + 1;
+    freeHandleSlots.push_back(index);
 }
 
-void MemoryManager::addToFreeList(BlockHeader* block) {
-    // Safety check: if block is already in the free list, remove it first
-    // This prevents cycles and corruption
-    if (block->prev != nullptr || block->next != nullptr || block == freeListHead) {
-        removeFromFreeList(block);
+void* MemoryManager::pin(Handle handle) {
+    HandleSlot* slot = resolve(handle);
+    if (slot == nullptr) {
+        return nullptr;
     }
-    
-    block->next = freeListHead;
-    block->prev = nullptr;
-    if (freeListHead != nullptr) {
-        freeListHead->prev = block;
+    if (slot->pins++ == 0) {
+        pinnedHandles++;
     }
-    freeListHead = block;
+    return slot->ptr;
 }
 
-void MemoryManager::removeFromFreeList(BlockHeader* block) {
-    if (block->prev != nullptr) {
-        block->prev->next = block->next;
-    } else {
-        freeListHead = block->next;
+bool MemoryManager::unpin(Handle handle) {
+    HandleSlot* slot = resolve(handle);
+    if (slot == nullptr || slot->pins == 0) {
+        return false;
     }
-    if (block->next != nullptr) {
-        block->next->prev = block->prev;
+    if (--slot->pins == 0) {
+        pinnedHandles--;
     }
-    block->next = nullptr;
-    block->prev = nullptr;
+    return true;
 }
 
+bool MemoryManager::isLiveHandle(Handle handle) const {
+    uint32_t index = handle & ((uint32_t(1) << HANDLE_INDEX_BITS) - 1);
+    return index < handleSlots.size() && handleSlots[index].ptr != nullptr &&
+           handleSlots[index].generation == handle >> HANDLE_INDEX_BITS;
+}
 
+MemoryManager::BlockInfo MemoryManager::getHandleInfo(Handle handle) const {
+    const HandleSlot* slot = resolve(handle);
+    if (slot == nullptr) {
+        return BlockInfo{0, nullptr, 0, false};
+    }
+    return engine->getBlockInfo(slot->ptr);
+}
 
-bool MemoryManager::isValidPointer(void* ptr) const {
-    if (ptr == nullptr) return false;
-    uintptr_t addr = reinterpret_cast<uintptr_t>(ptr);
-    uintptr_t base = reinterpret_cast<uintptr_t>(physicalMemory.data());
-    uintptr_t end = base + totalMemorySize;
-    return addr >= base && addr < end;
+size_t MemoryManager::getPinCount(Handle handle) const {
+    const HandleSlot* slot = resolve(handle);
+    return slot == nullptr ? 0 : slot->pins;
 }
 
-MemoryManager::BlockHeader* MemoryManager::getHeader(void* ptr) const {
-    auto it = addressToHeader.find(ptr);
-    if (it != addressToHeader.end()) {
-        return it->second;
+std::vector<MemoryManager::Handle> MemoryManager::getLiveHandles() const {
+    std::vector<Handle> handles;
+    for (uint32_t index = 0; index < handleSlots.size(); index++) {
+        if (handleSlots[index].ptr != nullptr) {
+            handles.push_back((handleSlots[index].generation << HANDLE_INDEX_BITS) | index);
+        }
     }
-    return nullptr;
+    return handles;
 }
 
-size_t MemoryManager::getLargestFreeBlock() const {
-    size_t largest = 0;
-    
-    // Iterate through physical memory instead of free list to avoid potential cycles
-    const BlockHeader* current = firstBlock;
-    size_t address = 0;
-    size_t maxIterations = 1000;  // Safety limit
-    size_t iterations = 0;
-    
-    while (current != nullptr && address < totalMemorySize && iterations < maxIterations) {
-        if (current->is_free && current->size > largest) {
-            largest = current->size;
-        }
-        
-        address += current->size;
-        iterations++;
-        
-        // Move to next block
-        if (address < totalMemorySize) {
-            current = reinterpret_cast<const BlockHeader*>(
-                reinterpret_cast<const char*>(physicalMemory.data()) + address);
-        } else {
-            break;
-        }
+MemoryManager::HandleStats MemoryManager::getHandleStats() const {
+    HandleStats stats;
+    stats.live = handleSlots.size() - freeHandleSlots.size();
+    stats.pinned = pinnedHandles;
+    stats.slots = handleSlots.size();
+    stats.relocations = handleRelocations;
+    stats.staleUses = staleHandleUses;
+    return stats;
+}
+
+void MemoryManager::setAllocationStrategy(AllocationStrategy strategy) {
+    if (strategy == currentStrategy) {
+        return;
     }
     
-    return largest;
+    // The fit policy is a template parameter: hand the heap over to the
+    // engine specialized for the new strategy (same index and layout)
+    engine = engine->withStrategy(strategy);
+    currentStrategy = strategy;
 }
 
-double MemoryManager::getInternalFragmentation() const {
-    // Calculate internal fragmentation by iterating through allocated blocks
-    size_t totalAllocated = 0;
-    size_t totalRequested = 0;
-    
-    for (const auto& pair : idToHeader) {
-        const BlockHeader* block = pair.second;
-        if (!block->is_free) {
-            size_t usableSize = block->size - sizeof(BlockHeader);
-            totalAllocated += usableSize;
-            
-            // Get requested size for this block
-            auto it = idToRequestedSize.find(block->block_id);
-            if (it != idToRequestedSize.end()) {
-                totalRequested += it->second;
-            }
-        }
+size_t MemoryManager::getMaxHeapSize(HeaderLayout layout) {
+    if (layout == COMPACT_HEADER) {
+        return CompactHeaderLayout::MAX_HEAP_SIZE;
     }
-    
-    if (totalAllocated == 0) return 0.0;
-    
-    size_t wasted = totalAllocated - totalRequested;
-    return (static_cast<double>(wasted) / totalAllocated) * 100.0;
+    return StandardHeaderLayout::MAX_HEAP_SIZE;
 }
 
-double MemoryManager::getExternalFragmentation() const {
-    if (totalMemorySize == 0) return 0.0;
-    
-    // Calculate total free memory (usable space in free blocks)
-    size_t totalFreeUsable = 0;
-    size_t largestFreeUsable = 0;
-    
-    // Iterate through physical memory to find free blocks
-    const BlockHeader* current = firstBlock;
-    size_t address = 0;
-    size_t maxIterations = 1000;
-    size_t iterations = 0;
-    
-    while (current != nullptr && address < totalMemorySize && iterations < maxIterations) {
-        if (current->is_free) {
-            size_t usableSize = current->size - sizeof(BlockHeader);
-            totalFreeUsable += usableSize;
-            if (usableSize > largestFreeUsable) {
-                largestFreeUsable = usableSize;
-            }
-        }
-        
-        address += current->size;
-        iterations++;
-        
-        if (address < totalMemorySize) {
-            current = reinterpret_cast<const BlockHeader*>(
-                reinterpret_cast<const char*>(physicalMemory.data()) + address);
-        } else {
-            break;
-        }
+size_t MemoryManager::getHeaderSize() const {
+    return engine->getHeaderSize();
+}
+
+size_t MemoryManager::getOffset(const void* ptr) const {
+    return static_cast<const char*>(ptr) - engine->getBaseAddress();
+}
+
+void* MemoryManager::getPointer(size_t offset) const {
+    if (offset >= totalMemorySize) {
+        return nullptr;
     }
-    
-    if (totalFreeUsable == 0) return 0.0;
-    
-    // External fragmentation = (total free - largest free) / total memory
-    size_t externalFrag = (totalFreeUsable > largestFreeUsable) ? 
-                          (totalFreeUsable - largestFreeUsable) : 0;
-    return (static_cast<double>(externalFrag) / totalMemorySize) * 100.0;
+    return const_cast<char*>(engine->getBaseAddress()) + offset;
+}
+
+size_t MemoryManager::getLargestFreeBlock() const {
+    return engine->getLargestFreeBlock();
+}
+
+double MemoryManager::getInternalFragmentation() const {
+    return engine->getInternalFragmentation();
+}
+
+double MemoryManager::getExternalFragmentation() const {
+    return engine->getExternalFragmentation();
 }
 
 double MemoryManager::getMemoryUtilization() const {
@@ -398,17 +359,7 @@ double MemoryManager::getMemoryUtilization() const {
 }
 
 size_t MemoryManager::getUsedMemory() const {
-    size_t used = 0;
-    
-    // Iterate through all allocated blocks and sum their actual sizes (including headers)
-    for (const auto& pair : idToHeader) {
-        const BlockHeader* block = pair.second;
-        if (!block->is_free) {
-            used += block->size;  // Block size includes the header
-        }
-    }
-    
-    return used;
+    return engine->getUsedMemory();
 }
 
 size_t MemoryManager::getFreeMemory() const {
@@ -419,68 +370,74 @@ size_t MemoryManager::getFreeMemory() const {
     return totalMemorySize - used;
 }
 
-void MemoryManager::dumpMemory() const {
-    std::cout << "\n=== Memory Dump ===\n";
-    
-    // Iterate through physical memory
-    const BlockHeader* current = firstBlock;
-    size_t address = 0;
-    size_t maxIterations = 1000;
-    size_t iterations = 0;
-    
-    while (current != nullptr && address < totalMemorySize && iterations < maxIterations) {
-        size_t blockSize = current->size;
-        
-        std::cout << std::hex << std::setfill('0');
-        std::cout << "[0x" << std::setw(8) << address << " - 0x" 
-                  << std::setw(8) << (address + blockSize - 1) << "] ";
-        std::cout << std::dec;
-        
-        if (current->is_free) {
-            std::cout << "FREE";
-        } else {
-            std::cout << "USED (id=" << current->block_id << ", size=" 
-                      << (blockSize - sizeof(BlockHeader)) << " bytes)";
-        }
-        std::cout << "\n";
-        
-        address += blockSize;
-        iterations++;
-        
-        // Move to next block
-        if (address < totalMemorySize) {
-            current = reinterpret_cast<const BlockHeader*>(
-                reinterpret_cast<const char*>(physicalMemory.data()) + address);
-        } else {
-            break;
-        }
+size_t MemoryManager::getAllocationSuccessCount() const {
+    return engine->getAllocationSuccessCount();
+}
+
+size_t MemoryManager::getAllocationFailureCount() const {
+    return engine->getAllocationFailureCount() - transientFailures;
+}
+
+MemoryManager::HeapSnapshot MemoryManager::getHeapSnapshot() const {
+    HeapScanTotals totals = engine->scanHeap(false);
+    size_t header = engine->getHeaderSize();
+
+    HeapSnapshot snapshot;
+    snapshot.blocks = totals.blocks;
+    snapshot.usedBlocks = totals.usedBlocks;
+    snapshot.freeBlocks = totals.freeBlocks;
+    snapshot.freeBytes = totals.freeBytes - totals.freeBlocks * header;
+    snapshot.largestFreeBlock = totals.freeBlocks > 0 ? totals.largestFree - header : 0;
+    snapshot.uncoalescedFree = totals.adjacentFree;
+    snapshot.freeSizes = totals.freeSizes;
+    return snapshot;
+}
+
+std::vector<std::string> MemoryManager::verifyHeap() const {
+    return engine->scanHeap(true).problems;
+}
+
+bool MemoryManager::isValidPageSize(size_t size) {
+    return size >= PageMap::GRANULE && (size & (size - 1)) == 0;
+}
+
+bool MemoryManager::setPageSize(size_t size) {
+    if (!isValidPageSize(size)) {
+        return false;
     }
-    std::cout << "==================\n\n";
+    pageSize = size;
+    engine->configurePurging(purgeConfig, pageSize);
+    return true;
 }
 
-MemoryManager::BlockInfo MemoryManager::getBlockInfo(void* ptr) const {
-    BlockInfo info;
-    BlockHeader* header = getHeader(ptr);
-    if (header != nullptr) {
-        info.block_id = header->block_id;
-        info.address = ptr;
-        info.size = header->size - sizeof(BlockHeader);
-        info.is_free = header->is_free;
+void MemoryManager::setPurgeConfig(const PurgeConfig& config) {
+    purgeConfig = config;
+    engine->configurePurging(purgeConfig, pageSize);
+}
+
+MemoryManager::PurgeStats MemoryManager::getPurgeStats() const {
+    return engine->getPurgeStats();
+}
+
+void MemoryManager::purgeNow() {
+    engine->purgeNow();
+}
+
+MemoryManager::PageStats MemoryManager::getPageStats(size_t size) const {
+    if (!isValidPageSize(size)) {
+        size = pageSize;
     }
-    return info;
+    return engine->getPageStats(size);
+}
+
+void MemoryManager::dumpMemory() const {
+    engine->dumpMemory();
+}
+
+MemoryManager::BlockInfo MemoryManager::getBlockInfo(void* ptr) const {
+    return engine->getBlockInfo(ptr);
 }
 
 std::vector<MemoryManager::BlockInfo> MemoryManager::getAllBlocks() const {
-    std::vector<BlockInfo> blocks;
-    for (const auto& pair : idToHeader) {
-        BlockHeader* header = pair.second;
-        BlockInfo info;
-        info.block_id = header->block_id;
-        info.address = reinterpret_cast<void*>(
-            reinterpret_cast<char*>(header) + sizeof(BlockHeader));
-        info.size = header->size - sizeof(BlockHeader);
-        info.is_free = header->is_free;
-        blocks.push_back(info);
-    }
-    return blocks;
+    return engine->getAllBlocks();
 }
@@ -5,8 +5,17 @@
 #include <vector>
 #include <list>
 #include <map>
+#include <memory>
 #include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include "../stats/Histogram.h"
 
+class AllocatorEngine;
+
+// Facade over a compile-time specialized allocator engine
+// (AllocatorEngineT<Fit, Index, Layout>, see AllocatorEngine.h).
 class MemoryManager {
 public:
     enum AllocationStrategy {
@@ -15,6 +24,20 @@ public:
         WORST_FIT
     };
 
+    // How free blocks are indexed
+    enum FreeIndex {
+        FREE_LIST,    // LIFO doubly-linked list through the headers
+        SIZE_TREE,    // Size-ordered side tree: O(log n) best/worst fit
+        IN_BAND       // Size bins linked through free blocks, and block tracking
+                      // in the headers: no bookkeeping outside the heap
+    };
+
+    // How block headers are laid out in memory
+    enum HeaderLayout {
+        STANDARD_HEADER,  // Native size/id fields and pointer links
+        COMPACT_HEADER    // 16 bytes: 32-bit size/id, offset links (heaps < 2 GB)
+    };
+
     struct BlockInfo {
         size_t block_id;
         void* address;
@@ -22,7 +45,133 @@ public:
         bool is_free;
     };
 
-    MemoryManager(size_t totalSize, AllocationStrategy strategy = FIRST_FIT);
+    // Whole-heap figures from one walk over every block
+    struct HeapSnapshot {
+        size_t blocks;
+        size_t usedBlocks;
+        size_t freeBlocks;
+        size_t freeBytes;            // Usable bytes in free blocks
+        size_t largestFreeBlock;     // Usable bytes of the largest free block
+        size_t uncoalescedFree;      // Free blocks directly after another free block
+        Histogram freeSizes;         // Usable bytes of each free block
+    };
+
+    // OS page residency of the heap at one page size. A page is resident
+    // once any byte of it has been written (a header or an allocated block)
+    // and stays resident after the data on it is freed.
+    struct PageStats {
+        size_t pageSize;
+        size_t pages;                // Pages spanned by the heap
+        size_t residentPages;        // Touched pages: what the process pays for
+        size_t livePages;            // Pages overlapping an allocated block
+        size_t freePages;            // Pages holding only free payload (no headers)
+        size_t reclaimablePages;     // Free pages that are resident: madvise candidates
+        size_t residentBytes;        // Estimated RSS (the last page may be partial)
+    };
+
+    // Decay-based page purging, after jemalloc's dirty/muzzy decay. Time is
+    // counted in allocator operations (each malloc or free is one tick). A
+    // page that becomes fully free stays dirty for `dirtyDecay` ticks, is
+    // then lazily purged (MADV_FREE: still resident, but the kernel may take
+    // it) and, `muzzyDecay` ticks later, purged (MADV_DONTNEED). A muzzy
+    // decay of 0 purges directly. Reusing a purged page costs a refault.
+    static constexpr uint64_t NEVER = ~uint64_t(0);
+    struct PurgeConfig {
+        uint64_t dirtyDecay;         // NEVER disables purging
+        uint64_t muzzyDecay;
+        uint64_t lazyPurgeCost;      // Cycles per page for MADV_FREE
+        uint64_t purgeCost;          // Cycles per page for MADV_DONTNEED
+        uint64_t refaultCost;        // Cycles per page faulted back in
+
+        PurgeConfig()
+            : dirtyDecay(NEVER), muzzyDecay(0), lazyPurgeCost(300), purgeCost(1000), refaultCost(2500) {}
+    };
+
+    struct PurgeStats {
+        uint64_t clock;              // Operations so far
+        size_t pageSize;
+        size_t residentPages;
+        size_t dirtyPages;           // Free and resident, decay timer running
+        size_t muzzyPages;           // Lazily purged, still counted as resident
+        double averageResidentPages; // Over the whole run, one sample per tick
+        uint64_t lazyPurges;         // Pages passed to MADV_FREE
+        uint64_t purges;             // Pages passed to MADV_DONTNEED
+        uint64_t refaults;           // Purged pages written again
+        uint64_t purgeCycles;        // Lazy purges, purges and refaults
+    };
+
+    // What allocate() tries, in this order, when no free block fits. Every
+    // step is followed by a retry; the first one that succeeds ends recovery.
+    // All steps are off by default. Costs are simulated cycles added to the
+    // allocation that needed recovery.
+    struct OomPolicy {
+        bool flushDeferred;          // Free the blocks queued by deferred frees
+        bool reclaim;                // Call the reclaim callback
+        bool compact;                // Slide allocated blocks down (relocates them)
+        size_t growLimit;            // Grow the heap up to this size (0 = never)
+
+        uint64_t flushCost;          // Per deferred free flushed
+        uint64_t reclaimCost;        // Per reclaim callback call
+        uint64_t compactBlockCost;   // Per block moved
+        uint64_t compactKiBCost;     // Per KiB moved
+        uint64_t growCost;           // Per heap growth (the mmap/brk call)
+
+        OomPolicy()
+            : flushDeferred(false), reclaim(false), compact(false), growLimit(0),
+              flushCost(100), reclaimCost(2000), compactBlockCost(200), compactKiBCost(150),
+              growCost(5000) {}
+    };
+
+    struct OomStats {
+        uint64_t pressureEvents;     // Allocations that failed on the first try
+        uint64_t recovered;          // ... and then succeeded after recovery
+        uint64_t flushes, flushedFrees;
+        uint64_t reclaims, reclaimedBytes;
+        uint64_t compactions, movedBlocks, movedBytes;
+        uint64_t grows, grownBytes;
+        uint64_t recoveryCycles;
+        Histogram latency;           // Cycles added per pressure event
+        // Cycles each step added in total, and per run of the step
+        uint64_t flushCycles, reclaimCycles, compactCycles, growCycles;
+        Histogram flushLatency, reclaimLatency, compactLatency, growLatency;
+        const char* lastStep;        // Step that satisfied the last pressure event, or nullptr
+
+        OomStats()
+            : pressureEvents(0), recovered(0), flushes(0), flushedFrees(0), reclaims(0), reclaimedBytes(0),
+              compactions(0), movedBlocks(0), movedBytes(0), grows(0), grownBytes(0), recoveryCycles(0),
+              flushCycles(0), reclaimCycles(0), compactCycles(0), growCycles(0), lastStep(nullptr) {}
+    };
+
+    // Called under memory pressure with the size being allocated; should
+    // free cached objects through deallocate() and return the bytes freed
+    typedef std::function<size_t(size_t size)> ReclaimCallback;
+    // Called by compaction for each block it moves (user pointers)
+    typedef std::function<void(void* from, void* to)> RelocationCallback;
+    // Asked by compaction whether the block at a user pointer must stay put
+    typedef std::function<bool(void* ptr)> PinnedCallback;
+
+    // Handle-based allocation. A handle names a block independently of its
+    // address, so compaction can move the block without anyone having to
+    // remap pointers: pin() returns the current address and keeps the block
+    // in place until the matching unpin(). A handle is a slot index (low
+    // HANDLE_INDEX_BITS bits) and the slot's generation (high bits), which
+    // changes when the slot is freed, so a stale handle is rejected by one
+    // array access and a compare. 0 is never a valid handle.
+    typedef uint32_t Handle;
+    static const Handle NULL_HANDLE = 0;
+    static const unsigned HANDLE_INDEX_BITS = 20;
+
+    struct HandleStats {
+        size_t live;                 // Allocated handles
+        size_t pinned;               // ... with at least one pin
+        size_t slots;                // Slot table size, live or free
+        uint64_t relocations;        // Handle blocks moved by compaction
+        uint64_t staleUses;          // Calls rejected for a freed or unknown handle
+    };
+
+    // A heap too large for the compact layout falls back to the standard one
+    MemoryManager(size_t totalSize, AllocationStrategy strategy = FIRST_FIT,
+                  FreeIndex index = FREE_LIST, HeaderLayout layout = STANDARD_HEADER);
     ~MemoryManager();
     
     // Allocation interface
@@ -39,60 +188,128 @@ public:
     size_t getTotalMemory() const { return totalMemorySize; }
     size_t getUsedMemory() const;
     size_t getFreeMemory() const;
-    size_t getAllocationSuccessCount() const { return allocationSuccessCount; }
-    size_t getAllocationFailureCount() const { return allocationFailureCount; }
+    size_t getAllocationSuccessCount() const;
+    size_t getAllocationFailureCount() const;
+
+    // Heap scans walk the blocks in parallel chunks on large heaps
+    HeapSnapshot getHeapSnapshot() const;
+    // Checks block boundaries, block tracking and the free index; returns
+    // the problems found (empty if the heap is consistent)
+    std::vector<std::string> verifyHeap() const;
+
+    // Page residency at the configured page size, or at `pageSize` (a power
+    // of two no smaller than PageMap::GRANULE)
+    PageStats getPageStats() const { return getPageStats(pageSize); }
+    PageStats getPageStats(size_t pageSize) const;
+    // False (and unchanged) if the size is not a valid page size
+    bool setPageSize(size_t size);
+    size_t getPageSize() const { return pageSize; }
+    static bool isValidPageSize(size_t size);
+
+    // Purging works on pages of the configured page size; changing the page
+    // size restarts the purge statistics
+    void setPurgeConfig(const PurgeConfig& config);
+    const PurgeConfig& getPurgeConfig() const { return purgeConfig; }
+    PurgeStats getPurgeStats() const;
+    // Purges every dirty and muzzy page now, regardless of decay
+    void purgeNow();
+
+    // Out-of-memory recovery. Heap growth reserves address space for
+    // `growLimit` bytes, so it must be enabled before the first allocation;
+    // returns false (and changes nothing) otherwise or if the limit is over
+    // getMaxHeapSize(). With compaction on, callers that keep pointers must
+    // register a relocation callback.
+    bool setOomPolicy(const OomPolicy& policy);
+    const OomPolicy& getOomPolicy() const { return oomPolicy; }
+    const OomStats& getOomStats() const { return oomStats; }
+    void setReclaimCallback(const ReclaimCallback& callback) { reclaimCallback = callback; }
+    void setRelocationCallback(const RelocationCallback& callback) { relocationCallback = callback; }
+
+    // Deferred frees: with a capacity above 0, deallocate() queues the block
+    // and frees the queue in one batch when it is full (or on flush), the
+    // way thread caches return memory. Queued blocks stay allocated.
+    void setDeferredFrees(size_t capacity);
+    size_t getDeferredFreeCapacity() const { return deferredCapacity; }
+    size_t getDeferredFreeCount() const { return deferred.size(); }
+    // Frees every queued block; returns how many there were
+    size_t flushDeferredFrees();
+
+    // Handles (see Handle). allocHandle() returns NULL_HANDLE if the
+    // allocation fails or every slot is in use. freeHandle() frees the block
+    // and drops any pins; freeing the block by pointer or ID instead does
+    // the same and leaves the handle stale. pin()
+    // returns nullptr and unpin()/freeHandle() false for a stale handle.
+    Handle allocHandle(size_t size);
+    bool freeHandle(Handle handle);
+    void* pin(Handle handle);
+    bool unpin(Handle handle);
+    bool isLiveHandle(Handle handle) const;
+    // Address and size of a live handle's block without pinning it; the
+    // address is only good until the next allocation, which may compact
+    BlockInfo getHandleInfo(Handle handle) const;
+    size_t getPinCount(Handle handle) const;
+    std::vector<Handle> getLiveHandles() const;
+    HandleStats getHandleStats() const;
     
+    // Engine configuration
+    AllocationStrategy getAllocationStrategy() const { return currentStrategy; }
+    FreeIndex getFreeIndex() const { return freeIndex; }
+    HeaderLayout getHeaderLayout() const { return headerLayout; }
+    size_t getHeaderSize() const;
+    static size_t getMaxHeapSize(HeaderLayout layout);
+    
+    // Physical address (offset from the start of the heap) of a pointer
+    // returned by allocate()
+    size_t getOffset(const void* ptr) const;
+    // Inverse of getOffset; nullptr if the offset is outside the heap
+    void* getPointer(size_t offset) const;
+
     // Get block information
     BlockInfo getBlockInfo(void* ptr) const;
     std::vector<BlockInfo> getAllBlocks() const;
 
 private:
-    // Block header structure (embedded in memory)
-    struct BlockHeader {
-        size_t size;              // Size of this block (including header)
-        bool is_free;             // Allocation status
-        size_t block_id;           // Unique block identifier
-        BlockHeader* next;         // Next block in memory
-        BlockHeader* prev;         // Previous block in memory
-    };
-
     size_t totalMemorySize;
     AllocationStrategy currentStrategy;
-    std::vector<char> physicalMemory;
-    
-    BlockHeader* firstBlock;      // First block in memory
-    BlockHeader* freeListHead;    // Head of free list (for First/Best/Worst Fit)
-    
-    // Block tracking
-    size_t nextBlockId;
-    std::map<void*, BlockHeader*> addressToHeader;
-    std::map<size_t, BlockHeader*> idToHeader;
-    std::map<size_t, size_t> idToRequestedSize;  // Track requested size per block
-    
-    // Statistics
-    size_t allocationSuccessCount;
-    size_t allocationFailureCount;
-    size_t totalRequestedSize;
-    size_t totalAllocatedSize;
-
-    // Helper functions
-    BlockHeader* findFirstFit(size_t size);
-    BlockHeader* findBestFit(size_t size);
-    BlockHeader* findWorstFit(size_t size);
-    
-    void splitBlock(BlockHeader* block, size_t requestedSize);
-    void coalesceBlocks(BlockHeader* block);
-    
-    void addToFreeList(BlockHeader* block);
-    void removeFromFreeList(BlockHeader* block);
-    
-    // Initialization
-    void initializeMemory();
+    FreeIndex freeIndex;
+    HeaderLayout headerLayout;
+    size_t pageSize;
+    PurgeConfig purgeConfig;
+    OomPolicy oomPolicy;
+    OomStats oomStats;
+    uint64_t transientFailures;      // Failed attempts of allocations that recovered or retried
+    ReclaimCallback reclaimCallback;
+    RelocationCallback relocationCallback;
+    size_t deferredCapacity;
+    std::vector<void*> deferred;
+
+    struct HandleSlot {
+        void* ptr;                   // nullptr while the slot is free
+        uint32_t generation;         // 1..HANDLE_GENERATIONS - 1
+        uint32_t pins;
+    };
+    static const uint32_t HANDLE_GENERATIONS = uint32_t(1) << (32 - HANDLE_INDEX_BITS);
+    std::vector<HandleSlot> handleSlots;
+    std::vector<uint32_t> freeHandleSlots;
+    // Slot of each handle block by address; only compaction looks blocks up
+    // this way
+    std::unordered_map<void*, uint32_t> handleSlotByAddress;
+    size_t pinnedHandles;
+    uint64_t handleRelocations;
+    mutable uint64_t staleHandleUses;
     
-    // Utility
-    bool isValidPointer(void* ptr) const;
-    BlockHeader* getHeader(void* ptr) const;
+    std::unique_ptr<AllocatorEngine> engine;
+
     size_t getLargestFreeBlock() const;
+    void* recover(size_t size);
+    // Slot of a live handle, or nullptr (counted as a stale use)
+    const HandleSlot* resolve(Handle handle) const;
+    HandleSlot* resolve(Handle handle) {
+        return const_cast<HandleSlot*>(static_cast<const MemoryManager*>(this)->resolve(handle));
+    }
+    // Frees a slot whose block was freed: bumps its generation so the old
+    // handle goes stale
+    void retireHandleSlot(uint32_t index);
 };
 
 #endif // MEMORY_MANAGER_H
@@ -0,0 +1,87 @@
+#ifndef PAGE_MAP_H
+#define PAGE_MAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Which parts of the heap have ever been written, one bit per GRANULE bytes.
+// A real process only pays for (has resident) the OS pages it has touched,
+// so RSS at any page size that is a multiple of the granule is the number of
+// pages with at least one touched granule. Keeping the finer granule lets the
+// same run be evaluated at 4 KB and at 2 MB pages.
+class PageMap {
+public:
+    static const size_t GRANULE = 64;
+
+    void reset(size_t heap_bytes) {
+        heapBytes = heap_bytes;
+        granules = (heap_bytes + GRANULE - 1) / GRANULE;
+        words.assign((granules + 63) / 64, 0);
+    }
+
+    // Extends the map to a larger heap; the new bytes are untouched
+    void resize(size_t heap_bytes) {
+        heapBytes = heap_bytes;
+        granules = (heap_bytes + GRANULE - 1) / GRANULE;
+        words.resize((granules + 63) / 64, 0);
+    }
+
+    // Marks [offset, offset + bytes) as written
+    void touch(size_t offset, size_t bytes) {
+        if (bytes == 0) return;
+        setRange(offset / GRANULE, (offset + bytes - 1) / GRANULE, true);
+    }
+
+    // Forgets [offset, offset + bytes), as madvise(MADV_DONTNEED) would;
+    // only granules wholly inside the range are cleared, except that the
+    // range may end at the (unaligned) end of the heap
+    void release(size_t offset, size_t bytes) {
+        size_t first = (offset + GRANULE - 1) / GRANULE;
+        size_t end = (offset + bytes) / GRANULE;
+        if (offset + bytes >= heapBytes) end = granules;
+        if (first < end) setRange(first, end - 1, false);
+    }
+
+    // True if any granule overlapping [offset, offset + bytes) was written
+    bool touched(size_t offset, size_t bytes) const {
+        if (bytes == 0) return false;
+        size_t first = offset / GRANULE;
+        size_t last = (offset + bytes - 1) / GRANULE;
+        if (last >= granules) last = granules - 1;
+        size_t firstWord = first >> 6;
+        size_t lastWord = last >> 6;
+        for (size_t w = firstWord; w <= lastWord; w++) {
+            uint64_t bits = words[w];
+            if (w == firstWord) bits &= ~uint64_t(0) << (first & 63);
+            if (w == lastWord && (last & 63) != 63) bits &= (uint64_t(1) << ((last & 63) + 1)) - 1;
+            if (bits != 0) return true;
+        }
+        return false;
+    }
+
+    size_t touchedGranules() const {
+        size_t count = 0;
+        for (uint64_t word : words) count += static_cast<size_t>(__builtin_popcountll(word));
+        return count;
+    }
+
+private:
+    size_t heapBytes = 0;
+    size_t granules = 0;
+    std::vector<uint64_t> words;
+
+    void setRange(size_t first, size_t last, bool value) {
+        if (last >= granules) last = granules - 1;
+        size_t firstWord = first >> 6;
+        size_t lastWord = last >> 6;
+        for (size_t w = firstWord; w <= lastWord; w++) {
+            uint64_t mask = ~uint64_t(0);
+            if (w == firstWord) mask &= ~uint64_t(0) << (first & 63);
+            if (w == lastWord && (last & 63) != 63) mask &= (uint64_t(1) << ((last & 63) + 1)) - 1;
+            words[w] = value ? (words[w] | mask) : (words[w] & ~mask);
+        }
+    }
+};
+
+#endif // PAGE_MAP_H
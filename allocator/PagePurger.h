@@ -0,0 +1,229 @@
+#ifndef PAGE_PURGER_H
+#define PAGE_PURGER_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <utility>
+#include <vector>
+#include "MemoryManager.h"
+#include "PageMap.h"
+
+// Per-page residency and decay timers for MemoryManager::PurgeConfig. Pages
+// are tracked at one page size; decay deadlines are the same for every page,
+// so pages expire in the order they became free and each stage is a FIFO
+// queue. Queue entries are (page, stamp) and are skipped if the page has
+// changed state since.
+class PagePurger {
+public:
+    void reset(size_t heap_bytes, size_t page_size) {
+        heapBytes = heap_bytes;
+        pageSize = page_size;
+        pages = (heap_bytes + page_size - 1) / page_size;
+        state.assign(pages, UNTOUCHED);
+        since.assign(pages, 0);
+        dirtyQueue.clear();
+        muzzyQueue.clear();
+        residentPages = dirtyPages = muzzyPages = 0;
+        residentTicks = 0;
+        ticks = 0;
+        lazyPurges = purges = refaults = purgeCycles = 0;
+    }
+
+    // Extends tracking to a larger heap; the new pages are untouched
+    void resize(size_t heap_bytes) {
+        heapBytes = heap_bytes;
+        pages = (heap_bytes + pageSize - 1) / pageSize;
+        state.resize(pages, UNTOUCHED);
+        since.resize(pages, 0);
+    }
+
+    void configure(const MemoryManager::PurgeConfig& purgeConfig) {
+        bool muzzyWasDecaying = config.muzzyDecay != MemoryManager::NEVER;
+        config = purgeConfig;
+        if (!enabled()) {
+            // Nothing decays while purging is off: free pages stay resident
+            // as active ones, and the engine re-frees them when it is back on
+            if (dirtyPages + muzzyPages > 0) {
+                for (size_t page = 0; page < pages; page++) {
+                    if (state[page] == DIRTY || state[page] == MUZZY) state[page] = ACTIVE;
+                }
+            }
+            dirtyPages = muzzyPages = 0;
+            dirtyQueue.clear();
+            muzzyQueue.clear();
+        } else if (config.muzzyDecay == MemoryManager::NEVER) {
+            muzzyQueue.clear();
+        } else if (!muzzyWasDecaying && muzzyPages > 0) {
+            // Muzzy pages were not queued while their decay was off
+            for (size_t page = 0; page < pages; page++) {
+                if (state[page] == MUZZY) muzzyQueue.push_back(std::make_pair(page, since[page]));
+            }
+            std::sort(muzzyQueue.begin(), muzzyQueue.end(),
+                      [](const std::pair<size_t, uint64_t>& a, const std::pair<size_t, uint64_t>& b) {
+                          return a.second < b.second;
+                      });
+        }
+    }
+    bool enabled() const { return config.dirtyDecay != MemoryManager::NEVER; }
+    size_t getPageSize() const { return pageSize; }
+
+    // [offset, offset + bytes) is being written: its pages become active,
+    // and purged ones are faulted back in
+    void write(size_t offset, size_t bytes) {
+        if (bytes == 0) return;
+        size_t last = std::min((offset + bytes - 1) / pageSize, pages - 1);
+        for (size_t page = offset / pageSize; page <= last; page++) {
+            switch (state[page]) {
+                case ACTIVE:
+                    continue;
+                case PURGED:
+                    refaults++;
+                    purgeCycles += config.refaultCost;
+                    residentPages++;
+                    break;
+                case UNTOUCHED:
+                    residentPages++;
+                    break;
+                case DIRTY:
+                    dirtyPages--;
+                    break;
+                case MUZZY:
+                    muzzyPages--;      // Reused before the kernel took it: no fault
+                    break;
+            }
+            state[page] = ACTIVE;
+        }
+    }
+
+    // [offset, offset + bytes) now holds only free payload; the pages wholly
+    // inside it start their dirty decay at `now`. Nothing to do while
+    // purging is off.
+    void freed(size_t offset, size_t bytes, uint64_t now) {
+        if (!enabled()) return;
+        size_t first, limit;
+        wholePages(offset, bytes, first, limit);
+        for (size_t page = first; page < limit; page++) {
+            if (state[page] != ACTIVE) continue;
+            state[page] = DIRTY;
+            since[page] = now;
+            dirtyPages++;
+            dirtyQueue.push_back(std::make_pair(page, now));
+        }
+    }
+
+    // Advances simulated time to `now` and applies the decay that is due
+    void tick(uint64_t now, PageMap& touched) {
+        residentTicks += residentPages;
+        ticks++;
+        if (config.dirtyDecay == MemoryManager::NEVER) return;
+
+        while (!dirtyQueue.empty() && now - dirtyQueue.front().second >= config.dirtyDecay) {
+            std::pair<size_t, uint64_t> entry = dirtyQueue.front();
+            dirtyQueue.pop_front();
+            if (state[entry.first] != DIRTY || since[entry.first] != entry.second) continue;
+            dirtyPages--;
+            if (config.muzzyDecay == 0) {
+                purge(entry.first, touched);
+            } else {
+                state[entry.first] = MUZZY;
+                since[entry.first] = now;
+                muzzyPages++;
+                lazyPurges++;
+                purgeCycles += config.lazyPurgeCost;
+                if (config.muzzyDecay != MemoryManager::NEVER) muzzyQueue.push_back(std::make_pair(entry.first, now));
+            }
+        }
+        if (config.muzzyDecay == MemoryManager::NEVER) return;
+        while (!muzzyQueue.empty() && now - muzzyQueue.front().second >= config.muzzyDecay) {
+            std::pair<size_t, uint64_t> entry = muzzyQueue.front();
+            muzzyQueue.pop_front();
+            if (state[entry.first] != MUZZY || since[entry.first] != entry.second) continue;
+            muzzyPages--;
+            purge(entry.first, touched);
+        }
+    }
+
+    // Purges every dirty and muzzy page immediately
+    void purgeAll(PageMap& touched) {
+        for (size_t page = 0; page < pages; page++) {
+            if (state[page] == DIRTY) {
+                dirtyPages--;
+                purge(page, touched);
+            } else if (state[page] == MUZZY) {
+                muzzyPages--;
+                purge(page, touched);
+            }
+        }
+        dirtyQueue.clear();
+        muzzyQueue.clear();
+    }
+
+    // Purges the resident pages wholly inside free payload [offset, offset +
+    // bytes) at once: `purge now` while purging is off, when free pages are
+    // not tracked as dirty
+    void purgeFree(size_t offset, size_t bytes, PageMap& touched) {
+        size_t first, limit;
+        wholePages(offset, bytes, first, limit);
+        for (size_t page = first; page < limit; page++) {
+            if (state[page] == ACTIVE) purge(page, touched);
+        }
+    }
+
+    MemoryManager::PurgeStats stats(uint64_t now) const {
+        MemoryManager::PurgeStats result;
+        result.clock = now;
+        result.pageSize = pageSize;
+        result.residentPages = residentPages;
+        result.dirtyPages = dirtyPages;
+        result.muzzyPages = muzzyPages;
+        result.averageResidentPages = ticks == 0 ? static_cast<double>(residentPages)
+                                                 : static_cast<double>(residentTicks) / ticks;
+        result.lazyPurges = lazyPurges;
+        result.purges = purges;
+        result.refaults = refaults;
+        result.purgeCycles = purgeCycles;
+        return result;
+    }
+
+private:
+    enum PageState : uint8_t { UNTOUCHED, ACTIVE, DIRTY, MUZZY, PURGED };
+
+    MemoryManager::PurgeConfig config;
+    size_t heapBytes = 0;
+    size_t pageSize = 4096;
+    size_t pages = 0;
+    std::vector<PageState> state;
+    std::vector<uint64_t> since;     // When the page entered DIRTY or MUZZY
+    std::deque<std::pair<size_t, uint64_t> > dirtyQueue;
+    std::deque<std::pair<size_t, uint64_t> > muzzyQueue;
+
+    size_t residentPages = 0;
+    size_t dirtyPages = 0;
+    size_t muzzyPages = 0;
+    uint64_t residentTicks = 0;      // Sum of residentPages over all ticks
+    uint64_t ticks = 0;
+    uint64_t lazyPurges = 0;
+    uint64_t purges = 0;
+    uint64_t refaults = 0;
+    uint64_t purgeCycles = 0;
+
+    // Pages [first, limit) lie wholly inside [offset, offset + bytes); a
+    // range reaching the heap end takes the last, partial page too
+    void wholePages(size_t offset, size_t bytes, size_t& first, size_t& limit) const {
+        size_t end = offset + bytes;
+        first = (offset + pageSize - 1) / pageSize;
+        limit = end >= heapBytes ? pages : end / pageSize;
+    }
+
+    void purge(size_t page, PageMap& touched) {
+        state[page] = PURGED;
+        residentPages--;
+        purges++;
+        purgeCycles += config.purgeCost;
+        touched.release(page * pageSize, std::min(pageSize, heapBytes - page * pageSize));
+    }
+};
+
+#endif // PAGE_PURGER_H
@@ -0,0 +1,142 @@
+#include "ReuseDistanceAnalyzer.h"
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <cmath>
+
+ReuseDistanceAnalyzer::ReuseDistanceAnalyzer(uint64_t granularity, size_t maxTracked)
+    : granularity(granularity == 0 ? 1 : granularity),
+      maxTracked(maxTracked == 0 ? 1 : maxTracked),
+      tree(1, 0), nextSlot(1), threshold(HASH_SPACE),
+      references(0), coldReferences(0.0) {
+}
+
+uint32_t ReuseDistanceAnalyzer::hashItem(uint64_t item) {
+    // splitmix64 finalizer, top 24 bits
+    uint64_t z = item + 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z = z ^ (z >> 31);
+    return static_cast<uint32_t>(z >> 40);
+}
+
+double ReuseDistanceAnalyzer::getSamplingRate() const {
+    return static_cast<double>(threshold) / HASH_SPACE;
+}
+
+void ReuseDistanceAnalyzer::record(uint64_t address) {
+    references++;
+
+    uint64_t item = address / granularity;
+    uint32_t hash = hashItem(item);
+    if (hash >= threshold) {
+        return; // Not in the spatial sample
+    }
+
+    double rate = getSamplingRate();
+    double weight = 1.0 / rate;
+
+    auto it = lastSlot.find(item);
+    if (it != lastSlot.end()) {
+        size_t prev = it->second;
+        // Distinct items used since the previous use = tracked slots after prev
+        uint64_t sampledDistance = treePrefix(nextSlot - 1) - treePrefix(prev);
+        uint64_t distance = static_cast<uint64_t>(std::llround(sampledDistance / rate));
+        histogram.add(distance, weight);
+
+        treeAdd(prev, -1);
+        it->second = 0; // Not live while a new slot is taken (compaction skips it)
+        size_t slot = takeSlot();
+        it->second = slot;
+        treeAdd(slot, 1);
+        return;
+    }
+
+    coldReferences += weight;
+    size_t slot = takeSlot();
+    lastSlot[item] = slot;
+    treeAdd(slot, 1);
+    sampledByHash.insert(std::make_pair(hash, item));
+
+    if (lastSlot.size() > maxTracked) {
+        shrinkSample();
+    }
+}
+
+void ReuseDistanceAnalyzer::treeAdd(size_t slot, int delta) {
+    for (size_t i = slot; i < tree.size(); i += i & (~i + 1)) {
+        tree[i] += delta;
+    }
+}
+
+uint64_t ReuseDistanceAnalyzer::treePrefix(size_t slot) const {
+    uint64_t sum = 0;
+    for (size_t i = slot; i > 0; i -= i & (~i + 1)) {
+        sum += tree[i];
+    }
+    return sum;
+}
+
+size_t ReuseDistanceAnalyzer::takeSlot() {
+    if (nextSlot >= tree.size()) {
+        compactSlots();
+    }
+    return nextSlot++;
+}
+
+void ReuseDistanceAnalyzer::compactSlots() {
+    // Renumber live items 1..n in last-use order and rebuild the tree.
+    // Capacity is kept at twice the live count, so compaction is amortized O(log n)
+    // per reference and the tree never exceeds ~2 * maxTracked entries.
+    std::vector<std::pair<size_t, size_t*>> live;
+    live.reserve(lastSlot.size());
+    for (auto& pair : lastSlot) {
+        if (pair.second != 0) {
+            live.push_back(std::make_pair(pair.second, &pair.second));
+        }
+    }
+    std::sort(live.begin(), live.end());
+
+    size_t capacity = std::max<size_t>(1024, 2 * (live.size() + 1));
+    tree.assign(capacity + 1, 0);
+    for (size_t i = 0; i < live.size(); i++) {
+        *live[i].second = i + 1;
+    }
+    for (size_t i = 1; i <= live.size(); i++) {
+        tree[i] = 1;
+    }
+    for (size_t i = 1; i <= capacity; i++) {
+        size_t parent = i + (i & (~i + 1));
+        if (parent <= capacity) {
+            tree[parent] += tree[i];
+        }
+    }
+    nextSlot = live.size() + 1;
+}
+
+void ReuseDistanceAnalyzer::shrinkSample() {
+    // Drop the items with the largest hash until the sample fits again;
+    // the new threshold excludes them (and everything above) from now on.
+    while (lastSlot.size() > maxTracked && !sampledByHash.empty()) {
+        uint32_t largest = std::prev(sampledByHash.end())->first;
+        auto range = sampledByHash.equal_range(largest);
+        for (auto it = range.first; it != range.second; ++it) {
+            auto slotIt = lastSlot.find(it->second);
+            if (slotIt != lastSlot.end()) {
+                treeAdd(slotIt->second, -1);
+                lastSlot.erase(slotIt);
+            }
+        }
+        sampledByHash.erase(range.first, range.second);
+        threshold = largest;
+    }
+}
+
+void ReuseDistanceAnalyzer::print(const std::string& label) const {
+    std::cout << "Reuse Distance (" << label << ", " << granularity << " B):\n";
+    std::cout << "  References: " << references << "\n";
+    std::cout << "  Cold References: " << static_cast<uint64_t>(std::llround(coldReferences)) << "\n";
+    std::cout << "  Sampling Rate: " << std::fixed << std::setprecision(4) << getSamplingRate()
+              << (isSampling() ? " (SHARDS, approximate)" : " (exact)") << "\n";
+    histogram.print("  Distance Histogram", label + "s");
+}
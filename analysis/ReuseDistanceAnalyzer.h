@@ -0,0 +1,68 @@
+#ifndef REUSE_DISTANCE_ANALYZER_H
+#define REUSE_DISTANCE_ANALYZER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include "../stats/Histogram.h"
+
+// Streaming reuse (stack) distance analysis.
+//
+// The reuse distance of a reference is the number of distinct items touched
+// since the previous reference to the same item (an LRU stack distance).
+// Items are addresses divided by the granularity (line or page size).
+//
+// Exact mode uses Olken's algorithm: a Fenwick tree over "last use" slots
+// counts how many tracked items were used after the previous use.
+// Slots are renumbered when the tree fills, so memory stays O(maxTracked).
+//
+// Once more than maxTracked distinct items are live, the analyzer switches to
+// fixed-size SHARDS sampling: only items whose spatial hash is below a
+// threshold are tracked, the threshold is lowered whenever the sample set
+// overflows, and each sampled distance is scaled by 1/rate.
+class ReuseDistanceAnalyzer {
+public:
+    ReuseDistanceAnalyzer(uint64_t granularity, size_t maxTracked = 1 << 20);
+
+    void record(uint64_t address);
+
+    const Histogram& getHistogram() const { return histogram; }
+    uint64_t getGranularity() const { return granularity; }
+    size_t getReferenceCount() const { return references; }
+    double getColdReferences() const { return coldReferences; }
+    double getSamplingRate() const;
+    bool isSampling() const { return threshold < HASH_SPACE; }
+    size_t getTrackedItems() const { return lastSlot.size(); }
+
+    void print(const std::string& label) const;
+
+private:
+    static const uint32_t HASH_SPACE = 1u << 24;
+
+    uint64_t granularity;
+    size_t maxTracked;
+
+    // Fenwick tree over last-use slots (1-based)
+    std::vector<uint32_t> tree;
+    size_t nextSlot;
+
+    std::unordered_map<uint64_t, size_t> lastSlot;   // item -> slot of its last use
+    std::multimap<uint32_t, uint64_t> sampledByHash; // SHARDS eviction order
+    uint32_t threshold;
+
+    Histogram histogram;
+    size_t references;
+    double coldReferences;
+
+    static uint32_t hashItem(uint64_t item);
+
+    void treeAdd(size_t slot, int delta);
+    uint64_t treePrefix(size_t slot) const;
+    size_t takeSlot();
+    void compactSlots();
+    void shrinkSample();
+};
+
+#endif // REUSE_DISTANCE_ANALYZER_H
@@ -0,0 +1,56 @@
+#include "WorkingSetAnalyzer.h"
+#include <iostream>
+#include <iomanip>
+
+WorkingSetAnalyzer::WorkingSetAnalyzer(uint64_t granularity, size_t window)
+    : granularity(granularity == 0 ? 1 : granularity), window(window == 0 ? 1 : window),
+      ring(this->window, 0), ringPos(0), filled(0),
+      samples(0), workingSetSum(0.0), maxWorkingSet(0) {
+}
+
+void WorkingSetAnalyzer::record(uint64_t address) {
+    uint64_t item = address / granularity;
+
+    if (filled == window) {
+        // Slide: the oldest reference leaves the window
+        uint64_t oldest = ring[ringPos];
+        auto it = inWindow.find(oldest);
+        if (it != inWindow.end() && --it->second == 0) {
+            inWindow.erase(it);
+        }
+    } else {
+        filled++;
+    }
+
+    ring[ringPos] = item;
+    ringPos = (ringPos + 1) % window;
+    inWindow[item]++;
+
+    // Only full windows are representative
+    if (filled == window) {
+        size_t wss = inWindow.size();
+        histogram.add(wss);
+        samples++;
+        workingSetSum += wss;
+        if (wss > maxWorkingSet) maxWorkingSet = wss;
+    }
+}
+
+double WorkingSetAnalyzer::getAverageWorkingSet() const {
+    if (samples == 0) return 0.0;
+    return workingSetSum / samples;
+}
+
+void WorkingSetAnalyzer::print(const std::string& label) const {
+    std::cout << "Working Set Size (" << label << ", " << granularity << " B, window="
+              << window << " refs):\n";
+    if (samples == 0) {
+        std::cout << "  Trace shorter than window; no samples\n";
+        return;
+    }
+    std::cout << "  Average: " << std::fixed << std::setprecision(2) << getAverageWorkingSet()
+              << " " << label << "s (" << getAverageWorkingSet() * granularity << " bytes)\n";
+    std::cout << "  Maximum: " << maxWorkingSet << " " << label << "s ("
+              << maxWorkingSet * granularity << " bytes)\n";
+    histogram.print("  WSS Histogram", label + "s");
+}
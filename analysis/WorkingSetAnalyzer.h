@@ -0,0 +1,44 @@
+#ifndef WORKING_SET_ANALYZER_H
+#define WORKING_SET_ANALYZER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "../stats/Histogram.h"
+
+// Sliding-window working-set size (Denning's W(t, tau)).
+// After every reference, the number of distinct items among the last
+// `window` references is sampled into a histogram. Memory is O(window):
+// a ring buffer of the window plus a per-item occurrence count.
+class WorkingSetAnalyzer {
+public:
+    WorkingSetAnalyzer(uint64_t granularity, size_t window);
+
+    void record(uint64_t address);
+
+    const Histogram& getHistogram() const { return histogram; }
+    uint64_t getGranularity() const { return granularity; }
+    size_t getWindow() const { return window; }
+    size_t getMaxWorkingSet() const { return maxWorkingSet; }
+    double getAverageWorkingSet() const;
+
+    void print(const std::string& label) const;
+
+private:
+    uint64_t granularity;
+    size_t window;
+
+    std::vector<uint64_t> ring;
+    size_t ringPos;
+    size_t filled;
+    std::unordered_map<uint64_t, size_t> inWindow; // item -> occurrences in window
+
+    Histogram histogram;
+    size_t samples;
+    double workingSetSum;
+    size_t maxWorkingSet;
+};
+
+#endif // WORKING_SET_ANALYZER_H
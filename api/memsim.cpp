@@ -0,0 +1,363 @@
+#include "memsim.h"
+#include <exception>
+#include <new>
+#include <stdexcept>
+#include "../allocator/MemoryManager.h"
+#include "../cache/CacheSimulator.h"
+#include "../stats/StatsManager.h"
+
+// The opaque handles are thin wrappers so the C++ types never appear in the
+// public header.
+struct memsim_heap {
+    MemoryManager manager;
+
+    memsim_heap(uint64_t size, MemoryManager::AllocationStrategy strategy,
+                MemoryManager::FreeIndex index, MemoryManager::HeaderLayout layout)
+        : manager(size, strategy, index, layout) {}
+};
+
+struct memsim_cache {
+    CacheSimulator simulator;
+
+    memsim_cache(const memsim_cache_config& config, const CacheSimulator::Options& options)
+        : simulator(config.l1_size, config.l1_block_size, config.l1_associativity,
+                    config.l2_size, config.l2_block_size, config.l2_associativity,
+                    static_cast<CacheSimulator::ReplacementPolicy>(config.policy), options) {
+        simulator.setEventLogging(false);  // Callers read results, not event strings
+    }
+};
+
+struct memsim_stats {
+    StatsManager manager;
+};
+
+namespace {
+
+bool validStrategy(int strategy) {
+    return strategy >= MEMSIM_FIRST_FIT && strategy <= MEMSIM_WORST_FIT;
+}
+
+bool validPolicy(int policy) {
+    return policy >= MEMSIM_FIFO && policy <= MEMSIM_HAWKEYE;
+}
+
+} // namespace
+
+extern "C" {
+
+int memsim_api_version(void) {
+    return MEMSIM_API_VERSION;
+}
+
+const char* memsim_status_string(int status) {
+    switch (status) {
+        case MEMSIM_OK: return "ok";
+        case MEMSIM_ERR_ARGUMENT: return "invalid argument";
+        case MEMSIM_ERR_NO_MEMORY: return "out of simulated memory";
+        case MEMSIM_ERR_NOT_FOUND: return "no allocated block at address";
+        case MEMSIM_ERR_INTERNAL: return "internal error";
+    }
+    return "unknown status";
+}
+
+// ---------------------------------------------------------------------------
+// Heap
+// ---------------------------------------------------------------------------
+
+void memsim_heap_config_init(memsim_heap_config* config) {
+    if (config == nullptr) return;
+    config->strategy = MEMSIM_FIRST_FIT;
+    config->size_tree = 0;
+    config->compact_header = 0;
+}
+
+int memsim_heap_create(uint64_t size, const memsim_heap_config* config, memsim_heap** heap) {
+    if (heap == nullptr) return MEMSIM_ERR_ARGUMENT;
+    *heap = nullptr;
+
+    memsim_heap_config defaults;
+    memsim_heap_config_init(&defaults);
+    if (config == nullptr) config = &defaults;
+
+    MemoryManager::HeaderLayout layout = config->compact_header ?
+        MemoryManager::COMPACT_HEADER : MemoryManager::STANDARD_HEADER;
+    if (size == 0 || !validStrategy(config->strategy) || size > MemoryManager::getMaxHeapSize(layout)) {
+        return MEMSIM_ERR_ARGUMENT;
+    }
+
+    try {
+        *heap = new memsim_heap(size, static_cast<MemoryManager::AllocationStrategy>(config->strategy),
+                                config->size_tree ? MemoryManager::SIZE_TREE : MemoryManager::FREE_LIST,
+                                layout);
+    } catch (const std::bad_alloc&) {
+        return MEMSIM_ERR_NO_MEMORY;
+    } catch (const std::exception&) {
+        return MEMSIM_ERR_INTERNAL;
+    }
+    return MEMSIM_OK;
+}
+
+void memsim_heap_destroy(memsim_heap* heap) {
+    delete heap;
+}
+
+int memsim_heap_set_strategy(memsim_heap* heap, int strategy) {
+    if (heap == nullptr || !validStrategy(strategy)) return MEMSIM_ERR_ARGUMENT;
+    try {
+        heap->manager.setAllocationStrategy(static_cast<MemoryManager::AllocationStrategy>(strategy));
+    } catch (const std::exception&) {
+        return MEMSIM_ERR_INTERNAL;
+    }
+    return MEMSIM_OK;
+}
+
+int memsim_malloc(memsim_heap* heap, uint64_t size, uint64_t* address) {
+    if (heap == nullptr || address == nullptr) return MEMSIM_ERR_ARGUMENT;
+    try {
+        void* ptr = heap->manager.allocate(size);
+        if (ptr == nullptr) {
+            *address = MEMSIM_NULL_ADDRESS;
+            return MEMSIM_ERR_NO_MEMORY;
+        }
+        *address = heap->manager.getOffset(ptr);
+    } catch (const std::exception&) {
+        return MEMSIM_ERR_INTERNAL;
+    }
+    return MEMSIM_OK;
+}
+
+int memsim_free(memsim_heap* heap, uint64_t address) {
+    if (heap == nullptr) return MEMSIM_ERR_ARGUMENT;
+    try {
+        void* ptr = heap->manager.getPointer(address);
+        if (ptr == nullptr || !heap->manager.deallocate(ptr)) {
+            return MEMSIM_ERR_NOT_FOUND;
+        }
+    } catch (const std::exception&) {
+        return MEMSIM_ERR_INTERNAL;
+    }
+    return MEMSIM_OK;
+}
+
+size_t memsim_malloc_batch(memsim_heap* heap, const uint64_t* sizes, uint64_t* addresses, size_t count) {
+    if (heap == nullptr || sizes == nullptr || addresses == nullptr) return 0;
+    size_t allocated = 0;
+    try {
+        for (size_t i = 0; i < count; i++) {
+            void* ptr = heap->manager.allocate(sizes[i]);
+            if (ptr != nullptr) {
+                addresses[i] = heap->manager.getOffset(ptr);
+                allocated++;
+            } else {
+                addresses[i] = MEMSIM_NULL_ADDRESS;
+            }
+        }
+    } catch (const std::exception&) {
+        // Operations already done stay done; the return value reports them
+    }
+    return allocated;
+}
+
+size_t memsim_free_batch(memsim_heap* heap, const uint64_t* addresses, size_t count) {
+    if (heap == nullptr || addresses == nullptr) return 0;
+    size_t freed = 0;
+    try {
+        for (size_t i = 0; i < count; i++) {
+            void* ptr = heap->manager.getPointer(addresses[i]);
+            if (ptr != nullptr && heap->manager.deallocate(ptr)) {
+                freed++;
+            }
+        }
+    } catch (const std::exception&) {
+    }
+    return freed;
+}
+
+int memsim_heap_get_info(const memsim_heap* heap, memsim_heap_info* info) {
+    if (heap == nullptr || info == nullptr) return MEMSIM_ERR_ARGUMENT;
+    try {
+        const MemoryManager& manager = heap->manager;
+        info->total_bytes = manager.getTotalMemory();
+        info->used_bytes = manager.getUsedMemory();
+        info->free_bytes = manager.getFreeMemory();
+        info->allocations_ok = manager.getAllocationSuccessCount();
+        info->allocations_failed = manager.getAllocationFailureCount();
+        info->header_bytes = manager.getHeaderSize();
+        info->internal_fragmentation = manager.getInternalFragmentation();
+        info->external_fragmentation = manager.getExternalFragmentation();
+        info->utilization = manager.getMemoryUtilization();
+    } catch (const std::exception&) {
+        return MEMSIM_ERR_INTERNAL;
+    }
+    return MEMSIM_OK;
+}
+
+int memsim_heap_dump(const memsim_heap* heap) {
+    if (heap == nullptr) return MEMSIM_ERR_ARGUMENT;
+    heap->manager.dumpMemory();
+    return MEMSIM_OK;
+}
+
+// ---------------------------------------------------------------------------
+// Cache hierarchy
+// ---------------------------------------------------------------------------
+
+void memsim_cache_config_init(memsim_cache_config* config) {
+    if (config == nullptr) return;
+    // Same defaults as the CLI's 'init memory'
+    config->l1_size = 16 * 1024;
+    config->l1_block_size = 64;
+    config->l1_associativity = 4;
+    config->l2_size = 64 * 1024;
+    config->l2_block_size = 64;
+    config->l2_associativity = 8;
+    config->policy = MEMSIM_FIFO;
+    config->l1_sectors = 1;
+    config->l2_sectors = 1;
+}
+
+int memsim_cache_create(const memsim_cache_config* config, memsim_cache** cache) {
+    if (cache == nullptr) return MEMSIM_ERR_ARGUMENT;
+    *cache = nullptr;
+
+    memsim_cache_config defaults;
+    memsim_cache_config_init(&defaults);
+    if (config == nullptr) config = &defaults;
+    if (!validPolicy(config->policy) || config->l1_sectors < 1 || config->l2_sectors < 1) {
+        return MEMSIM_ERR_ARGUMENT;
+    }
+
+    CacheSimulator::Options options;
+    options.l1Sectors = static_cast<size_t>(config->l1_sectors);
+    options.l2Sectors = static_cast<size_t>(config->l2_sectors);
+    try {
+        *cache = new memsim_cache(*config, options);
+    } catch (const std::invalid_argument&) {
+        return MEMSIM_ERR_ARGUMENT;
+    } catch (const std::bad_alloc&) {
+        return MEMSIM_ERR_NO_MEMORY;
+    } catch (const std::exception&) {
+        return MEMSIM_ERR_INTERNAL;
+    }
+    return MEMSIM_OK;
+}
+
+void memsim_cache_destroy(memsim_cache* cache) {
+    delete cache;
+}
+
+int memsim_cache_set_policy(memsim_cache* cache, int level, int policy) {
+    if (cache == nullptr || !validPolicy(policy) || level < 0 || level > 2) return MEMSIM_ERR_ARGUMENT;
+    try {
+        CacheSimulator::ReplacementPolicy p = static_cast<CacheSimulator::ReplacementPolicy>(policy);
+        if (level == 0) {
+            cache->simulator.setReplacementPolicy(p);
+        } else {
+            cache->simulator.setReplacementPolicy(static_cast<size_t>(level), p);
+        }
+    } catch (const std::exception&) {
+        return MEMSIM_ERR_INTERNAL;
+    }
+    return MEMSIM_OK;
+}
+
+int memsim_cache_access(memsim_cache* cache, uint64_t address, int is_write) {
+    if (cache == nullptr) return MEMSIM_ERR_ARGUMENT;
+    try {
+        CacheSimulator::CacheAccessReport report = cache->simulator.access(address, is_write != 0);
+        return (report.l1Hit ? MEMSIM_L1_HIT : 0) | (report.l2Hit ? MEMSIM_L2_HIT : 0);
+    } catch (const std::exception&) {
+        return MEMSIM_ERR_INTERNAL;
+    }
+}
+
+size_t memsim_cache_access_batch(memsim_cache* cache, const uint64_t* addresses,
+                                 const uint8_t* is_write, uint8_t* results, size_t count) {
+    if (cache == nullptr || addresses == nullptr) return 0;
+    size_t l1Hits = 0;
+    try {
+        for (size_t i = 0; i < count; i++) {
+            CacheSimulator::CacheAccessReport report =
+                cache->simulator.access(addresses[i], is_write != nullptr && is_write[i] != 0);
+            l1Hits += report.l1Hit ? 1 : 0;
+            if (results != nullptr) {
+                results[i] = static_cast<uint8_t>((report.l1Hit ? MEMSIM_L1_HIT : 0) |
+                                                  (report.l2Hit ? MEMSIM_L2_HIT : 0));
+            }
+        }
+    } catch (const std::exception&) {
+    }
+    return l1Hits;
+}
+
+int memsim_cache_get_info(const memsim_cache* cache, memsim_cache_info* info) {
+    if (cache == nullptr || info == nullptr) return MEMSIM_ERR_ARGUMENT;
+    const CacheSimulator& simulator = cache->simulator;
+    info->l1_hits = simulator.getHits(1);
+    info->l1_misses = simulator.getMisses(1);
+    info->l2_hits = simulator.getHits(2);
+    info->l2_misses = simulator.getMisses(2);
+    info->l1_fill_bytes = simulator.getFillBytes(1);
+    info->l2_fill_bytes = simulator.getFillBytes(2);
+    info->l1_writeback_bytes = simulator.getWritebackBytes(1);
+    info->l2_writeback_bytes = simulator.getWritebackBytes(2);
+    info->memory_read_bytes = simulator.getMemoryReadBytes();
+    info->memory_write_bytes = simulator.getMemoryWriteBytes();
+    return MEMSIM_OK;
+}
+
+int memsim_cache_print(const memsim_cache* cache) {
+    if (cache == nullptr) return MEMSIM_ERR_ARGUMENT;
+    cache->simulator.printStatistics();
+    return MEMSIM_OK;
+}
+
+// ---------------------------------------------------------------------------
+// Statistics
+// ---------------------------------------------------------------------------
+
+int memsim_stats_create(memsim_stats** stats) {
+    if (stats == nullptr) return MEMSIM_ERR_ARGUMENT;
+    *stats = new (std::nothrow) memsim_stats();
+    return *stats != nullptr ? MEMSIM_OK : MEMSIM_ERR_NO_MEMORY;
+}
+
+void memsim_stats_destroy(memsim_stats* stats) {
+    delete stats;
+}
+
+int memsim_stats_record_allocation(memsim_stats* stats, uint64_t size, int success) {
+    if (stats == nullptr) return MEMSIM_ERR_ARGUMENT;
+    stats->manager.logMemoryAllocation(size, success != 0);
+    return MEMSIM_OK;
+}
+
+int memsim_stats_collect(memsim_stats* stats, const memsim_heap* heap, const memsim_cache* cache) {
+    if (stats == nullptr) return MEMSIM_ERR_ARGUMENT;
+    try {
+        if (heap != nullptr) {
+            const MemoryManager& manager = heap->manager;
+            stats->manager.setFragmentationMetrics(manager.getInternalFragmentation(),
+                                                   manager.getExternalFragmentation(),
+                                                   manager.getMemoryUtilization());
+            stats->manager.setMemoryStats(manager.getTotalMemory(), manager.getUsedMemory(),
+                                          manager.getFreeMemory());
+        }
+        if (cache != nullptr) {
+            const CacheSimulator& simulator = cache->simulator;
+            stats->manager.setCacheStats(simulator.getHits(1), simulator.getMisses(1),
+                                         simulator.getHits(2), simulator.getMisses(2));
+        }
+    } catch (const std::exception&) {
+        return MEMSIM_ERR_INTERNAL;
+    }
+    return MEMSIM_OK;
+}
+
+int memsim_stats_print(const memsim_stats* stats) {
+    if (stats == nullptr) return MEMSIM_ERR_ARGUMENT;
+    stats->manager.printStats();
+    return MEMSIM_OK;
+}
+
+} // extern "C"
@@ -0,0 +1,165 @@
+#ifndef MEMSIM_H
+#define MEMSIM_H
+
+/*
+ * libmemsim: C API over the allocator (MemoryManager), cache hierarchy
+ * (CacheSimulator) and statistics (StatsManager) models.
+ *
+ * Link with -lmemsim (bin/libmemsim.a or bin/libmemsim.so; the static
+ * library also needs the C++ runtime, e.g. link with g++ or add -lstdc++).
+ *
+ * Conventions:
+ *   - Handles are opaque; each create has a matching destroy.
+ *   - Functions return MEMSIM_OK (0) or a negative memsim_status.
+ *   - Addresses are physical: byte offsets from the start of the heap.
+ *   - No C++ exception crosses the API.
+ *   - A handle must not be used from two threads at once; different handles
+ *     are independent.
+ *   - Config structs must be initialized with their *_config_init function
+ *     so fields added in later versions get defaults.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32) && defined(MEMSIM_BUILD_SHARED)
+#define MEMSIM_API __declspec(dllexport)
+#elif defined(__GNUC__)
+#define MEMSIM_API __attribute__((visibility("default")))
+#else
+#define MEMSIM_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MEMSIM_API_VERSION 1
+
+typedef struct memsim_heap memsim_heap;
+typedef struct memsim_cache memsim_cache;
+typedef struct memsim_stats memsim_stats;
+
+typedef enum memsim_status {
+    MEMSIM_OK = 0,
+    MEMSIM_ERR_ARGUMENT = -1,   /* Invalid handle, value or configuration */
+    MEMSIM_ERR_NO_MEMORY = -2,  /* Allocation did not fit in the simulated heap */
+    MEMSIM_ERR_NOT_FOUND = -3,  /* No allocated block at this address */
+    MEMSIM_ERR_INTERNAL = -4    /* Unexpected failure inside the library */
+} memsim_status;
+
+typedef enum memsim_strategy {
+    MEMSIM_FIRST_FIT = 0,
+    MEMSIM_BEST_FIT = 1,
+    MEMSIM_WORST_FIT = 2
+} memsim_strategy;
+
+typedef enum memsim_policy {
+    MEMSIM_FIFO = 0,
+    MEMSIM_LRU = 1,
+    MEMSIM_LFU = 2,
+    MEMSIM_LFU_DA = 3,  /* LFU with dynamic aging */
+    MEMSIM_HAWKEYE = 4  /* PC-indexed predictor trained on OPT (no PC here: one shared entry) */
+} memsim_policy;
+
+/* Bits of a memsim_cache_access result */
+#define MEMSIM_L1_HIT 1
+#define MEMSIM_L2_HIT 2
+
+/* Returned in a batch's address array for a failed allocation */
+#define MEMSIM_NULL_ADDRESS UINT64_MAX
+
+MEMSIM_API int memsim_api_version(void);
+MEMSIM_API const char* memsim_status_string(int status);
+
+/* ---- Heap ------------------------------------------------------------- */
+
+typedef struct memsim_heap_config {
+    int strategy;       /* memsim_strategy, default MEMSIM_FIRST_FIT */
+    int size_tree;      /* 1: size-ordered free index (O(log n) best/worst fit) */
+    int compact_header; /* 1: 16-byte headers, heaps below 2 GB */
+} memsim_heap_config;
+
+typedef struct memsim_heap_info {
+    uint64_t total_bytes;
+    uint64_t used_bytes;
+    uint64_t free_bytes;
+    uint64_t allocations_ok;
+    uint64_t allocations_failed;
+    uint64_t header_bytes;
+    double internal_fragmentation;  /* Percent */
+    double external_fragmentation;  /* Percent */
+    double utilization;             /* Percent */
+} memsim_heap_info;
+
+MEMSIM_API void memsim_heap_config_init(memsim_heap_config* config);
+/* config may be NULL for defaults */
+MEMSIM_API int memsim_heap_create(uint64_t size, const memsim_heap_config* config, memsim_heap** heap);
+MEMSIM_API void memsim_heap_destroy(memsim_heap* heap);
+MEMSIM_API int memsim_heap_set_strategy(memsim_heap* heap, int strategy);
+
+MEMSIM_API int memsim_malloc(memsim_heap* heap, uint64_t size, uint64_t* address);
+MEMSIM_API int memsim_free(memsim_heap* heap, uint64_t address);
+
+/* Batched forms: one call for `count` operations. A failed allocation
+ * stores MEMSIM_NULL_ADDRESS. Return the number of operations that
+ * succeeded (allocated / freed). */
+MEMSIM_API size_t memsim_malloc_batch(memsim_heap* heap, const uint64_t* sizes,
+                                      uint64_t* addresses, size_t count);
+MEMSIM_API size_t memsim_free_batch(memsim_heap* heap, const uint64_t* addresses, size_t count);
+
+MEMSIM_API int memsim_heap_get_info(const memsim_heap* heap, memsim_heap_info* info);
+/* Prints the block layout to stdout, like the CLI's 'dump memory' */
+MEMSIM_API int memsim_heap_dump(const memsim_heap* heap);
+
+/* ---- Cache hierarchy -------------------------------------------------- */
+
+typedef struct memsim_cache_config {
+    uint64_t l1_size, l1_block_size, l1_associativity;  /* default 16 KB, 64 B, 4-way */
+    uint64_t l2_size, l2_block_size, l2_associativity;  /* default 64 KB, 64 B, 8-way */
+    int policy;        /* memsim_policy, default MEMSIM_FIFO */
+    int l1_sectors;    /* Sectors per block, default 1 */
+    int l2_sectors;
+} memsim_cache_config;
+
+typedef struct memsim_cache_info {
+    uint64_t l1_hits, l1_misses;
+    uint64_t l2_hits, l2_misses;
+    uint64_t l1_fill_bytes, l2_fill_bytes;
+    uint64_t l1_writeback_bytes, l2_writeback_bytes;
+    uint64_t memory_read_bytes, memory_write_bytes;
+} memsim_cache_info;
+
+MEMSIM_API void memsim_cache_config_init(memsim_cache_config* config);
+/* config may be NULL for defaults; an inconsistent geometry is MEMSIM_ERR_ARGUMENT */
+MEMSIM_API int memsim_cache_create(const memsim_cache_config* config, memsim_cache** cache);
+MEMSIM_API void memsim_cache_destroy(memsim_cache* cache);
+/* level 1 or 2, or 0 for both */
+MEMSIM_API int memsim_cache_set_policy(memsim_cache* cache, int level, int policy);
+
+/* Returns MEMSIM_L1_HIT / MEMSIM_L2_HIT bits (0 = missed both), or a negative status */
+MEMSIM_API int memsim_cache_access(memsim_cache* cache, uint64_t address, int is_write);
+
+/* Batched accesses. is_write and results may be NULL (all reads / results
+ * not wanted). Returns the number of L1 hits in the batch. */
+MEMSIM_API size_t memsim_cache_access_batch(memsim_cache* cache, const uint64_t* addresses,
+                                            const uint8_t* is_write, uint8_t* results, size_t count);
+
+MEMSIM_API int memsim_cache_get_info(const memsim_cache* cache, memsim_cache_info* info);
+/* Prints the per-level report to stdout, like the CLI's 'stats' */
+MEMSIM_API int memsim_cache_print(const memsim_cache* cache);
+
+/* ---- Statistics ------------------------------------------------------- */
+
+MEMSIM_API int memsim_stats_create(memsim_stats** stats);
+MEMSIM_API void memsim_stats_destroy(memsim_stats* stats);
+MEMSIM_API int memsim_stats_record_allocation(memsim_stats* stats, uint64_t size, int success);
+/* Copies the current heap and cache figures in; either may be NULL */
+MEMSIM_API int memsim_stats_collect(memsim_stats* stats, const memsim_heap* heap, const memsim_cache* cache);
+MEMSIM_API int memsim_stats_print(const memsim_stats* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MEMSIM_H */
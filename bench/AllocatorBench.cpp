@@ -0,0 +1,205 @@
+#include "AllocatorEngine.h"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Allocator micro-benchmark: the runtime-switched fit (RuntimeFitPolicy on the
+// original free list and header) against every compile-time specialization.
+//
+//   bin/AllocatorBench [operations] [heap_bytes]
+//
+// End-to-end: each engine replays the same seeded malloc/free sequence; the
+// success/failure counts are printed so diverging placements are visible.
+// Those timings include the bookkeeping every engine shares (tracking maps,
+// coalescing, page tracking), so a second section times the fit search alone
+// on a fragmented free index.
+
+namespace {
+
+struct Op {
+    bool is_alloc;
+    size_t value; // Request size, or index into the live-block list for a free
+};
+
+std::vector<Op> makeWorkload(size_t operations) {
+    std::mt19937_64 rng(12345);
+    std::uniform_int_distribution<size_t> sizeDist(8, 512);
+    std::vector<Op> ops;
+    ops.reserve(operations);
+    size_t live = 0;
+    for (size_t i = 0; i < operations; i++) {
+        // Bias toward allocation until a steady state builds up
+        bool alloc = live == 0 || (rng() % 100) < (live < 500 ? 60u : 40u);
+        if (alloc) {
+            ops.push_back(Op{true, sizeDist(rng)});
+            live++;
+        } else {
+            ops.push_back(Op{false, static_cast<size_t>(rng())});
+            live--;
+        }
+    }
+    return ops;
+}
+
+struct Result {
+    double nsPerOp;
+    size_t successes;
+    size_t failures;
+};
+
+Result run(AllocatorEngine& engine, const std::vector<Op>& ops) {
+    std::vector<void*> live;
+    live.reserve(ops.size());
+    auto start = std::chrono::steady_clock::now();
+    for (const Op& op : ops) {
+        if (op.is_alloc) {
+            void* ptr = engine.allocate(op.value);
+            if (ptr != nullptr) live.push_back(ptr);
+        } else if (!live.empty()) {
+            size_t victim = op.value % live.size();
+            engine.deallocate(live[victim]);
+            live[victim] = live.back();
+            live.pop_back();
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(end - start).count();
+    return Result{ns / ops.size(), engine.getAllocationSuccessCount(), engine.getAllocationFailureCount()};
+}
+
+const char* strategyName(MemoryManager::AllocationStrategy strategy) {
+    switch (strategy) {
+        case MemoryManager::FIRST_FIT: return "first_fit";
+        case MemoryManager::BEST_FIT: return "best_fit";
+        case MemoryManager::WORST_FIT: return "worst_fit";
+    }
+    return "unknown";
+}
+
+void printRow(const std::string& name, const Result& result, double baseline) {
+    std::cout << "  " << std::left << std::setw(28) << name << std::right
+              << std::setw(10) << std::fixed << std::setprecision(1) << result.nsPerOp << " ns/op"
+              << std::setw(8) << std::setprecision(2) << baseline / result.nsPerOp << "x"
+              << "   ok=" << result.successes << " failed=" << result.failures << "\n";
+}
+
+// Sum of the block sizes every fit search found; written so the searches
+// cannot be optimized away
+volatile size_t fitChecksum = 0;
+
+// Fit search on a heap of `blocks` free blocks of random size, separated by
+// used blocks so nothing coalesces. Returns ns per lookup.
+template <class Layout, class Index, class Fit>
+double timeFit(const Fit& fit, size_t blocks, size_t lookups) {
+    typedef typename Layout::Header Header;
+    std::mt19937_64 rng(777);
+    std::uniform_int_distribution<size_t> sizeDist(Layout::HEADER_SIZE + 8, Layout::HEADER_SIZE + 1024);
+
+    std::vector<size_t> sizes(blocks);
+    size_t heapSize = 0;
+    for (size_t& size : sizes) {
+        size = sizeDist(rng);
+        heapSize += size + Layout::HEADER_SIZE + 8;
+    }
+
+    std::vector<char> heap(heapSize, 0);
+    Index index;
+    index.reset(heap.data());
+    BlockStartMap starts;
+    starts.reset(heapSize);
+    size_t offset = 0;
+    for (size_t size : sizes) {
+        Header* block = reinterpret_cast<Header*>(heap.data() + offset);
+        Layout::init(heap.data(), block, size);
+        index.insert(block);
+        starts.set(offset);
+        starts.set(offset + size);
+        Header* used = reinterpret_cast<Header*>(heap.data() + offset + size);
+        Layout::init(heap.data(), used, Layout::HEADER_SIZE + 8);
+        Layout::setFree(used, false);
+        offset += size + Layout::HEADER_SIZE + 8;
+    }
+
+    std::vector<size_t> requests(lookups);
+    for (size_t& request : requests) request = sizeDist(rng);
+
+    size_t found = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t request : requests) {
+        // Use the block itself, or the search inside a bin can be optimized away
+        Header* block = fit.template find<Layout>(index, starts, request);
+        found += block == nullptr ? 0 : Layout::blockSize(block);
+    }
+    auto end = std::chrono::steady_clock::now();
+    fitChecksum = found;
+    return std::chrono::duration<double, std::nano>(end - start).count() / lookups;
+}
+
+template <class Fit>
+void benchFit(MemoryManager::AllocationStrategy strategy, size_t blocks, size_t lookups) {
+    double base = timeFit<StandardHeaderLayout, FreeListIndex<StandardHeaderLayout>>(
+        RuntimeFitPolicy(strategy), blocks, lookups);
+    double rows[6] = {
+        timeFit<StandardHeaderLayout, FreeListIndex<StandardHeaderLayout>>(Fit(), blocks, lookups),
+        timeFit<CompactHeaderLayout, FreeListIndex<CompactHeaderLayout>>(Fit(), blocks, lookups),
+        timeFit<StandardHeaderLayout, SizeTreeIndex<StandardHeaderLayout>>(Fit(), blocks, lookups),
+        timeFit<CompactHeaderLayout, SizeTreeIndex<CompactHeaderLayout>>(Fit(), blocks, lookups),
+        timeFit<StandardHeaderLayout, SegregatedBinsIndex<StandardHeaderLayout>>(Fit(), blocks, lookups),
+        timeFit<CompactHeaderLayout, SegregatedBinsIndex<CompactHeaderLayout>>(Fit(), blocks, lookups)};
+    const char* names[6] = {"specialized (list, standard)", "specialized (list, compact)",
+                            "specialized (tree, standard)", "specialized (tree, compact)",
+                            "specialized (inband, standard)", "specialized (inband, compact)"};
+
+    std::cout << "\n" << strategyName(strategy) << " search, " << blocks << " free blocks:\n";
+    std::cout << "  " << std::left << std::setw(28) << "runtime switch (list)" << std::right
+              << std::setw(10) << std::fixed << std::setprecision(1) << base << " ns/lookup\n";
+    for (int i = 0; i < 6; i++) {
+        std::cout << "  " << std::left << std::setw(28) << names[i] << std::right
+                  << std::setw(10) << std::fixed << std::setprecision(1) << rows[i] << " ns/lookup"
+                  << std::setw(8) << std::setprecision(2) << base / rows[i] << "x\n";
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t operations = argc > 1 ? std::stoull(argv[1]) : 500000;
+    size_t heapSize = argc > 2 ? std::stoull(argv[2]) : 4 * 1024 * 1024;
+    std::vector<Op> ops = makeWorkload(operations);
+
+    std::cout << "Allocator benchmark: " << operations << " operations, " << heapSize << "-byte heap\n";
+
+    const MemoryManager::AllocationStrategy strategies[] = {
+        MemoryManager::FIRST_FIT, MemoryManager::BEST_FIT, MemoryManager::WORST_FIT};
+
+    for (MemoryManager::AllocationStrategy strategy : strategies) {
+        std::cout << "\n" << strategyName(strategy) << ":\n";
+
+        AllocatorEngineT<RuntimeFitPolicy, FreeListIndex<StandardHeaderLayout>, StandardHeaderLayout>
+            runtime(heapSize, RuntimeFitPolicy(strategy));
+        Result base = run(runtime, ops);
+        printRow("runtime switch (list)", base, base.nsPerOp);
+
+        const MemoryManager::FreeIndex indexes[] = {MemoryManager::FREE_LIST, MemoryManager::SIZE_TREE,
+                                                     MemoryManager::IN_BAND};
+        const MemoryManager::HeaderLayout layouts[] = {MemoryManager::STANDARD_HEADER, MemoryManager::COMPACT_HEADER};
+        for (MemoryManager::FreeIndex index : indexes) {
+            for (MemoryManager::HeaderLayout layout : layouts) {
+                std::unique_ptr<AllocatorEngine> engine = makeAllocatorEngine(heapSize, strategy, index, layout);
+                std::string name = std::string("specialized (") +
+                                   (index == MemoryManager::SIZE_TREE ? "tree" : index == MemoryManager::IN_BAND ? "inband" : "list") + ", " +
+                                   (layout == MemoryManager::COMPACT_HEADER ? "compact" : "standard") + ")";
+                printRow(name, run(*engine, ops), base.nsPerOp);
+            }
+        }
+    }
+
+    std::cout << "\nFit search only:\n";
+    benchFit<FirstFitPolicy>(MemoryManager::FIRST_FIT, 4096, 20000);
+    benchFit<BestFitPolicy>(MemoryManager::BEST_FIT, 4096, 20000);
+    benchFit<WorstFitPolicy>(MemoryManager::WORST_FIT, 4096, 20000);
+    return 0;
+}
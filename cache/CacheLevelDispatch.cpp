@@ -0,0 +1,97 @@
+#include "CacheLevelT.h"
+#include "CompactTagStore.h"
+#include "FullyAssociativeLevel.h"
+#include <map>
+#include <tuple>
+#include <type_traits>
+#include <initializer_list>
+
+// Dispatch table of CacheLevelT specializations, keyed by (sets, ways, line
+// bytes, policy). Covers the common power-of-two L1/L2 shapes with 64-byte
+// lines and FIFO/LRU/LFU; any other geometry or policy falls back to the
+// compact, fully-associative or generic CacheLevel path.
+// Kept in its own translation unit because it instantiates every engine.
+
+namespace {
+
+typedef std::tuple<size_t, size_t, size_t, int> LevelKey;
+
+} // namespace
+
+std::unique_ptr<CacheSimulator::LevelEngine> CacheSimulator::makeSpecializedLevel(
+        size_t sets, size_t ways, size_t line_bytes, ReplacementPolicy policy) {
+    typedef std::unique_ptr<LevelEngine> (*Factory)();
+    // Built once by the initializer: C++11 makes it thread-safe, and experiment
+    // workers construct simulators concurrently
+    static const std::map<LevelKey, Factory> table = [] {
+        std::map<LevelKey, Factory> entries;
+        // Sets x Ways x Policy for 64-byte lines: 7 x 5 x 3 specializations
+        auto addSets = [&entries](auto policy_tag, auto ways_tag, auto... sets_tags) {
+            constexpr ReplacementPolicy P = decltype(policy_tag)::value;
+            constexpr size_t W = decltype(ways_tag)::value;
+            (void)std::initializer_list<int>{
+                (entries[LevelKey(decltype(sets_tags)::value, W, 64, P)] =
+                     []() -> std::unique_ptr<LevelEngine> {
+                         return std::unique_ptr<LevelEngine>(
+                             new CacheLevelT<decltype(sets_tags)::value, W, 64, P>());
+                     },
+                 0)...};
+        };
+        auto addWays = [&addSets](auto policy_tag) {
+            auto addFor = [&](auto ways_tag) {
+                addSets(policy_tag, ways_tag,
+                        std::integral_constant<size_t, 64>(), std::integral_constant<size_t, 128>(),
+                        std::integral_constant<size_t, 256>(), std::integral_constant<size_t, 512>(),
+                        std::integral_constant<size_t, 1024>(), std::integral_constant<size_t, 2048>(),
+                        std::integral_constant<size_t, 4096>());
+            };
+            addFor(std::integral_constant<size_t, 1>());
+            addFor(std::integral_constant<size_t, 2>());
+            addFor(std::integral_constant<size_t, 4>());
+            addFor(std::integral_constant<size_t, 8>());
+            addFor(std::integral_constant<size_t, 16>());
+        };
+        addWays(std::integral_constant<ReplacementPolicy, FIFO>());
+        addWays(std::integral_constant<ReplacementPolicy, LRU>());
+        addWays(std::integral_constant<ReplacementPolicy, LFU>());
+        return entries;
+    }();
+
+    auto it = table.find(LevelKey(sets, ways, line_bytes, policy));
+    if (it == table.end()) {
+        return nullptr;
+    }
+    return it->second();
+}
+
+// Compact tag store for levels without a specialization: the tag word is the
+// smallest of 16/32/64 bits that holds the level's tag.
+std::unique_ptr<CacheSimulator::LevelEngine> CacheSimulator::makeCompactLevel(
+        size_t sets, size_t ways, size_t line_bytes, size_t tag_bits, ReplacementPolicy policy) {
+    auto make = [&](auto tag_tag) -> std::unique_ptr<LevelEngine> {
+        constexpr size_t T = decltype(tag_tag)::value;
+        switch (policy) {
+            case FIFO: return std::unique_ptr<LevelEngine>(new CompactLevel<T, FIFO>(sets, ways, line_bytes));
+            case LRU: return std::unique_ptr<LevelEngine>(new CompactLevel<T, LRU>(sets, ways, line_bytes));
+            case LFU: return std::unique_ptr<LevelEngine>(new CompactLevel<T, LFU>(sets, ways, line_bytes));
+            case LFU_DA: return std::unique_ptr<LevelEngine>(new CompactLevel<T, LFU_DA>(sets, ways, line_bytes));
+            case HAWKEYE: break;    // Generic path only (see bindEngine)
+        }
+        return nullptr;
+    };
+    if (tag_bits <= 16) return make(std::integral_constant<size_t, 16>());
+    if (tag_bits <= 32) return make(std::integral_constant<size_t, 32>());
+    return make(std::integral_constant<size_t, 64>());
+}
+
+std::unique_ptr<CacheSimulator::LevelEngine> CacheSimulator::makeFullyAssociativeLevel(
+        size_t ways, size_t line_bytes, ReplacementPolicy policy) {
+    switch (policy) {
+        case FIFO: return std::unique_ptr<LevelEngine>(new FullyAssociativeLevel<FIFO>(ways, line_bytes));
+        case LRU: return std::unique_ptr<LevelEngine>(new FullyAssociativeLevel<LRU>(ways, line_bytes));
+        case LFU: return std::unique_ptr<LevelEngine>(new FullyAssociativeLevel<LFU>(ways, line_bytes));
+        case LFU_DA: return std::unique_ptr<LevelEngine>(new FullyAssociativeLevel<LFU_DA>(ways, line_bytes));
+        case HAWKEYE: break;
+    }
+    return nullptr;
+}
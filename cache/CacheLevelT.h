@@ -0,0 +1,254 @@
+#ifndef CACHE_LEVEL_T_H
+#define CACHE_LEVEL_T_H
+
+#include "CacheSimulator.h"
+#include <array>
+#include <vector>
+#include <algorithm>
+
+// Storage/lookup engine for one cache level. The generic CacheLevel path in
+// CacheSimulator.cpp handles every configuration; an engine is only bound for
+// configurations with a matching compile-time specialization.
+class CacheSimulator::LevelEngine {
+public:
+    struct FillResult {
+        bool evicted;
+        size_t victim_tag;
+        size_t victim_set;
+        bool victim_dirty;
+    };
+
+    virtual ~LevelEngine() {}
+
+    // Lookup. On a hit with update_stats, replacement metadata is refreshed
+    // with time `now`; a hit with is_write marks the block dirty.
+    virtual bool probe(size_t address, size_t now, bool update_stats, bool is_write) = 0;
+
+    // Installs the block containing `address` (the caller has seen the miss).
+    // With lru_end (LRU levels only) the block enters below every other valid
+    // line of its set instead of as the most recently used one.
+    virtual FillResult fill(size_t address, size_t now, bool is_write, bool lru_end) = 0;
+
+    // Merges an upper-level write-back; false if the block is not resident.
+    virtual bool markDirty(size_t address) = 0;
+
+    // LFU aging: halves every count (and the LFU-DA ages)
+    virtual void halveCounts() = 0;
+
+    // Host memory held by the engine's block state
+    virtual size_t storageBytes() const = 0;
+
+    // Moves block state to/from the generic per-set representation
+    virtual void exportTo(CacheLevel& level) const = 0;
+    virtual void importFrom(const CacheLevel& level) = 0;
+};
+
+// Compile-time specialized set-associative level: power-of-two sets, modulo
+// indexing, unsectored blocks. Shifts and masks are constants, the way loops
+// have a constant trip count and are unrolled, and the replacement policy is
+// resolved with `if constexpr` instead of a per-access switch.
+//
+// Decisions mirror the generic path exactly: the lowest invalid way is filled
+// first, and ties in the victim search go to the lowest way.
+template <size_t Sets, size_t Ways, size_t LineBytes, CacheSimulator::ReplacementPolicy Policy>
+class CacheSimulator::CacheLevelT : public CacheSimulator::LevelEngine {
+    static_assert(Sets != 0 && (Sets & (Sets - 1)) == 0, "Sets must be a power of two");
+    static_assert(LineBytes != 0 && (LineBytes & (LineBytes - 1)) == 0, "LineBytes must be a power of two");
+    static_assert(Ways >= 1 && Ways <= 64, "Ways out of range");
+    static_assert(Policy != CacheSimulator::LFU_DA, "LFU-DA levels use the generic or compact path");
+
+    static constexpr size_t log2(size_t value) {
+        return value <= 1 ? 0 : 1 + log2(value >> 1);
+    }
+
+    static constexpr size_t OFFSET_BITS = log2(LineBytes);
+    static constexpr size_t INDEX_BITS = log2(Sets);
+    static constexpr size_t SET_MASK = Sets - 1;
+
+    struct Line {
+        size_t tag;
+        size_t load_time;
+        size_t last_access;
+        size_t access_count;
+        bool valid;
+        bool dirty;
+    };
+
+    std::array<Line, Sets * Ways> lines;
+
+    static size_t setOf(size_t address) { return (address >> OFFSET_BITS) & SET_MASK; }
+    static size_t tagOf(size_t address) { return address >> (OFFSET_BITS + INDEX_BITS); }
+
+    Line* lookup(size_t address) {
+        Line* set = &lines[setOf(address) * Ways];
+        size_t tag = tagOf(address);
+#pragma GCC unroll 16
+        for (size_t w = 0; w < Ways; w++) {
+            if (set[w].valid && set[w].tag == tag) {
+                return &set[w];
+            }
+        }
+        return nullptr;
+    }
+
+    static size_t victimWay(const Line* set) {
+        size_t victim = 0;
+#pragma GCC unroll 16
+        for (size_t w = 1; w < Ways; w++) {
+            if constexpr (Policy == CacheSimulator::FIFO) {
+                if (set[w].load_time < set[victim].load_time) victim = w;
+            } else if constexpr (Policy == CacheSimulator::LRU) {
+                if (set[w].last_access < set[victim].last_access) victim = w;
+            } else {
+                if (set[w].access_count < set[victim].access_count ||
+                    (set[w].access_count == set[victim].access_count &&
+                     set[w].last_access < set[victim].last_access)) {
+                    victim = w;
+                }
+            }
+        }
+        return victim;
+    }
+
+    static void touch(Line& line, size_t now) {
+        if constexpr (Policy == CacheSimulator::LRU) {
+            line.last_access = now;
+        } else if constexpr (Policy == CacheSimulator::LFU) {
+            line.access_count++;
+            line.last_access = now;
+        } else {
+            (void)line;
+            (void)now;
+        }
+    }
+
+public:
+    CacheLevelT() {
+        for (auto& line : lines) {
+            line = Line{0, 0, 0, 0, false, false};
+        }
+    }
+
+    bool probe(size_t address, size_t now, bool update_stats, bool is_write) override {
+        Line* line = lookup(address);
+        if (line == nullptr) {
+            return false;
+        }
+        if (update_stats) {
+            touch(*line, now);
+        }
+        if (is_write) {
+            line->dirty = true;
+        }
+        return true;
+    }
+
+    FillResult fill(size_t address, size_t now, bool is_write, bool lru_end) override {
+        size_t set_index = setOf(address);
+        Line* set = &lines[set_index * Ways];
+
+        FillResult result = {false, 0, set_index, false};
+        size_t way = Ways;
+#pragma GCC unroll 16
+        for (size_t w = 0; w < Ways; w++) {
+            if (!set[w].valid) {
+                way = w;
+                break;
+            }
+        }
+        if (way == Ways) {
+            way = victimWay(set);
+            result.evicted = true;
+            result.victim_tag = set[way].tag;
+            result.victim_dirty = set[way].dirty;
+        }
+
+        Line& line = set[way];
+        line.valid = true;
+        line.dirty = is_write;
+        line.tag = tagOf(address);
+        line.load_time = now;
+        line.last_access = now;
+        line.access_count = 1;
+        touch(line, now); // Same as the generic updateReplacementData on install
+        if (Policy == CacheSimulator::LRU && lru_end) {
+            // Same timestamp as the generic lruEndTime
+            size_t oldest = now + 1;
+            for (size_t w = 0; w < Ways; w++) {
+                if (w != way && set[w].valid) oldest = std::min(oldest, set[w].last_access);
+            }
+            line.last_access = oldest > 0 ? oldest - 1 : 0;
+        }
+        return result;
+    }
+
+    bool markDirty(size_t address) override {
+        Line* line = lookup(address);
+        if (line == nullptr) {
+            return false;
+        }
+        line->dirty = true;
+        return true;
+    }
+
+    void halveCounts() override {
+        for (auto& line : lines) {
+            line.access_count /= 2;
+        }
+    }
+
+    size_t storageBytes() const override { return sizeof(lines); }
+
+    void exportTo(CacheLevel& level) const override {
+        level.sets.assign(Sets, CacheSet());
+        for (size_t s = 0; s < Sets; s++) {
+            CacheSet& set = level.sets[s];
+            set.associativity = Ways;
+            set.blocks.resize(Ways);
+            for (size_t w = 0; w < Ways; w++) {
+                const Line& line = lines[s * Ways + w];
+                CacheBlock& block = set.blocks[w];
+                block.valid = line.valid;
+                block.tag = line.tag;
+                block.valid_sectors = line.valid ? 1 : 0;
+                block.dirty_sectors = line.dirty ? 1 : 0;
+                block.load_time = line.load_time;
+                block.last_access = line.last_access;
+                block.access_count = line.access_count;
+            }
+
+            // Rebuild the FIFO queue / LRU list in timestamp order once the set is full
+            std::vector<size_t> order;
+            for (size_t w = 0; w < Ways; w++) {
+                if (set.blocks[w].valid) order.push_back(w);
+            }
+            if (order.size() == Ways) {
+                std::stable_sort(order.begin(), order.end(), [&set](size_t a, size_t b) {
+                    return set.blocks[a].load_time < set.blocks[b].load_time;
+                });
+                for (size_t w : order) set.fifoQueue.push(w);
+            }
+            std::stable_sort(order.begin(), order.end(), [&set](size_t a, size_t b) {
+                return set.blocks[a].last_access < set.blocks[b].last_access;
+            });
+            for (size_t w : order) set.lruList.push_back(w);
+        }
+    }
+
+    void importFrom(const CacheLevel& level) override {
+        for (size_t s = 0; s < Sets && s < level.sets.size(); s++) {
+            for (size_t w = 0; w < Ways && w < level.sets[s].blocks.size(); w++) {
+                const CacheBlock& block = level.sets[s].blocks[w];
+                Line& line = lines[s * Ways + w];
+                line.valid = block.valid;
+                line.dirty = block.dirty_sectors != 0;
+                line.tag = block.tag;
+                line.load_time = block.load_time;
+                line.last_access = block.last_access;
+                line.access_count = block.access_count;
+            }
+        }
+    }
+};
+
+#endif // CACHE_LEVEL_T_H
@@ -1,36 +1,128 @@
 #include "CacheSimulator.h"
+#include "CacheLevelT.h"
+#include "CompactTagStore.h"
 #include <iostream>
 #include <iomanip>
 #include <cmath>
 #include <algorithm>
 #include <sstream> // Added for stringstream
+#include <stdexcept>
+#include <cstdint>
 
 CacheSimulator::CacheSimulator(size_t l1_size, size_t l1_block_size, size_t l1_associativity,
                                size_t l2_size, size_t l2_block_size, size_t l2_associativity,
-                               ReplacementPolicy policy)
-    : defaultPolicy(policy) {
-    initCacheLevel(l1_cache, 1, l1_size, l1_block_size, l1_associativity, policy);
-    initCacheLevel(l2_cache, 2, l2_size, l2_block_size, l2_associativity, policy);
+                               ReplacementPolicy policy, const Options& options)
+    : split_l1(options.l1iSize != 0), defaultPolicy(policy), memory_write_bytes(0), event_logging(true),
+      current_pc(0), current_fetch(false), comparison() {
+    if (options.addressBits == 0 || options.addressBits > 64) {
+        throw std::invalid_argument("address width must be 1-64 bits");
+    }
+    address_mask = options.addressBits == 64 ? ~static_cast<size_t>(0)
+                                             : (static_cast<size_t>(1) << options.addressBits) - 1;
+    if (options.bipPeriod == 0) {
+        throw std::invalid_argument("BIP period must be at least 1");
+    }
+    // L1 fills are what the core consumes, so only L2 may bypass
+    initCacheLevel(l1_cache, 1, split_l1 ? "L1D" : "L1", l1_size, l1_block_size, l1_associativity,
+                   options.l1Sectors, options.l1Insertion, false, policy, options);
+    if (split_l1) {
+        // Code is fetched in whole lines and never written: the L1I is unsectored
+        initCacheLevel(l1i_cache, 1, "L1I", options.l1iSize, options.l1iBlockSize, options.l1iAssociativity,
+                       1, options.l1Insertion, false, policy, options);
+    }
+    initCacheLevel(l2_cache, 2, "L2", l2_size, l2_block_size, l2_associativity, options.l2Sectors,
+                   options.l2Insertion, options.l2Bypass, policy, options);
+}
+
+CacheSimulator::~CacheSimulator() {
+}
+
+static bool isPowerOfTwo(size_t value) {
+    return value != 0 && (value & (value - 1)) == 0;
+}
+
+static size_t ceilLog2(size_t value) {
+    size_t bits = 0;
+    while ((static_cast<size_t>(1) << bits) < value) {
+        bits++;
+    }
+    return bits;
 }
 
-void CacheSimulator::initCacheLevel(CacheLevel& level, int levelNum, size_t size, size_t block_size, 
-                                   size_t associativity, ReplacementPolicy policy) {
+void CacheSimulator::initCacheLevel(CacheLevel& level, int levelNum, const std::string& name, size_t size,
+                                   size_t block_size, size_t associativity, size_t sectors, InsertionPolicy insertion, bool bypass,
+                                   ReplacementPolicy policy, const Options& options) {
+    // Validate geometry up front instead of silently mis-indexing later
+    if (!isPowerOfTwo(block_size)) {
+        throw std::invalid_argument(name + " block size must be a power of two (got " +
+                                    std::to_string(block_size) + ")");
+    }
+    if (associativity == 0) {
+        throw std::invalid_argument(name + " associativity must be at least 1");
+    }
+    if (size == 0 || size % (block_size * associativity) != 0) {
+        throw std::invalid_argument(name + " size must be a non-zero multiple of block_size * associativity (" +
+                                    std::to_string(block_size * associativity) + ")");
+    }
+    if (!isPowerOfTwo(sectors) || sectors > 64 || sectors > block_size) {
+        throw std::invalid_argument(name + " sectors per block must be a power of two, at most 64 and at most the block size");
+    }
+
     level.levelNum = levelNum;
+    level.name = name;
     level.size = size;
     level.block_size = block_size;
     level.associativity = associativity;
     level.policy = policy;
+    level.index_function = options.indexFunction;
     level.hits = 0;
     level.misses = 0;
     level.evictions = 0;
-    level.global_time = 0;
+    level.sector_misses = 0;
+    level.fill_bytes = 0;
+    level.writeback_bytes = 0;
+    level.aging_period = options.lfuAgingPeriod;
+    level.insertion = insertion;
+    level.bip_period = options.bipPeriod;
+    level.bip_fills = 0;
+    level.bypass = bypass;
+    level.dead_counters.assign(bypass ? DEAD_BLOCK_ENTRIES : 0, 0);
+    level.bypasses = 0;
+    level.dead_predictions = 0;
+    level.optgen_stride = 1;
+    level.friendly_fills = 0;
+    level.averse_fills = 0;
+    level.opt_hits = 0;
+    level.opt_misses = 0;
+    level.specialize = options.specialize;
+    level.compact_allowed = options.compact;
+    level.engine_kind = ENGINE_GENERIC;
+    level.engine.reset();
     
     // Calculate cache parameters
+    // Any set count is legal; non-power-of-two counts (e.g. 12-way 48K) use modulo indexing.
     level.num_sets = size / (block_size * associativity);
-    level.block_offset_bits = static_cast<size_t>(std::log2(block_size));
-    level.set_index_bits = static_cast<size_t>(std::log2(level.num_sets));
-    level.tag_bits = 64 - level.set_index_bits - level.block_offset_bits; // Assuming 64-bit addresses
-    
+    level.pow2_sets = isPowerOfTwo(level.num_sets);
+    level.sectors_per_block = sectors;
+    level.block_offset_bits = ceilLog2(block_size);
+    level.set_index_bits = ceilLog2(level.num_sets);
+    if (level.block_offset_bits + level.set_index_bits > options.addressBits) {
+        throw std::invalid_argument(name + " needs more than the " + std::to_string(options.addressBits) +
+                                    "-bit address width for its index and offset");
+    }
+    level.tag_bits = options.addressBits - level.set_index_bits - level.block_offset_bits;
+
+    // Every LIP fill into a free way takes a timestamp below the oldest valid
+    // line, so the clock starts high enough that these never reach zero
+    level.time_base = level.num_sets * associativity;
+    level.global_time = level.time_base;
+
+    // An engine allocates its own storage; the generic sets are only built without one
+    bindEngine(level);
+    if (level.engine) {
+        return;
+    }
+
     // Initialize sets
     level.sets.resize(level.num_sets);
     for (auto& set : level.sets) {
@@ -38,72 +130,211 @@ void CacheSimulator::initCacheLevel(CacheLevel& level, int levelNum, size_t size
         for (auto& block : set.blocks) {
             block.valid = false;
             block.tag = 0;
+            block.valid_sectors = 0;
+            block.dirty_sectors = 0;
             block.load_time = 0;
             block.last_access = 0;
             block.access_count = 0;
+            block.reused = false;
+            block.rrpv = HAWKEYE_MAX_RRPV;
+            block.signature = 0;
         }
         set.associativity = associativity;
     }
+    if (policy == HAWKEYE) {
+        initHawkeye(level);
+    }
+}
+
+void CacheSimulator::bindEngine(CacheLevel& level) {
+    // The dead-block predictor trains on per-line reuse bits only the generic blocks
+    // keep, and Hawkeye on their RRPVs and signatures
+    if (!level.specialize || level.sectors_per_block != 1 || level.bypass || level.policy == HAWKEYE) {
+        return;
+    }
+
+    if (level.num_sets == 1 && level.index_function != INDEX_SKEWED) {
+        // One set: every index function selects it, and the tag is the block address
+        level.engine = makeFullyAssociativeLevel(level.associativity, level.block_size, level.policy);
+        level.engine_kind = ENGINE_FULLY_ASSOCIATIVE;
+    } else if (level.index_function == INDEX_MODULO && level.pow2_sets) {
+        level.engine = makeSpecializedLevel(level.num_sets, level.associativity, level.block_size, level.policy);
+        level.engine_kind = ENGINE_SPECIALIZED;
+        if (!level.engine && level.associativity <= 64 &&
+            (level.compact_allowed || level.num_sets * level.associativity >= COMPACT_MIN_LINES)) {
+            level.engine = makeCompactLevel(level.num_sets, level.associativity, level.block_size,
+                                            level.tag_bits, level.policy);
+            level.engine_kind = ENGINE_COMPACT;
+        }
+    }
+    if (!level.engine) {
+        level.engine_kind = ENGINE_GENERIC;
+    }
+    if (level.engine) {
+        level.engine->importFrom(level);
+        level.sets.clear();
+        level.sets.shrink_to_fit();
+    }
 }
 
-CacheSimulator::CacheAccessReport CacheSimulator::access(size_t physical_address) {
+void CacheSimulator::unbindEngine(CacheLevel& level) {
+    if (level.engine) {
+        level.engine->exportTo(level);
+        level.engine.reset();
+        level.engine_kind = ENGINE_GENERIC;
+    }
+}
+
+bool CacheSimulator::isSpecialized(size_t level) const {
+    return getEngineKind(level) == ENGINE_SPECIALIZED;
+}
+
+bool CacheSimulator::isCompact(size_t level) const {
+    return getEngineKind(level) == ENGINE_COMPACT;
+}
+
+CacheSimulator::LevelEngineKind CacheSimulator::getEngineKind(size_t level) const {
+    const CacheLevel* target = findLevel(level);
+    return target != nullptr ? target->engine_kind : ENGINE_GENERIC;
+}
+
+size_t CacheSimulator::getBypasses(size_t level) const {
+    const CacheLevel* target = findLevel(level);
+    return target != nullptr ? target->bypasses : 0;
+}
+
+size_t CacheSimulator::getTagStoreBytes(size_t level) const {
+    const CacheLevel* target = findLevel(level);
+    if (target == nullptr) return 0;
+    if (target->engine) return target->engine->storageBytes();
+    // Generic sets: set objects and their blocks (queue/list nodes not counted)
+    return target->sets.size() * (sizeof(CacheSet) + target->associativity * sizeof(CacheBlock));
+}
+
+const CacheSimulator::CacheLevel* CacheSimulator::findLevel(size_t level) const {
+    if (level == 1) return &l1_cache;
+    if (level == 2) return &l2_cache;
+    if (level == L1I_LEVEL && split_l1) return &l1i_cache;
+    return nullptr;
+}
+
+CacheSimulator::CacheLevel* CacheSimulator::findLevel(size_t level) {
+    return const_cast<CacheLevel*>(static_cast<const CacheSimulator*>(this)->findLevel(level));
+}
+
+CacheSimulator::CacheAccessReport CacheSimulator::access(size_t physical_address, bool is_write, uint64_t pc) {
+    current_pc = pc;
+    current_fetch = false;
+    return accessThrough(l1_cache, physical_address, is_write);
+}
+
+CacheSimulator::CacheAccessReport CacheSimulator::fetch(size_t physical_address) {
+    current_pc = physical_address;
+    current_fetch = true;
+    return accessThrough(split_l1 ? l1i_cache : l1_cache, physical_address, false);
+}
+
+CacheSimulator::CacheAccessReport CacheSimulator::accessThrough(CacheLevel& l1, size_t physical_address,
+                                                                bool is_write) {
     CacheAccessReport report;
     report.l1Hit = false;
     report.l2Hit = false;
     report.l2Accessed = false;
+    physical_address &= address_mask;
 
-    // Try L1 first (Probe only)
-    report.l1Hit = accessLevel(l1_cache, physical_address, report, true, false);
+    // Try L1 first (Probe only). On a sectored L1 only the addressed sector must be valid.
+    uint64_t l1_mask = sectorMask(l1, physical_address, 1);
+    report.l1Hit = accessLevel(l1, physical_address, report, true, false, l1_mask, is_write);
     
     if (report.l1Hit) {
         return report; // L1 hit
     }
     
-    // L1 miss, try L2 (Probe only)
+    // L1 miss: the L1 fill unit (one L1 sector) is requested from L2.
+    // When block sizes differ this range may span several L2 blocks (L1 block > L2 block)
+    // or only part of one (L1 block < L2 block); every L2 block touched is one L2 access.
+    size_t sector_bytes = l1.block_size / l1.sectors_per_block;
+    size_t fill_start = physical_address & ~(sector_bytes - 1);
+    size_t fill_end = fill_start + sector_bytes;
+
     report.l2Accessed = true;
-    report.l2Hit = accessLevel(l2_cache, physical_address, report, true, false);
-    
-    if (report.l2Hit) {
-        // Load into L1 (may evict from L1)
-        accessLevel(l1_cache, physical_address, report, false, true);
-        return report; // Overall miss (L1 miss, L2 hit)
+    report.l2Hit = true;
+    size_t l2_block = fill_start & ~(l2_cache.block_size - 1);
+    for (; l2_block < fill_end; l2_block += l2_cache.block_size) {
+        size_t part_start = std::max(l2_block, fill_start);
+        size_t part_end = std::min(l2_block + l2_cache.block_size, fill_end);
+        uint64_t l2_mask = sectorMask(l2_cache, part_start, part_end - part_start);
+
+        // Probe L2; on a miss, data is loaded from Main Memory -> L2
+        if (!accessLevel(l2_cache, part_start, report, true, false, l2_mask, false)) {
+            report.l2Hit = false;
+            accessLevel(l2_cache, part_start, report, false, true, l2_mask, false);
+        }
     }
-    
-    // Both miss - data must be loaded from memory
-    // Load into L2 first, then L1
-    accessLevel(l2_cache, physical_address, report, false, true);
-    accessLevel(l1_cache, physical_address, report, false, true);
+
+    // Load into L1 (may evict from L1)
+    accessLevel(l1, physical_address, report, false, true, l1_mask, is_write);
     
     return report; // Overall miss
 }
 
-bool CacheSimulator::accessLevel(CacheLevel& level, size_t physical_address, CacheAccessReport& report, bool update_stats, bool allocate) {
-    if (update_stats) level.global_time++;
-    
-    size_t tag = extractTag(level, physical_address);
-    size_t set_index = extractSetIndex(level, physical_address);
-    
-    if (set_index >= level.sets.size()) {
-        return false;
+bool CacheSimulator::accessLevel(CacheLevel& level, size_t physical_address, CacheAccessReport& report,
+                                 bool update_stats, bool allocate, uint64_t sector_mask, bool is_write) {
+    if (level.engine) {
+        return accessLevelSpecialized(level, physical_address, report, update_stats, allocate, is_write);
+    }
+
+    if (update_stats) {
+        tick(level);
+        if (level.policy == HAWKEYE) {
+            sampleOptGen(level, physical_address);
+        }
     }
     
-    CacheSet& set = level.sets[set_index];
+    size_t tag = extractTag(level, physical_address);
+    size_t set_index = 0;
+    size_t way = 0;
     
     // Check if block is in cache
-    for (size_t i = 0; i < set.blocks.size(); i++) {
-        if (set.blocks[i].valid && set.blocks[i].tag == tag) {
+    if (findBlock(level, physical_address, set_index, way)) {
+        CacheSet& set = level.sets[set_index];
+        CacheBlock& block = set.blocks[way];
+        if (update_stats && !block.reused) {
+            // First reuse: trains the region as live without waiting for the eviction
+            block.reused = true;
+            if (level.bypass) trainDeadBlock(level, physical_address, true);
+        }
+
+        if ((block.valid_sectors & sector_mask) == sector_mask) {
             // Cache hit
             if (update_stats) {
                 level.hits++;
-                updateReplacementData(level, set, i, level.policy);
-            } else {
-                 // Even on fill (if we call it redundantly) or just silent probe?
-                 // If allocate=true and hit, we just found it.
-                 // If update_stats=false, we probably don't want to mess with replacement unless it's a "use".
-                 // Let's assume updateReplacementData is safe.
+                updateReplacementData(level, set, way, level.policy);
+            }
+            if (is_write) {
+                block.dirty_sectors |= sector_mask;
             }
             return true;
         }
+
+        // Tag present but a requested sector is not: sector miss
+        if (update_stats) {
+            level.misses++;
+            level.sector_misses++;
+        }
+        if (!allocate) {
+            return false;
+        }
+
+        // Fetch only the missing sectors into the existing line
+        uint64_t missing = sector_mask & ~block.valid_sectors;
+        level.fill_bytes += countSectors(missing) * (level.block_size / level.sectors_per_block);
+        block.valid_sectors |= sector_mask;
+        if (is_write) {
+            block.dirty_sectors |= sector_mask;
+        }
+        updateReplacementData(level, set, way, level.policy);
+        return false;
     }
     
     // Cache miss
@@ -114,81 +345,507 @@ bool CacheSimulator::accessLevel(CacheLevel& level, size_t physical_address, Cac
     if (!allocate) {
         return false;
     }
+
+    if (level.bypass && bypassFill(level, physical_address, report)) {
+        // The data still passes through on its way up, so the fill traffic is counted
+        level.fill_bytes += countSectors(sector_mask) * (level.block_size / level.sectors_per_block);
+        return false;
+    }
+    
+    // Find a slot for the new block; evicts (and writes back) if the candidates are full
+    selectVictim(level, physical_address, report, set_index, way);
+    
+    // Load new block
+    // A fill does not advance global_time; it shares the timestamp of the probe that missed.
+    CacheSet& set = level.sets[set_index];
+    CacheBlock& block = set.blocks[way];
+    block.valid = true;
+    block.tag = tag;
+    block.valid_sectors = sector_mask;
+    block.dirty_sectors = is_write ? sector_mask : 0;
+    block.load_time = level.global_time;
+    block.last_access = level.global_time;
+    block.access_count = level.policy == LFU_DA ? set.lfu_age + 1 : 1;
+    block.reused = false;
+    level.fill_bytes += countSectors(sector_mask) * (level.block_size / level.sectors_per_block);
+    
+    // Update replacement data structures
+    // FIFO: findVictimFIFO already rotated the reused slot index to the back of the queue,
+    // so the slot is now the newest. LRU/LFU record the use below.
+    if (level.policy == HAWKEYE) {
+        hawkeyeFill(level, physical_address, set_index, way);
+    } else if (lowPriorityFill(level)) {
+        // LIP: the line enters at the LRU end instead
+        block.last_access = lruEndTime(level, physical_address, set_index, way);
+        set.lruList.remove(way);
+        set.lruList.push_front(way);
+    } else {
+        updateReplacementData(level, set, way, level.policy);
+    }
     
-    // Find a slot for the new block
-    size_t victim_index = set.associativity;
+    return false; // Miss (but loaded)
+}
+
+bool CacheSimulator::accessLevelSpecialized(CacheLevel& level, size_t physical_address, CacheAccessReport& report,
+                                            bool update_stats, bool allocate, bool is_write) {
+    // Same protocol as the generic path, with storage and lookup in the engine
+    if (update_stats) {
+        tick(level);
+    }
+
+    if (level.engine->probe(physical_address, level.global_time, update_stats, is_write)) {
+        if (update_stats) level.hits++;
+        return true;
+    }
+
+    if (update_stats) {
+        level.misses++;
+    }
+    if (!allocate) {
+        return false;
+    }
+
+    LevelEngine::FillResult fill = level.engine->fill(physical_address, level.global_time, is_write,
+                                                      lowPriorityFill(level));
+    level.fill_bytes += level.block_size;
+    if (fill.evicted) {
+        level.evictions++;
+
+        if (event_logging) {
+            std::stringstream ss;
+            ss << level.name << " Eviction: Tag 0x" << std::hex << fill.victim_tag << std::dec
+               << " (Set " << fill.victim_set << ")";
+            if (fill.victim_dirty) {
+                ss << " [dirty, " << level.block_size << "B written back]";
+            }
+            report.events.push_back(ss.str());
+        }
+
+        if (fill.victim_dirty) {
+            writeBack(level, blockAddress(level, fill.victim_tag, fill.victim_set), 1);
+        }
+    }
+    return false;
+}
+
+bool CacheSimulator::findBlock(CacheLevel& level, size_t address, size_t& set_index, size_t& way) {
+    size_t tag = extractTag(level, address);
+
+    if (level.index_function == INDEX_SKEWED) {
+        // Way w of the block can only live in set h_w(address), so a lookup probes
+        // one block per way across different sets.
+        for (size_t w = 0; w < level.associativity; w++) {
+            size_t index = extractSkewedSetIndex(level, address, w);
+            const CacheBlock& block = level.sets[index].blocks[w];
+            if (block.valid && block.tag == tag) {
+                set_index = index;
+                way = w;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    set_index = extractSetIndex(level, address);
+    CacheSet& set = level.sets[set_index];
     for (size_t i = 0; i < set.blocks.size(); i++) {
-        if (!set.blocks[i].valid) {
-            victim_index = i;
-            break;
+        if (set.blocks[i].valid && set.blocks[i].tag == tag) {
+            way = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+void CacheSimulator::selectVictim(CacheLevel& level, size_t address, CacheAccessReport& report,
+                                  size_t& set_index, size_t& way) {
+    std::vector<size_t> set_indices;
+    if (level.index_function == INDEX_SKEWED) {
+        set_indices.resize(level.associativity);
+        for (size_t w = 0; w < level.associativity; w++) {
+            set_indices[w] = extractSkewedSetIndex(level, address, w);
+        }
+    } else {
+        set_indices.assign(level.associativity, extractSetIndex(level, address));
+    }
+
+    // Prefer an invalid way
+    for (size_t w = 0; w < level.associativity; w++) {
+        if (!level.sets[set_indices[w]].blocks[w].valid) {
+            set_index = set_indices[w];
+            way = w;
+            return;
         }
     }
     
     // If cache is full, find victim using replacement policy
-    if (victim_index == set.associativity) {
+    if (level.index_function == INDEX_SKEWED) {
+        way = findVictimSkewed(level, set_indices);
+    } else {
+        CacheSet& set = level.sets[set_indices[0]];
         switch (level.policy) {
             case FIFO:
-                victim_index = findVictimFIFO(set);
+                way = findVictimFIFO(set);
                 break;
             case LRU:
-                victim_index = findVictimLRU(set);
+                way = findVictimLRU(set);
                 break;
             case LFU:
-                victim_index = findVictimLFU(set);
+            case LFU_DA:
+                way = findVictimLFU(set);
+                break;
+            case HAWKEYE:
+                way = findVictimHawkeye(set);
                 break;
         }
-        level.evictions++; // Eviction always happens on allocation if full
-        
-        // Log eviction
+    }
+    set_index = set_indices[way];
+    level.evictions++; // Eviction always happens on allocation if full
+
+    CacheBlock& victim = level.sets[set_index].blocks[way];
+    if (level.policy == LFU_DA) {
+        level.sets[set_index].lfu_age = victim.access_count;
+    }
+    if (level.bypass && !victim.reused) {
+        trainDeadBlock(level, blockAddress(level, victim.tag, set_index), false);
+    }
+    if (level.policy == HAWKEYE && victim.rrpv < HAWKEYE_MAX_RRPV) {
+        // No averse line to take: the predictor was wrong to call this one friendly
+        trainHawkeye(level, victim.signature, false);
+    }
+    size_t dirty_bytes = countSectors(victim.dirty_sectors) * (level.block_size / level.sectors_per_block);
+    
+    // Log eviction
+    if (event_logging) {
         std::stringstream ss;
-        ss << "L" << level.levelNum << " Eviction: Tag 0x" << std::hex << set.blocks[victim_index].tag << std::dec 
-           << " (Set " << set_index << ")";
+        ss << level.name << " Eviction: Tag 0x" << std::hex << victim.tag << std::dec 
+           << " (Set " << set_index;
+        if (level.index_function == INDEX_SKEWED) {
+            ss << ", Way " << way;
+        }
+        ss << ")";
+        if (dirty_bytes > 0) {
+            ss << " [dirty, " << dirty_bytes << "B written back]";
+        }
         report.events.push_back(ss.str());
     }
-    
-    // Load new block
-    set.blocks[victim_index].valid = true;
-    set.blocks[victim_index].tag = tag;
-    // Should we update time if not updating stats? 
-    // Yes, a fill sets the load time.
-    size_t current_time = level.global_time; // If not updated above, uses old time?
-    // If update_stats is false, global_time wasn't incremented.
-    // It's fine, simulated simultaneity.
-    
-    set.blocks[victim_index].load_time = current_time;
-    set.blocks[victim_index].last_access = current_time;
-    set.blocks[victim_index].access_count = 1;
-    
-    // Update replacement data structures
-    // Correctly initialize FIFO queue or LRU list for the new victim
-    // The helper updateReplacementData might expect the block to be in the set?
-    // For FIFO: findVictimFIFO popped the victim. We need to push the new one?
-    // findVictimFIFO: pops front, pushes back. 
-    // Wait, findVictimFIFO pushes the VICTIM back to end? 
-    // "set.fifoQueue.push(victim); // Re-insert at end" -> This rotates the queue.
-    // If we overwrite block[victim], we effectively reused the slot.
-    // The slot ID is effectively "new" now.
-    // Actually, queue stores INDICES.
-    // If we replace block at index X. Index X moves to back of queue?
-    // FIFO: First In (Oldest) is victim.
-    // If we use index X, X is now Newest. So yes, back of queue.
-    // `findVictimFIFO` implementation I saw:
-    // val = front; pop; push(val); return val;
-    // This moves the victim index to the back. Correct for "Reuse slot X as new".
-    
-    updateReplacementData(level, set, victim_index, level.policy);
-    
-    return false; // Miss (but loaded)
+
+    if (victim.dirty_sectors != 0) {
+        writeBack(level, blockAddress(level, victim.tag, set_index), victim.dirty_sectors);
+    }
+    victim.valid = false;
+    victim.valid_sectors = 0;
+    victim.dirty_sectors = 0;
+}
+
+void CacheSimulator::tick(CacheLevel& level) {
+    level.global_time++;
+    if (level.aging_period != 0 && (level.global_time - level.time_base) % level.aging_period == 0) {
+        ageLevel(level);
+    }
+}
+
+void CacheSimulator::ageLevel(CacheLevel& level) {
+    if (level.policy != LFU && level.policy != LFU_DA) {
+        return;
+    }
+    if (level.engine) {
+        level.engine->halveCounts();
+        return;
+    }
+    for (CacheSet& set : level.sets) {
+        set.lfu_age /= 2;
+        for (CacheBlock& block : set.blocks) {
+            block.access_count /= 2;
+        }
+    }
+}
+
+bool CacheSimulator::lowPriorityFill(CacheLevel& level) {
+    if (level.policy != LRU || level.insertion == INSERT_MRU) {
+        return false;
+    }
+    if (level.insertion == INSERT_LIP) {
+        return true;
+    }
+    // BIP: deterministic 1-in-N MRU fills keep runs reproducible
+    return ++level.bip_fills % level.bip_period != 0;
+}
+
+size_t CacheSimulator::lruEndTime(CacheLevel& level, size_t address, size_t set_index, size_t way) {
+    // The victim (if any) was the oldest candidate, so the result never goes
+    // below it; only fills into free ways move the floor down
+    size_t oldest = level.global_time + 1;
+    for (size_t w = 0; w < level.associativity; w++) {
+        size_t index = level.index_function == INDEX_SKEWED ? extractSkewedSetIndex(level, address, w) : set_index;
+        const CacheBlock& other = level.sets[index].blocks[w];
+        if (w != way && other.valid) {
+            oldest = std::min(oldest, other.last_access);
+        }
+    }
+    return oldest > 0 ? oldest - 1 : 0;
+}
+
+size_t CacheSimulator::deadBlockIndex(size_t block_address) const {
+    uint64_t region = block_address >> DEAD_BLOCK_REGION_BITS;
+    return static_cast<size_t>((region * 0x9E3779B97F4A7C15ULL) >> 32) & (DEAD_BLOCK_ENTRIES - 1);
+}
+
+void CacheSimulator::trainDeadBlock(CacheLevel& level, size_t block_address, bool reused) {
+    uint8_t& counter = level.dead_counters[deadBlockIndex(block_address)];
+    if (reused) {
+        if (counter > 0) counter--;
+    } else if (counter < DEAD_BLOCK_MAX) {
+        counter++;
+    }
+}
+
+bool CacheSimulator::bypassFill(CacheLevel& level, size_t address, CacheAccessReport& report) {
+    if (level.dead_counters[deadBlockIndex(address)] < DEAD_BLOCK_MAX) {
+        return false;
+    }
+    if (++level.dead_predictions % DEAD_BLOCK_SAMPLE == 0) {
+        return false; // Sampled: kept so the region's counter sees this line's outcome
+    }
+    level.bypasses++;
+    if (event_logging) {
+        std::stringstream ss;
+        ss << level.name << " Bypass: Tag 0x" << std::hex << extractTag(level, address) << std::dec
+           << " (predicted dead)";
+        report.events.push_back(ss.str());
+    }
+    return true;
+}
+
+void CacheSimulator::initHawkeye(CacheLevel& level) {
+    if (level.hawkeye_counters.empty()) {
+        // Weakly friendly: until trained, fills behave like LRU insertions
+        uint8_t initial = HAWKEYE_FRIENDLY;
+        level.hawkeye_counters.assign(HAWKEYE_ENTRIES, initial);
+        level.optgen_stride = std::max<size_t>(1, level.num_sets / HAWKEYE_SAMPLED_SETS);
+        level.optgen.assign((level.num_sets + level.optgen_stride - 1) / level.optgen_stride, OptGenSet());
+        for (OptGenSet& sampled : level.optgen) {
+            sampled.time = 0;
+            sampled.occupancy.assign(HAWKEYE_HISTORY * level.associativity, 0);
+        }
+    }
+    for (CacheSet& set : level.sets) {
+        for (CacheBlock& block : set.blocks) {
+            block.rrpv = HAWKEYE_MAX_RRPV;
+            block.signature = 0;
+        }
+    }
+}
+
+uint16_t CacheSimulator::hawkeyeSignature() const {
+    uint64_t key = current_pc << 1 | (current_fetch ? 1 : 0);
+    return static_cast<uint16_t>(((key * 0x9E3779B97F4A7C15ULL) >> 32) & (HAWKEYE_ENTRIES - 1));
+}
+
+bool CacheSimulator::hawkeyeFriendly(const CacheLevel& level, uint16_t signature) const {
+    return level.hawkeye_counters[signature] >= HAWKEYE_FRIENDLY;
+}
+
+void CacheSimulator::trainHawkeye(CacheLevel& level, uint16_t signature, bool opt_hit) {
+    uint8_t& counter = level.hawkeye_counters[signature];
+    if (opt_hit) {
+        if (counter < HAWKEYE_COUNTER_MAX) counter++;
+    } else if (counter > 0) {
+        counter--;
+    }
+}
+
+void CacheSimulator::sampleOptGen(CacheLevel& level, size_t address) {
+    // Skewed levels have no set per line; the unskewed index still groups
+    // lines into sampled sets of the level's associativity
+    size_t set_index = extractSetIndex(level, address);
+    if (set_index % level.optgen_stride != 0) {
+        return;
+    }
+    OptGenSet& sampled = level.optgen[set_index / level.optgen_stride];
+    size_t window = sampled.occupancy.size();
+    size_t now = sampled.time++;
+    sampled.occupancy[now % window] = 0;
+    uint16_t signature = hawkeyeSignature();
+
+    size_t line = address >> level.block_offset_bits;
+    auto it = sampled.lastUse.find(line);
+    if (it != sampled.lastUse.end()) {
+        const OptGenSet::Use& last = it->second;
+        // OPT keeps the line from its last use to now iff the set never fills up in between
+        bool opt_hit = now - last.time < window;
+        for (size_t t = last.time; opt_hit && t < now; t++) {
+            opt_hit = sampled.occupancy[t % window] < level.associativity;
+        }
+        if (opt_hit) {
+            for (size_t t = last.time; t < now; t++) {
+                sampled.occupancy[t % window]++;
+            }
+            level.opt_hits++;
+        } else {
+            level.opt_misses++;
+        }
+        trainHawkeye(level, last.signature, opt_hit);
+    }
+    sampled.lastUse[line] = OptGenSet::Use{now, signature};
+
+    // Lines not reused within the window are OPT misses: train them and drop them
+    if (sampled.lastUse.size() > 2 * window) {
+        for (auto use = sampled.lastUse.begin(); use != sampled.lastUse.end();) {
+            if (now - use->second.time >= window) {
+                level.opt_misses++;
+                trainHawkeye(level, use->second.signature, false);
+                use = sampled.lastUse.erase(use);
+            } else {
+                ++use;
+            }
+        }
+    }
+}
+
+void CacheSimulator::hawkeyeFill(CacheLevel& level, size_t address, size_t set_index, size_t way) {
+    CacheBlock& block = level.sets[set_index].blocks[way];
+    block.signature = hawkeyeSignature();
+    if (!hawkeyeFriendly(level, block.signature)) {
+        block.rrpv = HAWKEYE_MAX_RRPV;
+        level.averse_fills++;
+        return;
+    }
+    block.rrpv = 0;
+    level.friendly_fills++;
+
+    // Friendly lines age below HAWKEYE_MAX_RRPV so they stay behind every averse line
+    for (size_t w = 0; w < level.associativity; w++) {
+        size_t index = level.index_function == INDEX_SKEWED ? extractSkewedSetIndex(level, address, w) : set_index;
+        CacheBlock& other = level.sets[index].blocks[w];
+        if (w != way && other.valid && other.rrpv < HAWKEYE_MAX_RRPV - 1) {
+            other.rrpv++;
+        }
+    }
+}
+
+void CacheSimulator::writeBack(CacheLevel& level, size_t block_address, uint64_t dirty_sectors) {
+    size_t sector_bytes = level.block_size / level.sectors_per_block;
+    level.writeback_bytes += countSectors(dirty_sectors) * sector_bytes;
+
+    if (&level == &l2_cache) {
+        memory_write_bytes += countSectors(dirty_sectors) * sector_bytes;
+        return;
+    }
+
+    // L1 victim: each dirty sector is merged into L2 if the line is resident there.
+    // L2 does not allocate on write-back; bytes it cannot absorb go to memory.
+    for (size_t s = 0; s < level.sectors_per_block; s++) {
+        if ((dirty_sectors & (1ULL << s)) == 0) continue;
+
+        size_t start = block_address + s * sector_bytes;
+        size_t end = start + sector_bytes;
+        size_t l2_block = start & ~(l2_cache.block_size - 1);
+        for (; l2_block < end; l2_block += l2_cache.block_size) {
+            size_t part_start = std::max(l2_block, start);
+            size_t part_end = std::min(l2_block + l2_cache.block_size, end);
+            uint64_t l2_mask = sectorMask(l2_cache, part_start, part_end - part_start);
+
+            size_t set_index = 0;
+            size_t way = 0;
+            bool absorbed = false;
+            if (l2_cache.engine) {
+                // Specialized levels are unsectored: the whole block is valid when resident
+                absorbed = l2_cache.engine->markDirty(part_start);
+            } else if (findBlock(l2_cache, part_start, set_index, way)) {
+                CacheBlock& block = l2_cache.sets[set_index].blocks[way];
+                // A partially written L2 sector can only be merged if the rest of it is present
+                size_t l2_sector_bytes = l2_cache.block_size / l2_cache.sectors_per_block;
+                bool covers = (part_end - part_start) >= l2_sector_bytes;
+                if (covers || (block.valid_sectors & l2_mask) == l2_mask) {
+                    block.valid_sectors |= l2_mask;
+                    block.dirty_sectors |= l2_mask;
+                    absorbed = true;
+                }
+            }
+            if (!absorbed) {
+                memory_write_bytes += part_end - part_start;
+            }
+        }
+    }
+}
+
+uint64_t CacheSimulator::sectorMask(const CacheLevel& level, size_t address, size_t bytes) const {
+    // Sectors of the block containing `address` that overlap [address, address + bytes)
+    size_t sector_bytes = level.block_size / level.sectors_per_block;
+    size_t offset = address & (level.block_size - 1);
+    size_t first = offset / sector_bytes;
+    size_t last = (std::min(offset + bytes, level.block_size) - 1) / sector_bytes;
+
+    uint64_t mask = 0;
+    for (size_t s = first; s <= last; s++) {
+        mask |= 1ULL << s;
+    }
+    return mask;
+}
+
+size_t CacheSimulator::countSectors(uint64_t mask) {
+    size_t count = 0;
+    while (mask != 0) {
+        mask &= mask - 1;
+        count++;
+    }
+    return count;
+}
+
+size_t CacheSimulator::blockAddress(const CacheLevel& level, size_t tag, size_t set_index) const {
+    if (level.index_function != INDEX_MODULO) {
+        return tag << level.block_offset_bits; // Hashed: tag is the whole block address
+    }
+    return (tag * level.num_sets + set_index) << level.block_offset_bits;
 }
 
 size_t CacheSimulator::extractTag(CacheLevel& level, size_t address) const {
-    size_t mask = (1ULL << level.tag_bits) - 1;
-    return (address >> (level.set_index_bits + level.block_offset_bits)) & mask;
+    size_t block_address = address >> level.block_offset_bits;
+    if (level.index_function != INDEX_MODULO) {
+        // Hashed indices cannot be inverted, so the whole block address is the tag
+        return block_address;
+    }
+    if (level.pow2_sets) {
+        return block_address >> level.set_index_bits;
+    }
+    return block_address / level.num_sets;
 }
 
 size_t CacheSimulator::extractSetIndex(CacheLevel& level, size_t address) const {
-    size_t mask = (1ULL << level.set_index_bits) - 1;
-    return (address >> level.block_offset_bits) & mask;
+    size_t block_address = address >> level.block_offset_bits;
+    if (level.num_sets == 1) {
+        return 0;
+    }
+
+    if (level.index_function == INDEX_XOR) {
+        // Fold every set_index_bits-wide chunk of the block address together
+        size_t chunk_mask = (static_cast<size_t>(1) << level.set_index_bits) - 1;
+        size_t folded = 0;
+        while (block_address != 0) {
+            folded ^= block_address & chunk_mask;
+            block_address >>= level.set_index_bits;
+        }
+        block_address = folded;
+    }
+
+    if (level.pow2_sets) {
+        return block_address & (level.num_sets - 1);
+    }
+    return block_address % level.num_sets;
+}
+
+size_t CacheSimulator::extractSkewedSetIndex(CacheLevel& level, size_t address, size_t way) const {
+    // A distinct multiplicative hash per way (Seznec-style skewing): blocks that
+    // conflict in one way are scattered across different sets in the others.
+    uint64_t block_address = address >> level.block_offset_bits;
+    uint64_t h = block_address ^ (block_address >> 17);
+    h *= 0x9E3779B97F4A7C15ULL + 2 * way;
+    h ^= h >> 29;
+    if (level.pow2_sets) {
+        return h & (level.num_sets - 1);
+    }
+    return h % level.num_sets;
 }
 
 size_t CacheSimulator::extractBlockOffset(CacheLevel& level, size_t address) const {
@@ -231,13 +888,14 @@ size_t CacheSimulator::findVictimLRU(CacheSet& set) {
 }
 
 size_t CacheSimulator::findVictimLFU(CacheSet& set) {
-    // Find block with lowest access count
+    // Find block with lowest access count; among equal counts, the least recently used
     size_t victim = 0;
-    size_t min_count = set.blocks[0].access_count;
     
     for (size_t i = 1; i < set.blocks.size(); i++) {
-        if (set.blocks[i].access_count < min_count) {
-            min_count = set.blocks[i].access_count;
+        const CacheBlock& block = set.blocks[i];
+        const CacheBlock& current = set.blocks[victim];
+        if (block.access_count < current.access_count ||
+            (block.access_count == current.access_count && block.last_access < current.last_access)) {
             victim = i;
         }
     }
@@ -245,6 +903,49 @@ size_t CacheSimulator::findVictimLFU(CacheSet& set) {
     return victim;
 }
 
+size_t CacheSimulator::findVictimHawkeye(CacheSet& set) {
+    // Highest RRPV: any averse line, else the oldest friendly one; ties go to the lowest way
+    size_t victim = 0;
+    for (size_t i = 1; i < set.blocks.size(); i++) {
+        if (set.blocks[i].rrpv > set.blocks[victim].rrpv) {
+            victim = i;
+        }
+    }
+    return victim;
+}
+
+size_t CacheSimulator::findVictimSkewed(CacheLevel& level, const std::vector<size_t>& set_indices) {
+    // Candidates live in different sets, so the per-set FIFO queue / LRU list
+    // cannot rank them; use the per-block timestamps and counters instead.
+    size_t victim = 0;
+    for (size_t way = 1; way < set_indices.size(); way++) {
+        const CacheBlock& candidate = level.sets[set_indices[way]].blocks[way];
+        const CacheBlock& current = level.sets[set_indices[victim]].blocks[victim];
+        bool better = false;
+        switch (level.policy) {
+            case FIFO:
+                better = candidate.load_time < current.load_time;
+                break;
+            case LRU:
+                better = candidate.last_access < current.last_access;
+                break;
+            case LFU:
+            case LFU_DA:
+                better = candidate.access_count < current.access_count ||
+                         (candidate.access_count == current.access_count &&
+                          candidate.last_access < current.last_access);
+                break;
+            case HAWKEYE:
+                better = candidate.rrpv > current.rrpv;
+                break;
+        }
+        if (better) {
+            victim = way;
+        }
+    }
+    return victim;
+}
+
 void CacheSimulator::updateReplacementData(CacheLevel& level, CacheSet& set, 
                                           size_t block_index, ReplacementPolicy policy) {
     switch (policy) {
@@ -258,53 +959,75 @@ void CacheSimulator::updateReplacementData(CacheLevel& level, CacheSet& set,
             set.blocks[block_index].last_access = level.global_time;
             break;
         case LFU:
-            // Increment access count
+        case LFU_DA:
+            // Increment access count; the time breaks ties between equal counts
             set.blocks[block_index].access_count++;
+            set.blocks[block_index].last_access = level.global_time;
             break;
+        case HAWKEYE: {
+            // A hit re-predicts the line from the PC that touched it now
+            CacheBlock& block = set.blocks[block_index];
+            block.signature = hawkeyeSignature();
+            block.rrpv = hawkeyeFriendly(level, block.signature) ? 0 : HAWKEYE_MAX_RRPV;
+            break;
+        }
     }
 }
 
 void CacheSimulator::setReplacementPolicy(ReplacementPolicy policy) {
     defaultPolicy = policy;
-    l1_cache.policy = policy;
-    l2_cache.policy = policy;
+    setReplacementPolicy(1, policy);
+    setReplacementPolicy(2, policy);
+    if (split_l1) {
+        setReplacementPolicy(L1I_LEVEL, policy);
+    }
 }
 
 void CacheSimulator::setReplacementPolicy(size_t level, ReplacementPolicy policy) {
-    if (level == 1) {
-        l1_cache.policy = policy;
-    } else if (level == 2) {
-        l2_cache.policy = policy;
+    CacheLevel* target = findLevel(level);
+    if (target == nullptr || target->policy == policy) {
+        return;
+    }
+
+    // The engine is specialized on the policy: move the blocks back to the
+    // generic representation and re-dispatch with the new policy
+    unbindEngine(*target);
+    target->policy = policy;
+    bindEngine(*target);
+    if (policy == HAWKEYE) {
+        initHawkeye(*target);
     }
 }
 
 size_t CacheSimulator::getHits(size_t level) const {
-    if (level == 1) return l1_cache.hits;
-    if (level == 2) return l2_cache.hits;
-    return 0;
+    const CacheLevel* target = findLevel(level);
+    return target != nullptr ? target->hits : 0;
 }
 
 size_t CacheSimulator::getMisses(size_t level) const {
-    if (level == 1) return l1_cache.misses;
-    if (level == 2) return l2_cache.misses;
-    return 0;
+    const CacheLevel* target = findLevel(level);
+    return target != nullptr ? target->misses : 0;
+}
+
+size_t CacheSimulator::getFillBytes(size_t level) const {
+    const CacheLevel* target = findLevel(level);
+    return target != nullptr ? target->fill_bytes : 0;
+}
+
+size_t CacheSimulator::getWritebackBytes(size_t level) const {
+    const CacheLevel* target = findLevel(level);
+    return target != nullptr ? target->writeback_bytes : 0;
 }
 
 double CacheSimulator::getHitRatio(size_t level) const {
-    size_t hits, misses;
-    if (level == 1) {
-        hits = l1_cache.hits;
-        misses = l1_cache.misses;
-    } else if (level == 2) {
-        hits = l2_cache.hits;
-        misses = l2_cache.misses;
-    } else {
+    const CacheLevel* target = findLevel(level);
+    if (target == nullptr) {
         return 0.0;
     }
     
-    size_t total = hits + misses;
+    size_t total = target->hits + target->misses;
     if (total == 0) return 0.0;
-    return (static_cast<double>(hits) / total) * 100.0;
+    return (static_cast<double>(target->hits) / total) * 100.0;
 }
 
 void CacheSimulator::printStatistics() const {
@@ -328,13 +1051,24 @@ void CacheSimulator::printStatistics() const {
 
     double amat = L1_LATENCY + l1_mr * (L2_LATENCY + l2_mr * MEM_LATENCY);
 
-    std::cout << "L1 Cache:\n";
+    std::cout << l1_cache.name << " Cache:\n";
     std::cout << "  Hits: " << l1_cache.hits << "\n";
     std::cout << "  Misses: " << l1_cache.misses << "\n";
     std::cout << "  Evictions: " << l1_cache.evictions << "\n";
     std::cout << "  Hit Ratio: " << std::fixed << std::setprecision(2) 
               << getHitRatio(1) << "%\n";
     std::cout << "  Miss Traffic (to L2): " << l1_cache.misses << " requests\n";
+    printSectorStatistics(l1_cache);
+    if (split_l1) {
+        std::cout << "L1I Cache:\n";
+        std::cout << "  Hits: " << l1i_cache.hits << "\n";
+        std::cout << "  Misses: " << l1i_cache.misses << "\n";
+        std::cout << "  Evictions: " << l1i_cache.evictions << "\n";
+        std::cout << "  Hit Ratio: " << std::fixed << std::setprecision(2)
+                  << getHitRatio(L1I_LEVEL) << "%\n";
+        std::cout << "  Miss Traffic (to L2): " << l1i_cache.misses << " requests\n";
+        printSectorStatistics(l1i_cache);
+    }
     
     std::cout << "L2 Cache:\n";
     std::cout << "  Hits: " << l2_cache.hits << "\n";
@@ -343,11 +1077,154 @@ void CacheSimulator::printStatistics() const {
     std::cout << "  Hit Ratio: " << std::fixed << std::setprecision(2) 
               << getHitRatio(2) << "%\n";
     std::cout << "  Miss Traffic (to Memory): " << l2_cache.misses << " requests\n";
+    printSectorStatistics(l2_cache);
+    
+    std::cout << "Memory Traffic:\n";
+    std::cout << "  Read: " << getMemoryReadBytes() << " bytes\n";
+    std::cout << "  Write-back: " << memory_write_bytes << " bytes\n";
     
     std::cout << "System Performance:\n";
     std::cout << "  Estimated AMAT: " << amat << " cycles\n";
     std::cout << "  (Assumptions: L1=" << (int)L1_LATENCY << ", L2=" << (int)L2_LATENCY 
               << ", Mem=" << (int)MEM_LATENCY << ")\n";
+    if (comparison.accesses > 0) {
+        printPolicyComparison();
+    }
     
     std::cout << "======================\n\n";
 }
+
+void CacheSimulator::printPolicyComparison() const {
+    auto ratio = [](size_t accesses, size_t misses) {
+        return accesses == 0 ? 0.0 : 100.0 * (accesses - misses) / accesses;
+    };
+    PolicyComparison::Policy current = l1_cache.policy == FIFO ? PolicyComparison::FIFO
+                                     : l1_cache.policy == LRU ? PolicyComparison::LRU
+                                     : PolicyComparison::LFU;
+    bool currentListed = l1_cache.policy != LFU_DA && l1_cache.policy != HAWKEYE;
+
+    std::cout << "Replacement Policies (offline, last compared trace: " << comparison.accesses << " accesses):\n";
+    std::cout << "  Policy  " << (split_l1 ? "L1D Hit   L1I Hit   " : "L1 Hit    ") << "L2 Hit    Memory Reads\n";
+    size_t bestOnline = 0;
+    for (size_t p = 0; p < PolicyComparison::POLICY_COUNT; p++) {
+        PolicyComparison::Policy policy = static_cast<PolicyComparison::Policy>(p);
+        size_t l2Accesses = comparison.l1Misses[p] + comparison.l1iMisses[p];
+        std::cout << "  " << std::left << std::setw(6) << PolicyComparison::policyName(policy)
+                  << (currentListed && policy == current ? "* " : "  ") << std::right << std::fixed
+                  << std::setprecision(2) << std::setw(6) << ratio(comparison.l1Accesses, comparison.l1Misses[p])
+                  << "%   ";
+        if (split_l1) {
+            std::cout << std::setw(6) << ratio(comparison.l1iAccesses, comparison.l1iMisses[p]) << "%   ";
+        }
+        std::cout << std::setw(6) << ratio(l2Accesses, comparison.l2Misses[p]) << "%   "
+                  << comparison.l2Misses[p] << "\n";
+        if (policy != PolicyComparison::OPT && comparison.l2Misses[p] < comparison.l2Misses[bestOnline]) {
+            bestOnline = p;
+        }
+    }
+
+    // Nothing online does better than OPT at either level, so this is headroom
+    const size_t opt = PolicyComparison::OPT;
+    size_t onlineL1 = comparison.l1Misses[bestOnline] + comparison.l1iMisses[bestOnline];
+    size_t optL1 = comparison.l1Misses[opt] + comparison.l1iMisses[opt];
+    std::cout << "  OPT headroom over " << PolicyComparison::policyName(static_cast<PolicyComparison::Policy>(bestOnline))
+              << ": " << onlineL1 - std::min(onlineL1, optL1) << " L1 misses, "
+              << comparison.l2Misses[bestOnline] - std::min(comparison.l2Misses[bestOnline], comparison.l2Misses[opt])
+              << " memory reads\n";
+}
+
+std::vector<bool> CacheSimulator::compareLevel(CacheLevel& level, PolicyComparison::Policy policy,
+                                               const std::vector<uint64_t>& addresses) {
+    std::vector<PolicyComparison::Reference> refs(addresses.size());
+    for (size_t i = 0; i < addresses.size(); i++) {
+        refs[i].line = addresses[i] >> level.block_offset_bits;
+        refs[i].set = static_cast<uint32_t>(extractSetIndex(level, addresses[i]));
+    }
+    return PolicyComparison::simulate(policy, level.num_sets, level.associativity, refs);
+}
+
+bool CacheSimulator::comparePolicies(const std::vector<uint64_t>& addresses, const std::vector<bool>& fetches,
+                                     std::string& error) {
+    if (l1_cache.index_function == INDEX_SKEWED || l2_cache.index_function == INDEX_SKEWED) {
+        error = "skewed-associative levels have no fixed set per line";
+        return false;
+    }
+
+    // Split the stream between the L1s, remembering where each reference came from
+    std::vector<uint64_t> data, code;
+    std::vector<size_t> dataAt, codeAt;
+    for (size_t i = 0; i < addresses.size(); i++) {
+        uint64_t address = addresses[i] & address_mask;
+        if (split_l1 && fetches[i]) {
+            code.push_back(address);
+            codeAt.push_back(i);
+        } else {
+            data.push_back(address);
+            dataAt.push_back(i);
+        }
+    }
+
+    PolicyComparisonResult result = PolicyComparisonResult();
+    result.accesses = addresses.size();
+    result.l1Accesses = data.size();
+    result.l1iAccesses = code.size();
+    for (size_t p = 0; p < PolicyComparison::POLICY_COUNT; p++) {
+        PolicyComparison::Policy policy = static_cast<PolicyComparison::Policy>(p);
+        std::vector<bool> l1Missed(addresses.size(), false);
+        std::vector<bool> missed = compareLevel(l1_cache, policy, data);
+        for (size_t j = 0; j < missed.size(); j++) {
+            if (!missed[j]) continue;
+            l1Missed[dataAt[j]] = true;
+            result.l1Misses[p]++;
+        }
+        if (split_l1) {
+            missed = compareLevel(l1i_cache, policy, code);
+            for (size_t j = 0; j < missed.size(); j++) {
+                if (!missed[j]) continue;
+                l1Missed[codeAt[j]] = true;
+                result.l1iMisses[p]++;
+            }
+        }
+
+        // L2 sees this policy's L1 misses, in trace order
+        std::vector<uint64_t> l2Stream;
+        l2Stream.reserve(result.l1Misses[p] + result.l1iMisses[p]);
+        for (size_t i = 0; i < addresses.size(); i++) {
+            if (l1Missed[i]) l2Stream.push_back(addresses[i] & address_mask);
+        }
+        missed = compareLevel(l2_cache, policy, l2Stream);
+        for (bool miss : missed) {
+            if (miss) result.l2Misses[p]++;
+        }
+    }
+    comparison = result;
+    return true;
+}
+
+void CacheSimulator::printSectorStatistics(const CacheLevel& level) const {
+    std::cout << "  Fill Traffic: " << level.fill_bytes << " bytes\n";
+    std::cout << "  Write-back Traffic: " << level.writeback_bytes << " bytes\n";
+    if (level.sectors_per_block > 1) {
+        std::cout << "  Sectors: " << level.sectors_per_block << " x "
+                  << level.block_size / level.sectors_per_block << "B"
+                  << " (sector misses: " << level.sector_misses << ")\n";
+    }
+    if (level.policy == LRU && level.insertion != INSERT_MRU) {
+        std::cout << "  Insertion: " << (level.insertion == INSERT_LIP ? "LIP" : "BIP");
+        if (level.insertion == INSERT_BIP) {
+            std::cout << " (1/" << level.bip_period << " at MRU)";
+        }
+        std::cout << "\n";
+    }
+    if (level.bypass) {
+        std::cout << "  Dead-block bypass: " << level.bypasses << " fills bypassed ("
+                  << level.dead_predictions << " predicted dead)\n";
+    }
+    if (level.policy == HAWKEYE) {
+        size_t sampled = level.opt_hits + level.opt_misses;
+        std::cout << "  Hawkeye: " << level.friendly_fills << " friendly / " << level.averse_fills
+                  << " averse fills; OPTgen on " << level.optgen.size() << " sampled sets: "
+                  << std::fixed << std::setprecision(2)
+                  << (sampled == 0 ? 0.0 : 100.0 * level.opt_hits / sampled) << "% OPT hits\n";
+    }
+}
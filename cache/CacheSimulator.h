@@ -2,23 +2,80 @@
 #define CACHE_SIMULATOR_H
 
 #include <cstddef>
+#include <cstdint>
 #include <vector>
 #include <map>
 #include <list>
 #include <queue>
 #include <string>
+#include <memory>
+#include <unordered_map>
+#include "PolicyComparison.h"
 
 class CacheSimulator {
 public:
     enum ReplacementPolicy {
         FIFO,
         LRU,
-        LFU
+        LFU,        // Fewest accesses; ties go to the least recently used
+        LFU_DA,     // LFU with dynamic aging: new blocks start from the count of the set's last victim
+        HAWKEYE     // Learned: a PC-indexed predictor trained on OPT's decisions ranks fills (see below)
     };
 
+    // How an address selects its set
+    enum IndexFunction {
+        INDEX_MODULO,   // block_address % num_sets (bit-select when num_sets is a power of two)
+        INDEX_XOR,      // all block-address bits XOR-folded into the index, as in LLC slice hashes
+        INDEX_SKEWED    // skewed-associative: every way uses its own hash of the block address
+    };
+
+    // Where an LRU level places a newly filled line (other policies always fill as usual)
+    enum InsertionPolicy {
+        INSERT_MRU,     // Most recently used end: classic LRU
+        INSERT_LIP,     // LRU end: a line is only kept if it is hit before the next fill evicts it
+        INSERT_BIP      // Bimodal: LIP, except every bipPeriod-th fill goes to the MRU end
+    };
+
+    // Storage behind a level (see bindEngine)
+    enum LevelEngineKind {
+        ENGINE_GENERIC,             // Runtime per-set vectors
+        ENGINE_SPECIALIZED,         // CacheLevelT<Sets, Ways, LineBytes, Policy>
+        ENGINE_COMPACT,             // CompactLevel: bit-packed tag store for large levels
+        ENGINE_FULLY_ASSOCIATIVE    // FullyAssociativeLevel: hashed tag lookup, one set
+    };
+
+    // Optional configuration beyond size/block/associativity
+    struct Options {
+        IndexFunction indexFunction;  // Both levels
+        size_t l1Sectors;             // Sectors per L1 block (1 = unsectored)
+        size_t l2Sectors;             // Sectors per L2 block
+        bool specialize;              // Use a compile-time specialized level when one matches
+        bool compact;                 // Compact tag store for every eligible level, not only large ones
+        size_t addressBits;           // Physical address width; higher address bits are ignored
+        size_t lfuAgingPeriod;        // LFU/LFU_DA: halve every count each N accesses of a level (0 = never)
+        InsertionPolicy l1Insertion;  // LRU insertion position of L1 fills
+        InsertionPolicy l2Insertion;  // LRU insertion position of L2 fills
+        size_t bipPeriod;             // INSERT_BIP: one fill in this many goes to the MRU end
+        bool l2Bypass;                // Dead-block predictor: L2 does not keep fills predicted never reused
+        size_t l1iSize;               // Split L1: instruction cache size (0 = unified L1)
+        size_t l1iBlockSize;
+        size_t l1iAssociativity;
+
+        Options()
+            : indexFunction(INDEX_MODULO), l1Sectors(1), l2Sectors(1), specialize(true), compact(false),
+              addressBits(64), lfuAgingPeriod(0), l1Insertion(INSERT_MRU), l2Insertion(INSERT_MRU),
+              bipPeriod(32), l2Bypass(false), l1iSize(0), l1iBlockSize(0), l1iAssociativity(0) {}
+    };
+
+    // Level number of a split L1's instruction cache in the per-level calls;
+    // 1 is the (data) L1 and 2 the unified L2
+    static const size_t L1I_LEVEL = 3;
+
+    // Throws std::invalid_argument if a level's geometry is inconsistent
     CacheSimulator(size_t l1_size, size_t l1_block_size, size_t l1_associativity,
                    size_t l2_size, size_t l2_block_size, size_t l2_associativity,
-                   ReplacementPolicy policy = FIFO);
+                   ReplacementPolicy policy = FIFO, const Options& options = Options());
+    ~CacheSimulator();
 
     struct CacheAccessReport {
         bool l1Hit;
@@ -27,28 +84,109 @@ public:
         std::vector<std::string> events; // "Evicted L1 Tag X", "Filled L2", etc.
     };
 
-    CacheAccessReport access(size_t physical_address);
+    // `pc` is the address of the instruction making the reference (0 if unknown);
+    // only HAWKEYE levels use it
+    CacheAccessReport access(size_t physical_address, bool is_write = false, uint64_t pc = 0);
+    // Instruction fetch: through the L1I when the L1 is split, else the same as a load.
+    // The report's l1Hit then refers to the L1I. The fetch is its own PC.
+    CacheAccessReport fetch(size_t physical_address);
+    bool hasSplitL1() const { return split_l1; }
     void setReplacementPolicy(ReplacementPolicy policy);
     void setReplacementPolicy(size_t level, ReplacementPolicy policy);
+    // When disabled, access() leaves CacheAccessReport::events empty (bulk replay)
+    void setEventLogging(bool enabled) { event_logging = enabled; }
     
     // Statistics
     size_t getHits(size_t level) const;
     size_t getMisses(size_t level) const;
     double getHitRatio(size_t level) const;
+    size_t getFillBytes(size_t level) const;       // Bytes brought into the level from below
+    size_t getWritebackBytes(size_t level) const;  // Dirty bytes written out on eviction
+    size_t getMemoryReadBytes() const { return l2_cache.fill_bytes; }
+    size_t getMemoryWriteBytes() const { return memory_write_bytes; }
+    bool isSpecialized(size_t level) const;
+    bool isCompact(size_t level) const;
+    LevelEngineKind getEngineKind(size_t level) const;
+    size_t getTagStoreBytes(size_t level) const;   // Host memory of the level's block state
+    size_t getBypasses(size_t level) const;        // Fills the dead-block predictor did not keep
     void printStatistics() const;
 
+    // Offline policy comparison on a recorded trace: the references are run
+    // through this hierarchy's geometry (sets, ways, line size, index
+    // function) under FIFO, LRU, LFU and Belady's OPT, each policy on both
+    // levels; L2 sees the L1 misses of the same policy. Lines are whole
+    // blocks, writes count as reads and every miss fills, so the numbers are
+    // comparable with each other rather than with the live counters.
+    // printStatistics() reports the last comparison. Fails for skewed levels.
+    struct PolicyComparisonResult {
+        size_t accesses;             // 0 until a comparison has run
+        size_t l1Accesses;           // Data (or unified) L1
+        size_t l1iAccesses;          // Split L1 only
+        size_t l1Misses[PolicyComparison::POLICY_COUNT];
+        size_t l1iMisses[PolicyComparison::POLICY_COUNT];
+        size_t l2Misses[PolicyComparison::POLICY_COUNT];
+    };
+    bool comparePolicies(const std::vector<uint64_t>& addresses, const std::vector<bool>& fetches,
+                         std::string& error);
+    const PolicyComparisonResult& getPolicyComparison() const { return comparison; }
+
 private:
+    // Specialized level engines (CacheLevelT.h)
+    class LevelEngine;
+    template <size_t Sets, size_t Ways, size_t LineBytes, ReplacementPolicy Policy>
+    class CacheLevelT;
+    template <size_t TagBits, ReplacementPolicy Policy>
+    class CompactLevel;
+    template <ReplacementPolicy Policy>
+    class FullyAssociativeLevel;
+
+    // Levels with at least this many lines use the compact tag store when no
+    // CacheLevelT specialization matches
+    static const size_t COMPACT_MIN_LINES = 1 << 16;
+
+    // Dead-block predictor: 2-bit counters indexed by a hash of the 4 KB
+    // region a line belongs to. Lines evicted without a hit count a region up,
+    // reused lines count it down; a saturated region's fills are bypassed,
+    // except one in DEAD_BLOCK_SAMPLE, which is kept so the region can retrain.
+    static const size_t DEAD_BLOCK_ENTRIES = 1 << 14;
+    static const size_t DEAD_BLOCK_REGION_BITS = 12;
+    static const uint8_t DEAD_BLOCK_MAX = 3;
+    static const size_t DEAD_BLOCK_SAMPLE = 32;
+
+    // Hawkeye (Jain & Lin, ISCA 2016): OPTgen replays the references of a few
+    // sampled sets and decides, as each line is reused, whether Belady's OPT
+    // would have kept it over the interval since its last use - true exactly
+    // when every point of that interval had fewer than `ways` lines OPT keeps.
+    // The answer trains a 3-bit counter indexed by a hash of the PC that made
+    // the previous access. Fills whose PC counts at least HAWKEYE_FRIENDLY are
+    // cache-friendly: they enter at RRPV 0 and age the other friendly lines;
+    // the rest are cache-averse and enter at HAWKEYE_MAX_RRPV, first in line
+    // for eviction. Evicting a friendly line detrains its PC. OPTgen keeps
+    // HAWKEYE_HISTORY x ways accesses of history per sampled set.
+    static const size_t HAWKEYE_ENTRIES = 1 << 11;
+    static const uint8_t HAWKEYE_COUNTER_MAX = 7;
+    static const uint8_t HAWKEYE_FRIENDLY = 4;
+    static const uint8_t HAWKEYE_MAX_RRPV = 7;
+    static const size_t HAWKEYE_SAMPLED_SETS = 64;
+    static const size_t HAWKEYE_HISTORY = 8;
+
     struct CacheBlock {
         bool valid;
         size_t tag;
+        uint64_t valid_sectors;  // Bit s set: sector s holds data
+        uint64_t dirty_sectors;  // Bit s set: sector s was written since fill
         size_t load_time;      // For FIFO
-        size_t last_access;     // For LRU
-        size_t access_count;    // For LFU
+        size_t last_access;     // For LRU, and LFU ties
+        size_t access_count;    // For LFU (LFU_DA: starts from the set's lfu_age)
+        bool reused;            // Hit since fill (dead-block predictor training)
+        uint8_t rrpv;           // HAWKEYE: re-reference prediction, HAWKEYE_MAX_RRPV = evict first
+        uint16_t signature;     // HAWKEYE: predictor entry of the PC that last touched the line
     };
 
     struct CacheSet {
         std::vector<CacheBlock> blocks;
         size_t associativity;
+        size_t lfu_age;     // LFU_DA: access_count of the last victim (L)
         
         // FIFO: queue of block indices in order of insertion
         std::queue<size_t> fifoQueue;
@@ -57,6 +195,17 @@ private:
         std::list<size_t> lruList;
     };
 
+    // OPTgen state of one sampled set
+    struct OptGenSet {
+        struct Use {
+            size_t time;            // Set-local access number
+            uint16_t signature;
+        };
+        size_t time;                        // Accesses to the set so far
+        std::vector<size_t> occupancy;      // Lines OPT holds at each of the last window accesses
+        std::unordered_map<size_t, Use> lastUse;    // Block address -> its previous access
+    };
+
     struct CacheLevel {
         size_t size;
         size_t block_size;
@@ -65,38 +214,147 @@ private:
         size_t set_index_bits;
         size_t block_offset_bits;
         size_t tag_bits;
+        size_t sectors_per_block;  // Fill/valid/dirty granularity is block_size / sectors_per_block
+        bool pow2_sets;         // num_sets is a power of two: index/tag are bit fields
+        IndexFunction index_function;
         ReplacementPolicy policy;
         int levelNum; // 1 or 2
+        std::string name;  // "L1", "L1D", "L1I" or "L2": event and error prefix
         
         std::vector<CacheSet> sets;
         
         size_t hits;
         size_t misses;
         size_t evictions;
+        size_t sector_misses;   // Misses where the tag matched but the sector was invalid
+        size_t fill_bytes;
+        size_t writeback_bytes;
         
         size_t global_time;  // For tracking access order
+        size_t time_base;    // Initial global_time: LIP timestamps count down below it
+        size_t aging_period; // Options::lfuAgingPeriod
+
+        InsertionPolicy insertion;  // Only applies while the policy is LRU
+        size_t bip_period;
+        size_t bip_fills;           // BIP: fills since the level started
+        bool bypass;                // Dead-block bypass (generic path only)
+        std::vector<uint8_t> dead_counters;
+        size_t bypasses;
+        size_t dead_predictions;    // Fills predicted dead, bypassed or sampled
+
+        // HAWKEYE (generic path only); allocated when the level first uses the policy
+        std::vector<uint8_t> hawkeye_counters;
+        std::vector<OptGenSet> optgen;
+        size_t optgen_stride;       // Every optgen_stride-th set is sampled
+        size_t friendly_fills;
+        size_t averse_fills;
+        size_t opt_hits;            // Sampled reuses OPT would hit
+        size_t opt_misses;          // ... and miss (including lines that left the window unused)
+        
+        // Specialized, compact or fully-associative storage; when set, `sets`
+        // is empty and the engine owns the blocks. Hit/miss/traffic counters stay here.
+        bool specialize;
+        bool compact_allowed;   // Options::compact: ignore COMPACT_MIN_LINES
+        LevelEngineKind engine_kind;
+        std::unique_ptr<LevelEngine> engine;
     };
 
-    CacheLevel l1_cache;
+    CacheLevel l1_cache;    // Data L1 when split_l1
+    CacheLevel l1i_cache;   // Only initialized when split_l1
     CacheLevel l2_cache;
+    bool split_l1;
     ReplacementPolicy defaultPolicy;
+    size_t memory_write_bytes;  // Write-backs that reached main memory
+    size_t address_mask;        // Options::addressBits low bits set
+    bool event_logging;
+    uint64_t current_pc;        // PC of the reference being simulated
+    bool current_fetch;         // ... and whether it is a fetch
+    PolicyComparisonResult comparison;
 
-    void initCacheLevel(CacheLevel& level, int levelNum, size_t size, size_t block_size, 
-                       size_t associativity, ReplacementPolicy policy);
+    void initCacheLevel(CacheLevel& level, int levelNum, const std::string& name, size_t size, size_t block_size, 
+                       size_t associativity, size_t sectors, InsertionPolicy insertion, bool bypass,
+                       ReplacementPolicy policy, const Options& options);
     
+    const CacheLevel* findLevel(size_t level) const;
+    CacheLevel* findLevel(size_t level);
+
+    // One reference through `l1` (the data or instruction L1) and the shared L2
+    CacheAccessReport accessThrough(CacheLevel& l1, size_t physical_address, bool is_write);
+
     // update_stats: count hits/misses
     // allocate: fill cache on miss
-    bool accessLevel(CacheLevel& level, size_t physical_address, CacheAccessReport& report, bool update_stats = true, bool allocate = true);
+    // sector_mask: sectors of the block that must be valid for a hit (and are filled on a miss)
+    // is_write: mark the sectors dirty
+    bool accessLevel(CacheLevel& level, size_t physical_address, CacheAccessReport& report,
+                     bool update_stats, bool allocate, uint64_t sector_mask, bool is_write);
+    bool findBlock(CacheLevel& level, size_t address, size_t& set_index, size_t& way);
+    void selectVictim(CacheLevel& level, size_t address, CacheAccessReport& report,
+                      size_t& set_index, size_t& way);
+    void writeBack(CacheLevel& level, size_t block_address, uint64_t dirty_sectors);
+    // Advances the level's clock by one access, ageing LFU counts when due
+    void tick(CacheLevel& level);
+    // LFU aging: halves the level's counts (and LFU_DA ages)
+    void ageLevel(CacheLevel& level);
+
+    // Insertion control: true if this fill goes to the LRU end (consumes a BIP fill)
+    bool lowPriorityFill(CacheLevel& level);
+    // Timestamp just below every other valid candidate of `way` (LIP position)
+    size_t lruEndTime(CacheLevel& level, size_t address, size_t set_index, size_t way);
+    size_t deadBlockIndex(size_t block_address) const;
+    void trainDeadBlock(CacheLevel& level, size_t block_address, bool reused);
+    // True if the fill of `address` is not kept (counts and logs the bypass)
+    bool bypassFill(CacheLevel& level, size_t address, CacheAccessReport& report);
+
+    // Hawkeye: allocates the predictor and OPTgen state, and marks resident
+    // lines averse (they were placed by another policy)
+    void initHawkeye(CacheLevel& level);
+    // Predictor entry of the current reference; a unified L1 sees an
+    // instruction's fetches and its data references apart
+    uint16_t hawkeyeSignature() const;
+    bool hawkeyeFriendly(const CacheLevel& level, uint16_t signature) const;
+    void trainHawkeye(CacheLevel& level, uint16_t signature, bool opt_hit);
+    // Runs OPTgen on a demand access if its set is sampled
+    void sampleOptGen(CacheLevel& level, size_t address);
+    // Sets up a filled line and, if it is friendly, ages the other candidates
+    void hawkeyeFill(CacheLevel& level, size_t address, size_t set_index, size_t way);
+    
+    // Sector helpers
+    uint64_t sectorMask(const CacheLevel& level, size_t address, size_t bytes) const;
+    static size_t countSectors(uint64_t mask);
+    size_t blockAddress(const CacheLevel& level, size_t tag, size_t set_index) const;
     
     // Address calculation
     size_t extractTag(CacheLevel& level, size_t address) const;
     size_t extractSetIndex(CacheLevel& level, size_t address) const;
     size_t extractBlockOffset(CacheLevel& level, size_t address) const;
+    size_t extractSkewedSetIndex(CacheLevel& level, size_t address, size_t way) const;
     
     // Replacement policies
     size_t findVictimFIFO(CacheSet& set);
     size_t findVictimLRU(CacheSet& set);
     size_t findVictimLFU(CacheSet& set);
+    size_t findVictimHawkeye(CacheSet& set);
+    size_t findVictimSkewed(CacheLevel& level, const std::vector<size_t>& set_indices);
+    
+    void printSectorStatistics(const CacheLevel& level) const;
+    void printPolicyComparison() const;
+    // Misses of `level` under `policy` on the given references (addresses),
+    // indexed like `addresses`
+    std::vector<bool> compareLevel(CacheLevel& level, PolicyComparison::Policy policy,
+                                   const std::vector<uint64_t>& addresses);
+    
+    // Engine binding: picks a CacheLevelT specialization for the level's
+    // geometry and policy, moving the block state between representations
+    void bindEngine(CacheLevel& level);
+    void unbindEngine(CacheLevel& level);
+    bool accessLevelSpecialized(CacheLevel& level, size_t physical_address, CacheAccessReport& report,
+                                bool update_stats, bool allocate, bool is_write);
+    static std::unique_ptr<LevelEngine> makeSpecializedLevel(size_t sets, size_t ways, size_t line_bytes,
+                                                             ReplacementPolicy policy);
+    static std::unique_ptr<LevelEngine> makeFullyAssociativeLevel(size_t ways, size_t line_bytes,
+                                                                  ReplacementPolicy policy);
+    static std::unique_ptr<LevelEngine> makeCompactLevel(size_t sets, size_t ways, size_t line_bytes,
+                                                         size_t tag_bits, ReplacementPolicy policy);
     
     void updateReplacementData(CacheLevel& level, CacheSet& set, size_t block_index, ReplacementPolicy policy);
 };
@@ -0,0 +1,301 @@
+#ifndef COMPACT_TAG_STORE_H
+#define COMPACT_TAG_STORE_H
+
+#include "CacheLevelT.h"
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+
+// Tag store for large levels whose geometry has no CacheLevelT
+// specialization (e.g. a 64 MB LLC). All sets live in one allocation of
+// fixed-stride records of 64-bit words:
+//
+//   [valid mask] [dirty mask] [LFU-DA age] [ranks ...] [counts ...] [tags ...]
+//
+// Tags keep only the TagBits the address width leaves above the index and
+// offset, packed 64 / TagBits per word. Every policy keeps a ceil(log2 ways)
+// bit rank per way (0 = newest / most recent): FIFO ranks by fill, LRU and
+// the LFU policies by last touch. LFU and LFU-DA add a 32-bit saturating
+// count per way, with the rank breaking ties; the age word is only there
+// for them. A lookup touches one record.
+//
+// Decisions match the generic path: the lowest invalid way is filled first
+// and LFU ties go to the least recently used way. Only the bound policy's
+// state is kept, so after a policy change the new policy starts from that
+// order.
+template <size_t TagBits, CacheSimulator::ReplacementPolicy Policy>
+class CacheSimulator::CompactLevel : public CacheSimulator::LevelEngine {
+    static_assert(TagBits == 16 || TagBits == 32 || TagBits == 64, "TagBits must be 16, 32 or 64");
+
+    static constexpr bool FREQUENCY = Policy == CacheSimulator::LFU || Policy == CacheSimulator::LFU_DA;
+    static constexpr size_t TAGS_PER_WORD = 64 / TagBits;
+    static constexpr uint64_t TAG_MASK = TagBits == 64 ? ~uint64_t(0) : (uint64_t(1) << TagBits) - 1;
+    static constexpr size_t COUNT_BITS = 32;
+    static constexpr uint64_t COUNT_MAX = 0xFFFFFFFFULL;
+
+    size_t numSets;
+    size_t ways;
+    size_t offsetBits;
+    size_t indexBits;
+    uint64_t waysMask;
+    size_t rankBits;
+    size_t ranksPerWord;
+    size_t rankBase;        // Word offsets inside a record
+    size_t countBase;
+    size_t tagBase;
+    size_t stride;          // Words per set record
+    std::vector<uint64_t> records;
+
+    static constexpr size_t AGE = 2;
+
+    static size_t log2(size_t value) {
+        size_t bits = 0;
+        while ((static_cast<size_t>(1) << bits) < value) bits++;
+        return bits;
+    }
+
+    uint64_t* record(size_t set) { return &records[set * stride]; }
+    const uint64_t* record(size_t set) const { return &records[set * stride]; }
+
+    size_t setOf(size_t address) const { return (address >> offsetBits) & (numSets - 1); }
+    size_t tagOf(size_t address) const { return address >> (offsetBits + indexBits); }
+
+    // Field `way` of `bits`-wide fields packed 64 / bits per word from rec[base]
+    static uint64_t field(const uint64_t* rec, size_t base, size_t bits, size_t way) {
+        size_t per_word = 64 / bits;
+        uint64_t mask = bits == 64 ? ~uint64_t(0) : (uint64_t(1) << bits) - 1;
+        return (rec[base + way / per_word] >> ((way % per_word) * bits)) & mask;
+    }
+    static void setField(uint64_t* rec, size_t base, size_t bits, size_t way, uint64_t value) {
+        size_t per_word = 64 / bits;
+        uint64_t mask = bits == 64 ? ~uint64_t(0) : (uint64_t(1) << bits) - 1;
+        uint64_t& word = rec[base + way / per_word];
+        size_t shift = (way % per_word) * bits;
+        word = (word & ~(mask << shift)) | ((value & mask) << shift);
+    }
+
+    uint64_t tagAt(const uint64_t* rec, size_t way) const { return field(rec, tagBase, TagBits, way); }
+    void setTag(uint64_t* rec, size_t way, uint64_t tag) const { setField(rec, tagBase, TagBits, way, tag); }
+    uint64_t rankAt(const uint64_t* rec, size_t way) const { return field(rec, rankBase, rankBits, way); }
+    void setRank(uint64_t* rec, size_t way, uint64_t rank) const { setField(rec, rankBase, rankBits, way, rank); }
+    uint64_t countAt(const uint64_t* rec, size_t way) const { return field(rec, countBase, COUNT_BITS, way); }
+    void setCount(uint64_t* rec, size_t way, uint64_t count) const {
+        setField(rec, countBase, COUNT_BITS, way, std::min(count, COUNT_MAX));
+    }
+
+    bool lookup(const uint64_t* rec, size_t address, size_t& way) const {
+        uint64_t valid = rec[0];
+        uint64_t tag = tagOf(address);
+        while (valid != 0) {
+            size_t w = static_cast<size_t>(__builtin_ctzll(valid));
+            if (tagAt(rec, w) == tag) {
+                way = w;
+                return true;
+            }
+            valid &= valid - 1;
+        }
+        return false;
+    }
+
+    // Makes `way` rank 0, ageing the valid ways that were ranked above it.
+    // A way being filled passes the number of valid ways as its old rank.
+    void promote(uint64_t* rec, size_t way, uint64_t old_rank) const {
+        uint64_t others = rec[0] & ~(uint64_t(1) << way);
+        while (others != 0) {
+            size_t w = static_cast<size_t>(__builtin_ctzll(others));
+            uint64_t rank = rankAt(rec, w);
+            if (rank < old_rank) setRank(rec, w, rank + 1);
+            others &= others - 1;
+        }
+        setRank(rec, way, 0);
+    }
+
+    size_t victimWay(const uint64_t* rec) const {
+        size_t victim = 0;
+        if constexpr (FREQUENCY) {
+            for (size_t w = 1; w < ways; w++) {
+                uint64_t count = countAt(rec, w);
+                uint64_t best = countAt(rec, victim);
+                if (count < best || (count == best && rankAt(rec, w) > rankAt(rec, victim))) victim = w;
+            }
+        } else {
+            for (size_t w = 0; w < ways; w++) {
+                if (rankAt(rec, w) == ways - 1) return w;
+            }
+        }
+        return victim;
+    }
+
+public:
+    CompactLevel(size_t sets, size_t ways_per_set, size_t line_bytes)
+        : numSets(sets), ways(ways_per_set), offsetBits(log2(line_bytes)), indexBits(log2(sets)) {
+        waysMask = ways == 64 ? ~uint64_t(0) : (uint64_t(1) << ways) - 1;
+        rankBits = std::max<size_t>(1, log2(ways));
+        ranksPerWord = 64 / rankBits;
+        rankBase = FREQUENCY ? 3 : 2;
+        countBase = rankBase + (ways + ranksPerWord - 1) / ranksPerWord;
+        tagBase = countBase + (FREQUENCY ? (ways * COUNT_BITS + 63) / 64 : 0);
+        stride = tagBase + (ways + TAGS_PER_WORD - 1) / TAGS_PER_WORD;
+        records.assign(numSets * stride, 0);
+    }
+
+    bool probe(size_t address, size_t now, bool update_stats, bool is_write) override {
+        (void)now;
+        uint64_t* rec = record(setOf(address));
+        size_t way = 0;
+        if (!lookup(rec, address, way)) {
+            return false;
+        }
+        if (update_stats && Policy != CacheSimulator::FIFO) {
+            promote(rec, way, rankAt(rec, way));
+            if constexpr (FREQUENCY) {
+                setCount(rec, way, countAt(rec, way) + 1);
+            }
+        }
+        if (is_write) {
+            rec[1] |= uint64_t(1) << way;
+        }
+        return true;
+    }
+
+    FillResult fill(size_t address, size_t now, bool is_write, bool lru_end) override {
+        (void)now;
+        size_t set_index = setOf(address);
+        uint64_t* rec = record(set_index);
+
+        FillResult result = {false, 0, set_index, false};
+        uint64_t invalid = ~rec[0] & waysMask;
+        size_t way;
+        uint64_t old_rank;
+        if (invalid != 0) {
+            way = static_cast<size_t>(__builtin_ctzll(invalid));
+            old_rank = static_cast<uint64_t>(__builtin_popcountll(rec[0]));
+        } else {
+            way = victimWay(rec);
+            old_rank = rankAt(rec, way);
+            result.evicted = true;
+            result.victim_tag = tagAt(rec, way);
+            result.victim_dirty = (rec[1] >> way) & 1;
+            if constexpr (Policy == CacheSimulator::LFU_DA) {
+                rec[AGE] = countAt(rec, way);
+            }
+        }
+
+        uint64_t bit = uint64_t(1) << way;
+        rec[0] |= bit;
+        rec[1] = is_write ? (rec[1] | bit) : (rec[1] & ~bit);
+        setTag(rec, way, tagOf(address));
+        if (Policy == CacheSimulator::LRU && lru_end) {
+            setRank(rec, way, old_rank); // Below every other valid way: the victim's rank, or the first free one
+        } else {
+            promote(rec, way, old_rank);
+        }
+        if constexpr (FREQUENCY) {
+            // Installed with a count of 1 (LFU-DA: age + 1), plus the install touch
+            setCount(rec, way, (Policy == CacheSimulator::LFU_DA ? rec[AGE] : 0) + 2);
+        }
+        return result;
+    }
+
+    bool markDirty(size_t address) override {
+        uint64_t* rec = record(setOf(address));
+        size_t way = 0;
+        if (!lookup(rec, address, way)) {
+            return false;
+        }
+        rec[1] |= uint64_t(1) << way;
+        return true;
+    }
+
+    void halveCounts() override {
+        if constexpr (FREQUENCY) {
+            for (size_t s = 0; s < numSets; s++) {
+                uint64_t* rec = record(s);
+                rec[AGE] /= 2;
+                for (size_t w = 0; w < ways; w++) setCount(rec, w, countAt(rec, w) / 2);
+            }
+        }
+    }
+
+    size_t storageBytes() const override { return records.size() * sizeof(uint64_t); }
+
+    void exportTo(CacheLevel& level) const override {
+        level.sets.assign(numSets, CacheSet());
+        for (size_t s = 0; s < numSets; s++) {
+            const uint64_t* rec = record(s);
+            CacheSet& set = level.sets[s];
+            set.associativity = ways;
+            set.lfu_age = FREQUENCY ? rec[AGE] : 0;
+            set.blocks.resize(ways);
+            for (size_t w = 0; w < ways; w++) {
+                CacheBlock& block = set.blocks[w];
+                bool valid = (rec[0] >> w) & 1;
+                uint64_t rank = valid ? rankAt(rec, w) : 0;
+                // Ranks become timestamps just below the current time
+                size_t time = valid && level.global_time > rank ? level.global_time - 1 - rank : 0;
+                block.valid = valid;
+                block.tag = valid ? tagAt(rec, w) : 0;
+                block.valid_sectors = valid ? 1 : 0;
+                block.dirty_sectors = valid ? (rec[1] >> w) & 1 : 0;
+                block.load_time = time;
+                block.last_access = time;
+                block.access_count = !valid ? 0 : FREQUENCY ? countAt(rec, w) : 1;
+            }
+
+            if ((rec[0] & waysMask) == waysMask) {
+                std::vector<size_t> order(ways);
+                for (size_t w = 0; w < ways; w++) order[w] = w;
+                std::stable_sort(order.begin(), order.end(), [&set](size_t a, size_t b) {
+                    return set.blocks[a].load_time < set.blocks[b].load_time;
+                });
+                for (size_t w : order) {
+                    set.fifoQueue.push(w);
+                    set.lruList.push_back(w);
+                }
+            }
+        }
+    }
+
+    void importFrom(const CacheLevel& level) override {
+        std::fill(records.begin(), records.end(), 0);
+        for (size_t s = 0; s < numSets && s < level.sets.size(); s++) {
+            const CacheSet& set = level.sets[s];
+            uint64_t* rec = record(s);
+            size_t count = std::min(ways, set.blocks.size());
+            if constexpr (FREQUENCY) {
+                rec[AGE] = std::min<uint64_t>(set.lfu_age, COUNT_MAX);
+            }
+
+            // Oldest first (lowest timestamp, then lowest way) gets the highest rank
+            auto key = [&set](size_t w) {
+                return Policy == CacheSimulator::FIFO ? set.blocks[w].load_time : set.blocks[w].last_access;
+            };
+            size_t valid_count = 0;
+            for (size_t w = 0; w < count; w++) {
+                if (set.blocks[w].valid) valid_count++;
+            }
+
+            for (size_t w = 0; w < count; w++) {
+                const CacheBlock& block = set.blocks[w];
+                if (!block.valid) continue;
+                rec[0] |= uint64_t(1) << w;
+                if (block.dirty_sectors != 0) rec[1] |= uint64_t(1) << w;
+                setTag(rec, w, block.tag);
+                if constexpr (FREQUENCY) {
+                    setCount(rec, w, block.access_count);
+                }
+
+                size_t older = 0;
+                for (size_t v = 0; v < count; v++) {
+                    if (v != w && set.blocks[v].valid &&
+                        (key(v) < key(w) || (key(v) == key(w) && v < w))) {
+                        older++;
+                    }
+                }
+                setRank(rec, w, valid_count - 1 - older);
+            }
+        }
+    }
+};
+
+#endif // COMPACT_TAG_STORE_H
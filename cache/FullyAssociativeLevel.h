@@ -0,0 +1,273 @@
+#ifndef FULLY_ASSOCIATIVE_LEVEL_H
+#define FULLY_ASSOCIATIVE_LEVEL_H
+
+#include "CacheLevelT.h"
+#include "LfuBuckets.h"
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+#include <utility>
+#include <algorithm>
+
+// Fully-associative level (one set, any number of ways): TLB-like
+// structures, victim buffers and idealized caches. A hash map from tag to
+// slot replaces the scan over every way, and the replacement order is kept
+// incrementally instead of being searched on each eviction:
+//
+//   FIFO   - slots in load order (an intrusive list, only appended on fill)
+//   LRU    - intrusive recency list, a hit moves the slot to the front
+//   LFU(-DA) - frequency buckets (LfuBuckets), O(1) per hit and eviction
+//
+// Decisions match the generic path: slots are filled lowest first, and
+// LFU ties go to the least recently used slot. All three timestamps/counters
+// are kept, so a policy change carries the same state as the generic blocks.
+template <CacheSimulator::ReplacementPolicy Policy>
+class CacheSimulator::FullyAssociativeLevel : public CacheSimulator::LevelEngine {
+    static constexpr uint32_t NONE = 0xFFFFFFFFu;
+
+    size_t ways;
+    size_t offsetBits;
+
+    std::unordered_map<size_t, uint32_t> slotOf;  // Tag -> slot of every valid line
+    std::vector<size_t> tags;
+    std::vector<size_t> loadTime;
+    std::vector<size_t> lastAccess;
+    std::vector<size_t> accessCount;
+    std::vector<char> valid;
+    std::vector<char> dirty;
+    size_t firstInvalid;  // Slots below are valid
+
+    // FIFO/LRU order: head is the newest / most recently used slot
+    std::vector<uint32_t> prev;
+    std::vector<uint32_t> next;
+    uint32_t head;
+    uint32_t tail;
+
+    static constexpr bool FREQUENCY = Policy == CacheSimulator::LFU || Policy == CacheSimulator::LFU_DA;
+    LfuBuckets byCount;   // LFU order
+    size_t lfuAge;        // LFU-DA: count of the last victim
+
+    size_t tagOf(size_t address) const { return address >> offsetBits; }
+
+    void unlink(uint32_t slot) {
+        if (prev[slot] != NONE) next[prev[slot]] = next[slot]; else head = next[slot];
+        if (next[slot] != NONE) prev[next[slot]] = prev[slot]; else tail = prev[slot];
+        prev[slot] = next[slot] = NONE;
+    }
+
+    void pushFront(uint32_t slot) {
+        prev[slot] = NONE;
+        next[slot] = head;
+        if (head != NONE) prev[head] = slot; else tail = slot;
+        head = slot;
+    }
+
+    void reset() {
+        slotOf.clear();
+        std::fill(tags.begin(), tags.end(), 0);
+        std::fill(loadTime.begin(), loadTime.end(), 0);
+        std::fill(lastAccess.begin(), lastAccess.end(), 0);
+        std::fill(accessCount.begin(), accessCount.end(), 0);
+        std::fill(valid.begin(), valid.end(), 0);
+        std::fill(dirty.begin(), dirty.end(), 0);
+        std::fill(prev.begin(), prev.end(), NONE);
+        std::fill(next.begin(), next.end(), NONE);
+        head = tail = NONE;
+        byCount.reset(ways);
+        lfuAge = 0;
+        firstInvalid = 0;
+    }
+
+    // Builds the policy order of the valid slots from their timestamps/counters
+    void rebuildOrder() {
+        std::vector<uint32_t> order;
+        for (size_t s = 0; s < ways; s++) {
+            if (valid[s]) order.push_back(static_cast<uint32_t>(s));
+        }
+        if constexpr (FREQUENCY) {
+            // Ascending count, and inside a count the least recently used first
+            std::stable_sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) {
+                return accessCount[a] != accessCount[b] ? accessCount[a] < accessCount[b]
+                                                        : lastAccess[a] < lastAccess[b];
+            });
+            for (uint32_t s : order) byCount.insertHighest(s, accessCount[s]);
+        } else {
+            // Oldest first (lowest timestamp, then lowest slot) ends up at the tail
+            const std::vector<size_t>& key = Policy == CacheSimulator::FIFO ? loadTime : lastAccess;
+            std::stable_sort(order.begin(), order.end(),
+                             [&key](uint32_t a, uint32_t b) { return key[a] < key[b]; });
+            for (uint32_t s : order) pushFront(s);
+        }
+    }
+
+    void touch(uint32_t slot, size_t now) {
+        if constexpr (Policy == CacheSimulator::LRU) {
+            lastAccess[slot] = now;
+            if (head != slot) {
+                unlink(slot);
+                pushFront(slot);
+            }
+        } else if constexpr (FREQUENCY) {
+            lastAccess[slot] = now;
+            accessCount[slot]++;
+            byCount.increment(slot);
+        } else {
+            (void)slot;
+            (void)now;
+        }
+    }
+
+public:
+    FullyAssociativeLevel(size_t ways_per_set, size_t line_bytes)
+        : ways(ways_per_set), offsetBits(0), tags(ways_per_set), loadTime(ways_per_set),
+          lastAccess(ways_per_set), accessCount(ways_per_set), valid(ways_per_set), dirty(ways_per_set),
+          firstInvalid(0), prev(ways_per_set), next(ways_per_set), head(NONE), tail(NONE) {
+        while ((static_cast<size_t>(1) << offsetBits) < line_bytes) offsetBits++;
+        slotOf.reserve(ways);
+        reset();
+    }
+
+    bool probe(size_t address, size_t now, bool update_stats, bool is_write) override {
+        auto it = slotOf.find(tagOf(address));
+        if (it == slotOf.end()) {
+            return false;
+        }
+        if (update_stats) {
+            touch(it->second, now);
+        }
+        if (is_write) {
+            dirty[it->second] = 1;
+        }
+        return true;
+    }
+
+    FillResult fill(size_t address, size_t now, bool is_write, bool lru_end) override {
+        FillResult result = {false, 0, 0, false};
+        uint32_t slot;
+        if (firstInvalid < ways) {
+            slot = static_cast<uint32_t>(firstInvalid);
+        } else {
+            if constexpr (FREQUENCY) {
+                slot = byCount.victim();
+                byCount.remove(slot);
+                if (Policy == CacheSimulator::LFU_DA) lfuAge = accessCount[slot];
+            } else {
+                slot = tail;
+                unlink(slot);
+            }
+            result.evicted = true;
+            result.victim_tag = tags[slot];
+            result.victim_dirty = dirty[slot] != 0;
+            slotOf.erase(tags[slot]);
+        }
+
+        size_t tag = tagOf(address);
+        valid[slot] = 1;
+        while (firstInvalid < ways && valid[firstInvalid]) firstInvalid++;
+        dirty[slot] = is_write ? 1 : 0;
+        tags[slot] = tag;
+        slotOf[tag] = slot;
+        loadTime[slot] = now;
+        lastAccess[slot] = now;
+        accessCount[slot] = Policy == CacheSimulator::LFU_DA ? lfuAge + 1 : 1;
+        if constexpr (FREQUENCY) {
+            // Count 1 plus the install touch, entered directly
+            accessCount[slot]++;
+            lastAccess[slot] = now;
+            byCount.insert(slot, accessCount[slot]);
+        } else if (Policy == CacheSimulator::LRU && lru_end) {
+            // Tail of the recency list, stamped just below the oldest other slot
+            size_t oldest = tail != NONE ? lastAccess[tail] : now + 1;
+            lastAccess[slot] = oldest > 0 ? oldest - 1 : 0;
+            prev[slot] = tail;
+            next[slot] = NONE;
+            if (tail != NONE) next[tail] = slot; else head = slot;
+            tail = slot;
+        } else {
+            pushFront(slot);
+            touch(slot, now); // Same as the generic updateReplacementData on install
+        }
+        return result;
+    }
+
+    bool markDirty(size_t address) override {
+        auto it = slotOf.find(tagOf(address));
+        if (it == slotOf.end()) {
+            return false;
+        }
+        dirty[it->second] = 1;
+        return true;
+    }
+
+    void halveCounts() override {
+        if constexpr (FREQUENCY) {
+            lfuAge /= 2;
+            byCount.reset(ways);
+            for (size_t s = 0; s < ways; s++) accessCount[s] /= 2;
+            rebuildOrder();
+        }
+    }
+
+    size_t storageBytes() const override {
+        // Slot arrays, the LFU buckets, plus the hash map's buckets and nodes
+        size_t per_slot = 4 * sizeof(size_t) + 2 + 2 * sizeof(uint32_t);
+        size_t lfu_bytes = FREQUENCY ? ways * (2 * sizeof(uint64_t) + 7 * sizeof(uint32_t)) : 0;
+        size_t map_bytes = slotOf.bucket_count() * sizeof(void*) +
+                           slotOf.size() * (sizeof(void*) + sizeof(std::pair<size_t, uint32_t>) + sizeof(size_t));
+        return ways * per_slot + lfu_bytes + map_bytes;
+    }
+
+    void exportTo(CacheLevel& level) const override {
+        level.sets.assign(1, CacheSet());
+        CacheSet& set = level.sets[0];
+        set.associativity = ways;
+        set.lfu_age = lfuAge;
+        set.blocks.resize(ways);
+        for (size_t s = 0; s < ways; s++) {
+            CacheBlock& block = set.blocks[s];
+            block.valid = valid[s] != 0;
+            block.tag = tags[s];
+            block.valid_sectors = valid[s] ? 1 : 0;
+            block.dirty_sectors = dirty[s] ? 1 : 0;
+            block.load_time = loadTime[s];
+            block.last_access = lastAccess[s];
+            block.access_count = accessCount[s];
+        }
+
+        // Rebuild the FIFO queue / LRU list in timestamp order once the set is full
+        if (firstInvalid < ways) {
+            return;
+        }
+        std::vector<size_t> order(ways);
+        for (size_t s = 0; s < ways; s++) order[s] = s;
+        std::stable_sort(order.begin(), order.end(),
+                         [this](size_t a, size_t b) { return loadTime[a] < loadTime[b]; });
+        for (size_t s : order) set.fifoQueue.push(s);
+        std::stable_sort(order.begin(), order.end(),
+                         [this](size_t a, size_t b) { return lastAccess[a] < lastAccess[b]; });
+        for (size_t s : order) set.lruList.push_back(s);
+    }
+
+    void importFrom(const CacheLevel& level) override {
+        reset();
+        if (!level.sets.empty()) {
+            const CacheSet& set = level.sets[0];
+            lfuAge = set.lfu_age;
+            for (size_t s = 0; s < ways && s < set.blocks.size(); s++) {
+                const CacheBlock& block = set.blocks[s];
+                if (!block.valid) continue;
+                valid[s] = 1;
+                dirty[s] = block.dirty_sectors != 0;
+                tags[s] = block.tag;
+                loadTime[s] = block.load_time;
+                lastAccess[s] = block.last_access;
+                accessCount[s] = block.access_count;
+                slotOf[block.tag] = static_cast<uint32_t>(s);
+            }
+        }
+        while (firstInvalid < ways && valid[firstInvalid]) firstInvalid++;
+        rebuildOrder();
+    }
+};
+
+#endif // FULLY_ASSOCIATIVE_LEVEL_H
@@ -0,0 +1,132 @@
+#ifndef LFU_BUCKETS_H
+#define LFU_BUCKETS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Frequency-bucket list for O(1) LFU: one bucket per distinct key, kept in
+// ascending key order, and inside each bucket the slots in the order they
+// entered it. The victim is the first slot of the lowest bucket, i.e. the
+// least recently touched of the least frequently used slots.
+//
+// A hit moves a slot to the adjacent bucket (key + 1). An insert walks up
+// from the lowest bucket; new keys sit at most a couple of buckets above
+// it (2 for LFU, L + 2 for LFU-DA), so that walk is constant too.
+class LfuBuckets {
+public:
+    static constexpr uint32_t NONE = 0xFFFFFFFFu;
+
+    explicit LfuBuckets(size_t slots = 0) { reset(slots); }
+
+    void reset(size_t slots) {
+        buckets.assign(slots, Bucket());
+        freeBuckets.clear();
+        for (size_t b = slots; b > 0; b--) freeBuckets.push_back(static_cast<uint32_t>(b - 1));
+        slotBucket.assign(slots, NONE);
+        slotPrev.assign(slots, NONE);
+        slotNext.assign(slots, NONE);
+        keys.assign(slots, 0);
+        lowest = highest = NONE;
+    }
+
+    bool empty() const { return lowest == NONE; }
+    uint64_t key(uint32_t slot) const { return keys[slot]; }
+    uint32_t victim() const { return lowest == NONE ? NONE : buckets[lowest].head; }
+
+    // Adds `slot` as the newest entry of bucket `key`
+    void insert(uint32_t slot, uint64_t key) {
+        uint32_t before = NONE;
+        uint32_t b = lowest;
+        while (b != NONE && buckets[b].key < key) {
+            before = b;
+            b = buckets[b].next;
+        }
+        if (b == NONE || buckets[b].key != key) {
+            b = newBucket(key, before);
+        }
+        append(b, slot);
+    }
+
+    // Adds `slot` with a key no lower than any present, in O(1)
+    void insertHighest(uint32_t slot, uint64_t key) {
+        uint32_t b = highest;
+        if (b == NONE || buckets[b].key != key) {
+            b = newBucket(key, highest);
+        }
+        append(b, slot);
+    }
+
+    void increment(uint32_t slot) {
+        uint32_t b = slotBucket[slot];
+        uint64_t key = keys[slot] + 1;
+        uint32_t next = buckets[b].next;
+        if (next != NONE && buckets[next].key == key) {
+            detach(slot);
+            append(next, slot);
+        } else if (buckets[b].head == slot && buckets[b].tail == slot) {
+            buckets[b].key = key; // Sole member: the bucket itself moves up
+            keys[slot] = key;
+        } else {
+            detach(slot);
+            append(newBucket(key, b), slot);
+        }
+    }
+
+    void remove(uint32_t slot) { detach(slot); }
+
+private:
+    struct Bucket {
+        uint64_t key;
+        uint32_t head, tail;   // Slots, oldest entry first
+        uint32_t prev, next;   // Neighbouring buckets
+        Bucket() : key(0), head(NONE), tail(NONE), prev(NONE), next(NONE) {}
+    };
+
+    std::vector<Bucket> buckets;   // Pool: at most one bucket per slot
+    std::vector<uint32_t> freeBuckets;
+    std::vector<uint32_t> slotBucket;
+    std::vector<uint32_t> slotPrev, slotNext;
+    std::vector<uint64_t> keys;
+    uint32_t lowest, highest;
+
+    // Links a new empty bucket after `before` (at the bottom if NONE)
+    uint32_t newBucket(uint64_t key, uint32_t before) {
+        uint32_t b = freeBuckets.back();
+        freeBuckets.pop_back();
+        Bucket& bucket = buckets[b];
+        bucket = Bucket();
+        bucket.key = key;
+        bucket.prev = before;
+        bucket.next = before == NONE ? lowest : buckets[before].next;
+        if (bucket.next != NONE) buckets[bucket.next].prev = b; else highest = b;
+        if (before != NONE) buckets[before].next = b; else lowest = b;
+        return b;
+    }
+
+    void append(uint32_t b, uint32_t slot) {
+        Bucket& bucket = buckets[b];
+        slotBucket[slot] = b;
+        keys[slot] = bucket.key;
+        slotPrev[slot] = bucket.tail;
+        slotNext[slot] = NONE;
+        if (bucket.tail != NONE) slotNext[bucket.tail] = slot; else bucket.head = slot;
+        bucket.tail = slot;
+    }
+
+    void detach(uint32_t slot) {
+        uint32_t b = slotBucket[slot];
+        Bucket& bucket = buckets[b];
+        if (slotPrev[slot] != NONE) slotNext[slotPrev[slot]] = slotNext[slot]; else bucket.head = slotNext[slot];
+        if (slotNext[slot] != NONE) slotPrev[slotNext[slot]] = slotPrev[slot]; else bucket.tail = slotPrev[slot];
+        slotBucket[slot] = slotPrev[slot] = slotNext[slot] = NONE;
+
+        if (bucket.head == NONE) {
+            if (bucket.prev != NONE) buckets[bucket.prev].next = bucket.next; else lowest = bucket.next;
+            if (bucket.next != NONE) buckets[bucket.next].prev = bucket.prev; else highest = bucket.prev;
+            freeBuckets.push_back(b);
+        }
+    }
+};
+
+#endif // LFU_BUCKETS_H
@@ -0,0 +1,157 @@
+#include "PolicyComparison.h"
+#include <unordered_map>
+#include <utility>
+
+namespace {
+
+typedef std::pair<uint64_t, uint64_t> Key;
+
+// Min-heaps over the ways of every set, stored flat: set s owns entries
+// [s * ways, (s + 1) * ways). Keys change in place.
+class WayHeaps {
+public:
+    WayHeaps(size_t sets, size_t ways)
+        : ways(ways), heap(sets * ways), position(sets * ways), keys(sets * ways), sizes(sets, 0) {}
+
+    size_t size(size_t set) const { return sizes[set]; }
+    uint32_t top(size_t set) const { return heap[set * ways]; }
+
+    void push(size_t set, uint32_t slot, const Key& key) {
+        size_t index = sizes[set]++;
+        heap[set * ways + index] = slot;
+        position[slot] = static_cast<uint32_t>(index);
+        keys[slot] = key;
+        siftUp(set, index);
+    }
+
+    void update(size_t set, uint32_t slot, const Key& key) {
+        bool smaller = key < keys[slot];
+        keys[slot] = key;
+        if (smaller) {
+            siftUp(set, position[slot]);
+        } else {
+            siftDown(set, position[slot]);
+        }
+    }
+
+    const Key& key(uint32_t slot) const { return keys[slot]; }
+
+private:
+    size_t ways;
+    std::vector<uint32_t> heap;        // Slot at each heap position
+    std::vector<uint32_t> position;    // Heap position of each slot
+    std::vector<Key> keys;
+    std::vector<uint32_t> sizes;
+
+    void place(size_t set, size_t index, uint32_t slot) {
+        heap[set * ways + index] = slot;
+        position[slot] = static_cast<uint32_t>(index);
+    }
+
+    void siftUp(size_t set, size_t index) {
+        uint32_t slot = heap[set * ways + index];
+        while (index > 0) {
+            size_t parent = (index - 1) / 2;
+            uint32_t parentSlot = heap[set * ways + parent];
+            if (!(keys[slot] < keys[parentSlot])) break;
+            place(set, index, parentSlot);
+            index = parent;
+        }
+        place(set, index, slot);
+    }
+
+    void siftDown(size_t set, size_t index) {
+        uint32_t slot = heap[set * ways + index];
+        size_t count = sizes[set];
+        while (true) {
+            size_t child = 2 * index + 1;
+            if (child >= count) break;
+            uint32_t childSlot = heap[set * ways + child];
+            if (child + 1 < count && keys[heap[set * ways + child + 1]] < keys[childSlot]) {
+                child++;
+                childSlot = heap[set * ways + child];
+            }
+            if (!(keys[childSlot] < keys[slot])) break;
+            place(set, index, childSlot);
+            index = child;
+        }
+        place(set, index, slot);
+    }
+};
+
+} // namespace
+
+const char* PolicyComparison::policyName(Policy policy) {
+    switch (policy) {
+        case FIFO: return "FIFO";
+        case LRU: return "LRU";
+        case LFU: return "LFU";
+        case OPT: return "OPT";
+    }
+    return "unknown";
+}
+
+std::vector<size_t> PolicyComparison::nextUses(const std::vector<Reference>& refs) {
+    std::vector<size_t> next(refs.size());
+    std::unordered_map<uint64_t, size_t> seen;
+    for (size_t i = refs.size(); i > 0; i--) {
+        auto inserted = seen.insert(std::make_pair(refs[i - 1].line, i - 1));
+        next[i - 1] = inserted.second ? refs.size() : inserted.first->second;
+        inserted.first->second = i - 1;
+    }
+    return next;
+}
+
+std::vector<bool> PolicyComparison::simulate(Policy policy, size_t sets, size_t ways,
+                                             const std::vector<Reference>& refs) {
+    std::vector<bool> missed(refs.size(), false);
+    std::vector<size_t> next;
+    if (policy == OPT) {
+        next = nextUses(refs);
+    }
+
+    WayHeaps heaps(sets, ways);
+    std::vector<uint64_t> lineOf(sets * ways);
+    std::unordered_map<uint64_t, uint32_t> resident;    // Line -> slot
+    resident.reserve(sets * ways);
+
+    for (size_t i = 0; i < refs.size(); i++) {
+        const Reference& ref = refs[i];
+        // OPT keeps the furthest next use on top of the min-heap
+        Key optKey(policy == OPT ? UINT64_MAX - next[i] : 0, 0);
+
+        auto it = resident.find(ref.line);
+        if (it != resident.end()) {
+            uint32_t slot = it->second;
+            switch (policy) {
+                case FIFO: break;
+                case LRU: heaps.update(ref.set, slot, Key(i, 0)); break;
+                case LFU: heaps.update(ref.set, slot, Key(heaps.key(slot).first + 1, i)); break;
+                case OPT: heaps.update(ref.set, slot, optKey); break;
+            }
+            continue;
+        }
+
+        missed[i] = true;
+        Key key;
+        switch (policy) {
+            case FIFO:
+            case LRU: key = Key(i, 0); break;
+            case LFU: key = Key(1, i); break;
+            case OPT: key = optKey; break;
+        }
+        if (heaps.size(ref.set) < ways) {
+            uint32_t slot = static_cast<uint32_t>(ref.set * ways + heaps.size(ref.set));
+            lineOf[slot] = ref.line;
+            resident[ref.line] = slot;
+            heaps.push(ref.set, slot, key);
+        } else {
+            uint32_t slot = heaps.top(ref.set);
+            resident.erase(lineOf[slot]);
+            lineOf[slot] = ref.line;
+            resident[ref.line] = slot;
+            heaps.update(ref.set, slot, key);
+        }
+    }
+    return missed;
+}
@@ -0,0 +1,39 @@
+#ifndef POLICY_COMPARISON_H
+#define POLICY_COMPARISON_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Offline replacement on a recorded reference stream. Besides FIFO, LRU and
+// LFU this runs Belady's MIN (OPT): on a miss in a full set, evict the line
+// whose next use lies furthest in the future. No online policy can miss
+// less, so OPT bounds what a better policy could gain on the stream.
+//
+// Next uses come from one reverse pass over the stream. Each set keeps its
+// ways in an indexed min-heap on the policy's key (load time, last use,
+// count then last use, or distance to the next use), so a hit or a fill
+// costs O(log ways) even for fully-associative levels.
+class PolicyComparison {
+public:
+    enum Policy { FIFO, LRU, LFU, OPT };
+    static const size_t POLICY_COUNT = 4;
+
+    // One reference as a level sees it
+    struct Reference {
+        uint64_t line;      // Block address
+        uint32_t set;
+    };
+
+    static const char* policyName(Policy policy);
+
+    // Index of the next reference to the same line, or refs.size() if none
+    static std::vector<size_t> nextUses(const std::vector<Reference>& refs);
+
+    // Replays `refs` through a `sets` x `ways` level under `policy` and
+    // returns, per reference, whether it missed. Every miss fills.
+    static std::vector<bool> simulate(Policy policy, size_t sets, size_t ways,
+                                      const std::vector<Reference>& refs);
+};
+
+#endif // POLICY_COMPARISON_H
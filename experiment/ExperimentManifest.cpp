@@ -0,0 +1,254 @@
+#include "ExperimentManifest.h"
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <set>
+#include <sstream>
+
+ExperimentPoint::ExperimentPoint()
+    : line(0), kind(SYNTHETIC), workload("100000"), seed(1),
+      memorySize(1024 * 1024), strategy(MemoryManager::FIRST_FIT),
+      index(MemoryManager::FREE_LIST), layout(MemoryManager::STANDARD_HEADER),
+      dirtyDecay(MemoryManager::NEVER), muzzyDecay(0),
+      l1Size(16 * 1024), l1Block(64), l1Assoc(4),      // Same hierarchy as 'init memory'
+      l2Size(64 * 1024), l2Block(64), l2Assoc(8), l1iSize(0), l1iBlock(0), l1iAssoc(0),
+      policy(CacheSimulator::FIFO), l1Sectors(1), l2Sectors(1) {
+}
+
+std::string ExperimentPoint::canonicalConfig() const {
+    static const char* const kinds[] = {"trace", "stream", "synthetic"};
+    std::ostringstream out;
+    out << "workload=" << kinds[kind];
+    // Files are identified by content (hashed separately), not by path
+    if (kind == SYNTHETIC) {
+        out << ":" << workload << " seed=" << seed;
+    }
+    if (kind != TRACE) {
+        out << " memory=" << memorySize << " strategy=" << strategy
+            << " index=" << index << " header=" << layout;
+        if (dirtyDecay != MemoryManager::NEVER) {
+            out << " purge=" << dirtyDecay << ":" << muzzyDecay;
+        }
+    }
+    out << " l1=" << l1Size << ":" << l1Block << ":" << l1Assoc << ":" << l1Sectors
+        << " l2=" << l2Size << ":" << l2Block << ":" << l2Assoc << ":" << l2Sectors
+        << " policy=" << policy;
+    if (l1iSize != 0) {
+        out << " l1i=" << l1iSize << ":" << l1iBlock << ":" << l1iAssoc;
+    }
+    return out.str();
+}
+
+namespace {
+
+bool parseSize(const std::string& text, size_t& value) {
+    if (text.empty() || !std::all_of(text.begin(), text.end(), ::isdigit)) {
+        return false;
+    }
+    try {
+        value = std::stoull(text);
+    } catch (const std::exception&) {
+        return false;
+    }
+    return true;
+}
+
+// "<size>:<block>:<assoc>"
+bool parseLevel(const std::string& text, size_t& size, size_t& block, size_t& assoc) {
+    size_t first = text.find(':');
+    size_t second = first == std::string::npos ? first : text.find(':', first + 1);
+    return second != std::string::npos &&
+           parseSize(text.substr(0, first), size) &&
+           parseSize(text.substr(first + 1, second - first - 1), block) &&
+           parseSize(text.substr(second + 1), assoc);
+}
+
+// Applies one key=value option; false with `error` set if it is invalid
+bool applyOption(const std::string& token, ExperimentPoint& point, std::string& error) {
+    size_t eq = token.find('=');
+    if (eq == std::string::npos) {
+        error = "invalid option '" + token + "' (expected key=value)";
+        return false;
+    }
+    std::string key = token.substr(0, eq);
+    std::string value = token.substr(eq + 1);
+    std::transform(value.begin(), value.end(), value.begin(), ::tolower);
+
+    if (key == "memory") {
+        if (!parseSize(value, point.memorySize) || point.memorySize == 0) {
+            error = "invalid memory size: " + value;
+            return false;
+        }
+    } else if (key == "dirty_decay" || key == "muzzy_decay") {
+        size_t ops = MemoryManager::NEVER;
+        if (value != "never" && !parseSize(value, ops)) {
+            error = "invalid " + key + ": " + value + " (expected <ops> or never)";
+            return false;
+        }
+        if (key == "dirty_decay") {
+            point.dirtyDecay = ops;
+        } else {
+            point.muzzyDecay = ops;
+        }
+    } else if (key == "seed") {
+        size_t seed;
+        if (!parseSize(value, seed)) {
+            error = "invalid seed: " + value;
+            return false;
+        }
+        point.seed = seed;
+    } else if (key == "strategy") {
+        if (value == "first") {
+            point.strategy = MemoryManager::FIRST_FIT;
+        } else if (value == "best") {
+            point.strategy = MemoryManager::BEST_FIT;
+        } else if (value == "worst") {
+            point.strategy = MemoryManager::WORST_FIT;
+        } else {
+            error = "invalid strategy (use first, best, worst)";
+            return false;
+        }
+    } else if (key == "index") {
+        if (value == "list") {
+            point.index = MemoryManager::FREE_LIST;
+        } else if (value == "tree") {
+            point.index = MemoryManager::SIZE_TREE;
+        } else if (value == "inband") {
+            point.index = MemoryManager::IN_BAND;
+        } else {
+            error = "invalid free index (use list, tree, inband)";
+            return false;
+        }
+    } else if (key == "header") {
+        if (value == "standard") {
+            point.layout = MemoryManager::STANDARD_HEADER;
+        } else if (value == "compact") {
+            point.layout = MemoryManager::COMPACT_HEADER;
+        } else {
+            error = "invalid header layout (use standard, compact)";
+            return false;
+        }
+    } else if (key == "l1" || key == "l2" || key == "l1i") {
+        bool ok = key == "l1" ? parseLevel(value, point.l1Size, point.l1Block, point.l1Assoc)
+                : key == "l2" ? parseLevel(value, point.l2Size, point.l2Block, point.l2Assoc)
+                              : parseLevel(value, point.l1iSize, point.l1iBlock, point.l1iAssoc);
+        if (!ok) {
+            error = "invalid " + key + " geometry '" + value + "' (expected size:block:assoc)";
+            return false;
+        }
+    } else if (key == "policy") {
+        if (value == "fifo") {
+            point.policy = CacheSimulator::FIFO;
+        } else if (value == "lru") {
+            point.policy = CacheSimulator::LRU;
+        } else if (value == "lfu") {
+            point.policy = CacheSimulator::LFU;
+        } else if (value == "lfu_da") {
+            point.policy = CacheSimulator::LFU_DA;
+        } else if (value == "hawkeye") {
+            point.policy = CacheSimulator::HAWKEYE;
+        } else {
+            error = "invalid policy (use fifo, lru, lfu, lfu_da, hawkeye)";
+            return false;
+        }
+    } else if (key == "sectors" || key == "l1_sectors" || key == "l2_sectors") {
+        size_t sectors;
+        if (!parseSize(value, sectors) || sectors == 0) {
+            error = "invalid sector count: " + value;
+            return false;
+        }
+        if (key != "l2_sectors") point.l1Sectors = sectors;
+        if (key != "l1_sectors") point.l2Sectors = sectors;
+    } else {
+        error = "unknown option: " + key;
+        return false;
+    }
+    return true;
+}
+
+bool parseWorkload(const std::string& token, ExperimentPoint& point, std::string& error) {
+    size_t colon = token.find(':');
+    std::string kind = token.substr(0, colon);
+    std::string value = colon == std::string::npos ? "" : token.substr(colon + 1);
+    if (value.empty()) {
+        error = "invalid workload '" + token + "' (expected trace:<file>, stream:<file> or synthetic:<ops>)";
+        return false;
+    }
+
+    if (kind == "trace") {
+        point.kind = ExperimentPoint::TRACE;
+    } else if (kind == "stream") {
+        point.kind = ExperimentPoint::STREAM;
+    } else if (kind == "synthetic") {
+        size_t ops;
+        if (!parseSize(value, ops)) {
+            error = "invalid synthetic operation count: " + value;
+            return false;
+        }
+        point.kind = ExperimentPoint::SYNTHETIC;
+    } else {
+        error = "unknown workload kind '" + kind + "' (use trace, stream, synthetic)";
+        return false;
+    }
+    point.workload = value;
+    return true;
+}
+
+} // namespace
+
+bool parseManifest(const std::string& path, std::vector<ExperimentPoint>& points, std::string& error) {
+    std::ifstream input(path);
+    if (!input) {
+        error = "cannot open manifest " + path;
+        return false;
+    }
+
+    ExperimentPoint defaults;
+    std::set<std::string> names;
+    std::string line;
+    size_t lineNumber = 0;
+    while (std::getline(input, line)) {
+        lineNumber++;
+        size_t hash = line.find('#');
+        if (hash != std::string::npos) {
+            line.erase(hash);
+        }
+        std::istringstream tokens(line);
+        std::vector<std::string> words;
+        std::string word;
+        while (tokens >> word) {
+            words.push_back(word);
+        }
+        if (words.empty()) continue;
+
+        std::string lineError;
+        if (words[0] == "defaults") {
+            for (size_t i = 1; i < words.size(); i++) {
+                if (!applyOption(words[i], defaults, lineError)) {
+                    error = "line " + std::to_string(lineNumber) + ": " + lineError;
+                    return false;
+                }
+            }
+            continue;
+        }
+
+        ExperimentPoint point = defaults;
+        point.name = words[0];
+        point.line = lineNumber;
+        bool ok = words.size() >= 2 && parseWorkload(words[1], point, lineError);
+        for (size_t i = 2; ok && i < words.size(); i++) {
+            ok = applyOption(words[i], point, lineError);
+        }
+        if (!ok) {
+            if (lineError.empty()) lineError = "missing workload";
+            error = "line " + std::to_string(lineNumber) + ": " + lineError;
+            return false;
+        }
+        if (!names.insert(point.name).second) {
+            error = "line " + std::to_string(lineNumber) + ": duplicate point name " + point.name;
+            return false;
+        }
+        points.push_back(point);
+    }
+    return true;
+}
@@ -0,0 +1,59 @@
+#ifndef EXPERIMENT_MANIFEST_H
+#define EXPERIMENT_MANIFEST_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "../allocator/MemoryManager.h"
+#include "../cache/CacheSimulator.h"
+
+// One point of a parameter study: a workload plus the allocator and cache
+// configuration to run it under.
+struct ExperimentPoint {
+    enum WorkloadKind {
+        TRACE,      // Text or encoded address trace, replayed through the cache
+        STREAM,     // File of 16-byte StreamRecords (allocations and accesses)
+        SYNTHETIC   // Seeded malloc/free/access mix generated in process
+    };
+
+    std::string name;
+    size_t line;
+
+    WorkloadKind kind;
+    std::string workload;       // File path, or the operation count for SYNTHETIC
+    uint64_t seed;
+
+    size_t memorySize;
+    MemoryManager::AllocationStrategy strategy;
+    MemoryManager::FreeIndex index;
+    MemoryManager::HeaderLayout layout;
+    uint64_t dirtyDecay, muzzyDecay;        // Page purging (MemoryManager::PurgeConfig)
+
+    size_t l1Size, l1Block, l1Assoc;
+    size_t l2Size, l2Block, l2Assoc;
+    size_t l1iSize, l1iBlock, l1iAssoc;     // Split L1 instruction cache; size 0 = unified L1
+    CacheSimulator::ReplacementPolicy policy;
+    size_t l1Sectors, l2Sectors;
+
+    ExperimentPoint();
+
+    // Every field that affects the result, in a fixed order; hashed into the
+    // result-cache key
+    std::string canonicalConfig() const;
+};
+
+// Reads a manifest: one point per line, '#' comments and blank lines skipped.
+//
+//   <name> <kind>:<workload> [key=value ...]
+//   defaults [key=value ...]          (applies to the points after it)
+//
+// Keys: memory, strategy (first|best|worst), index (list|tree|inband),
+// header (standard|compact), l1 / l2 / l1i (<size>:<block>:<assoc>),
+// policy (fifo|lru|lfu|lfu_da|hawkeye), sectors, l1_sectors, l2_sectors, seed,
+// dirty_decay / muzzy_decay (<ops>|never).
+// With l1i the L1 is split and trace instruction fetches go to the L1I.
+// On failure returns false with "line N: ..." in `error`.
+bool parseManifest(const std::string& path, std::vector<ExperimentPoint>& points, std::string& error);
+
+#endif // EXPERIMENT_MANIFEST_H
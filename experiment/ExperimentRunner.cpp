@@ -0,0 +1,458 @@
+#include "ExperimentRunner.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <fcntl.h>
+#include "../trace/StreamReader.h"
+#include "../trace/TraceCodec.h"
+#include "../trace/TraceReader.h"
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Bump when the simulators change behaviour, so stale cached results are not reused
+const char* const RESULT_FORMAT = "memsim-experiment-v6";
+
+const uint64_t FNV_OFFSET = 1469598103934665603ULL;
+const uint64_t FNV_PRIME = 1099511628211ULL;
+
+uint64_t fnv1a(const void* data, size_t bytes, uint64_t hash = FNV_OFFSET) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < bytes; i++) {
+        hash = (hash ^ p[i]) * FNV_PRIME;
+    }
+    return hash;
+}
+
+std::string toHex(uint64_t value) {
+    char text[17];
+    std::snprintf(text, sizeof(text), "%016llx", static_cast<unsigned long long>(value));
+    return text;
+}
+
+// Round-trips through std::stod bit-exactly
+std::string exactDouble(double value) {
+    char text[32];
+    std::snprintf(text, sizeof(text), "%.17g", value);
+    return text;
+}
+
+void runTrace(const ExperimentPoint& point, CacheSimulator& cache, ExperimentResult& result) {
+    if (TraceCodec::isEncodedTrace(point.workload)) {
+        TraceDecoder decoder;
+        if (!decoder.open(point.workload)) {
+            result.error = "cannot open " + point.workload;
+            return;
+        }
+        std::vector<TraceRecord> chunk;
+        while (decoder.nextChunk(chunk)) {
+            for (const TraceRecord& record : chunk) {
+                if (record.is_fetch) {
+                    cache.fetch(record.address);
+                } else {
+                    cache.access(record.address, record.is_write, record.pc);
+                }
+            }
+        }
+        result.accesses = decoder.getRecordCount();
+        result.error = decoder.getError();
+        return;
+    }
+
+    TraceReader reader;
+    if (!reader.open(point.workload)) {
+        result.error = "cannot open " + point.workload;
+        return;
+    }
+    TraceRecord record;
+    while (reader.next(record)) {
+        if (record.is_fetch) {
+            cache.fetch(record.address);
+        } else {
+            cache.access(record.address, record.is_write, record.pc);
+        }
+    }
+    result.accesses = reader.getRecordCount();
+}
+
+// Same record semantics as --stream mode
+void runStream(const ExperimentPoint& point, MemoryManager& memory, CacheSimulator& cache,
+               ExperimentResult& result) {
+#ifdef _WIN32
+    int fd = _open(point.workload.c_str(), _O_RDONLY | _O_BINARY);
+#else
+    int fd = ::open(point.workload.c_str(), O_RDONLY);
+#endif
+    if (fd < 0) {
+        result.error = "cannot open " + point.workload;
+        return;
+    }
+
+    std::map<uint32_t, void*> handles;
+    StreamReader reader(fd);
+    StreamRecord record;
+    while (reader.next(record)) {
+        switch (record.op) {
+            case StreamRecord::OP_READ:
+            case StreamRecord::OP_WRITE:
+                cache.access(record.value, record.op == StreamRecord::OP_WRITE);
+                result.accesses++;
+                break;
+            case StreamRecord::OP_MALLOC: {
+                if (handles.count(record.handle) != 0) break;
+                void* ptr = memory.allocate(record.value);
+                if (ptr != nullptr) {
+                    handles[record.handle] = ptr;
+                    result.mallocs++;
+                } else {
+                    result.failedMallocs++;
+                }
+                break;
+            }
+            case StreamRecord::OP_FREE: {
+                auto it = handles.find(record.handle);
+                if (it != handles.end() && memory.deallocate(it->second)) {
+                    handles.erase(it);
+                    result.frees++;
+                }
+                break;
+            }
+            default:
+                break;
+        }
+    }
+#ifdef _WIN32
+    _close(fd);
+#else
+    ::close(fd);
+#endif
+}
+
+// Seeded mix of 10% malloc (16-4096 bytes), 8% free and 82% accesses to a
+// random live block (30% writes). Only mt19937_64 output is used, reduced
+// with %, so a seed produces the same workload on every platform (the
+// std::*_distribution algorithms are implementation-defined).
+void runSynthetic(const ExperimentPoint& point, MemoryManager& memory, CacheSimulator& cache,
+                  ExperimentResult& result) {
+    std::mt19937_64 rng(point.seed);
+    size_t ops = std::stoull(point.workload);
+    std::vector<void*> live;
+    std::vector<size_t> sizes;
+
+    for (size_t op = 0; op < ops; op++) {
+        uint64_t choice = rng() % 100;
+        if (choice < 10 || live.empty()) {
+            size_t size = 16 + rng() % 4081;
+            void* ptr = memory.allocate(size);
+            if (ptr != nullptr) {
+                live.push_back(ptr);
+                sizes.push_back(size);
+                result.mallocs++;
+            } else {
+                result.failedMallocs++;
+            }
+        } else if (choice < 18) {
+            size_t victim = rng() % live.size();
+            memory.deallocate(live[victim]);
+            live[victim] = live.back();
+            sizes[victim] = sizes.back();
+            live.pop_back();
+            sizes.pop_back();
+            result.frees++;
+        } else {
+            size_t block = rng() % live.size();
+            uint64_t address = memory.getOffset(live[block]) + rng() % sizes[block];
+            cache.access(address, rng() % 100 < 30);
+            result.accesses++;
+        }
+    }
+}
+
+ExperimentResult simulate(const ExperimentPoint& point) {
+    ExperimentResult result;
+    std::unique_ptr<CacheSimulator> cache;
+    std::unique_ptr<MemoryManager> memory;
+    try {
+        CacheSimulator::Options options;
+        options.l1Sectors = point.l1Sectors;
+        options.l2Sectors = point.l2Sectors;
+        options.l1iSize = point.l1iSize;
+        options.l1iBlockSize = point.l1iBlock;
+        options.l1iAssociativity = point.l1iAssoc;
+        cache.reset(new CacheSimulator(point.l1Size, point.l1Block, point.l1Assoc,
+                                       point.l2Size, point.l2Block, point.l2Assoc,
+                                       point.policy, options));
+        cache->setEventLogging(false);
+
+        if (point.kind != ExperimentPoint::TRACE) {
+            if (point.memorySize > MemoryManager::getMaxHeapSize(point.layout)) {
+                result.error = "memory size exceeds the header layout's limit";
+                return result;
+            }
+            memory.reset(new MemoryManager(point.memorySize, point.strategy, point.index, point.layout));
+            MemoryManager::PurgeConfig purge;
+            purge.dirtyDecay = point.dirtyDecay;
+            purge.muzzyDecay = point.muzzyDecay;
+            memory->setPurgeConfig(purge);
+        }
+
+        switch (point.kind) {
+            case ExperimentPoint::TRACE:
+                runTrace(point, *cache, result);
+                break;
+            case ExperimentPoint::STREAM:
+                runStream(point, *memory, *cache, result);
+                break;
+            case ExperimentPoint::SYNTHETIC:
+                runSynthetic(point, *memory, *cache, result);
+                break;
+        }
+    } catch (const std::exception& e) {
+        result.error = e.what();
+        return result;
+    }
+
+    result.l1Hits = cache->getHits(1);
+    result.l1Misses = cache->getMisses(1);
+    result.l1iHits = cache->getHits(CacheSimulator::L1I_LEVEL);
+    result.l1iMisses = cache->getMisses(CacheSimulator::L1I_LEVEL);
+    result.l2Hits = cache->getHits(2);
+    result.l2Misses = cache->getMisses(2);
+    result.memoryReadBytes = cache->getMemoryReadBytes();
+    result.memoryWriteBytes = cache->getMemoryWriteBytes();
+    if (memory) {
+        result.usedBytes = memory->getUsedMemory();
+        result.residentBytes = memory->getPageStats().residentBytes;
+        MemoryManager::PurgeStats purge = memory->getPurgeStats();
+        result.averageResidentBytes = static_cast<uint64_t>(purge.averageResidentPages * purge.pageSize);
+        result.purgedPages = purge.purges;
+        result.refaults = purge.refaults;
+        result.purgeCycles = purge.purgeCycles;
+        result.internalFragmentation = memory->getInternalFragmentation();
+        result.externalFragmentation = memory->getExternalFragmentation();
+    }
+    return result;
+}
+
+} // namespace
+
+ExperimentResult::ExperimentResult()
+    : cached(false), accesses(0), l1Hits(0), l1Misses(0), l1iHits(0), l1iMisses(0), l2Hits(0), l2Misses(0),
+      memoryReadBytes(0), memoryWriteBytes(0), mallocs(0), failedMallocs(0), frees(0),
+      usedBytes(0), residentBytes(0), averageResidentBytes(0), purgedPages(0), refaults(0),
+      purgeCycles(0), internalFragmentation(0.0), externalFragmentation(0.0) {
+}
+
+bool hashFileContent(const std::string& path, uint64_t& hash) {
+    std::ifstream input(path, std::ios::binary);
+    if (!input) {
+        return false;
+    }
+    std::vector<char> buffer(1 << 20);
+    hash = FNV_OFFSET;
+    while (input) {
+        input.read(buffer.data(), buffer.size());
+        hash = fnv1a(buffer.data(), static_cast<size_t>(input.gcount()), hash);
+    }
+    return input.eof();
+}
+
+ExperimentRunner::ExperimentRunner(const std::string& cache_dir, size_t jobs, bool use_cache)
+    : cacheDir(cache_dir), jobs(jobs), useCache(use_cache), simulated(0), cachedPoints(0) {
+    if (this->jobs == 0) {
+        this->jobs = std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+}
+
+template <typename Function>
+void ExperimentRunner::parallelFor(size_t count, Function fn) const {
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        for (size_t i = next++; i < count; i = next++) {
+            fn(i);
+        }
+    };
+    std::vector<std::thread> threads;
+    for (size_t t = 1; t < std::min(jobs, count); t++) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+std::vector<ExperimentResult> ExperimentRunner::run(const std::vector<ExperimentPoint>& points) {
+    std::vector<ExperimentResult> results(points.size());
+    simulated = 0;
+    cachedPoints = 0;
+
+    // Hash each distinct workload file once, in parallel
+    std::vector<std::string> files;
+    std::map<std::string, size_t> fileIndex;
+    for (const ExperimentPoint& point : points) {
+        if (point.kind != ExperimentPoint::SYNTHETIC && fileIndex.count(point.workload) == 0) {
+            fileIndex[point.workload] = files.size();
+            files.push_back(point.workload);
+        }
+    }
+    std::vector<uint64_t> fileHashes(files.size());
+    std::vector<char> fileOk(files.size());
+    parallelFor(files.size(), [&](size_t i) {
+        fileOk[i] = hashFileContent(files[i], fileHashes[i]);
+    });
+
+    // Key every point; points with equal keys share one simulation
+    std::map<std::string, size_t> leaders;
+    std::vector<size_t> leaderOf(points.size());
+    std::vector<size_t> pending;
+    for (size_t i = 0; i < points.size(); i++) {
+        const ExperimentPoint& point = points[i];
+        std::string material = std::string(RESULT_FORMAT) + "\n" + point.canonicalConfig() + "\n";
+        if (point.kind != ExperimentPoint::SYNTHETIC) {
+            size_t file = fileIndex[point.workload];
+            if (!fileOk[file]) {
+                results[i].error = "cannot read " + point.workload;
+                leaderOf[i] = i;
+                continue;
+            }
+            material += toHex(fileHashes[file]);
+        }
+        results[i].key = toHex(fnv1a(material.data(), material.size()));
+
+        auto leader = leaders.find(results[i].key);
+        if (leader != leaders.end()) {
+            leaderOf[i] = leader->second;
+            continue;
+        }
+        leaders[results[i].key] = i;
+        leaderOf[i] = i;
+        if (useCache && loadResult(results[i].key, point.canonicalConfig(), results[i])) {
+            results[i].cached = true;
+        } else {
+            pending.push_back(i);
+        }
+    }
+
+    parallelFor(pending.size(), [&](size_t p) {
+        size_t i = pending[p];
+        std::string key = results[i].key;
+        results[i] = simulate(points[i]);
+        results[i].key = key;
+        if (useCache && results[i].error.empty()) {
+            storeResult(key, points[i].canonicalConfig(), results[i]);
+        }
+    });
+    simulated = pending.size();
+
+    for (size_t i = 0; i < points.size(); i++) {
+        if (leaderOf[i] != i) {
+            results[i] = results[leaderOf[i]];
+        }
+        if (results[i].cached) {
+            cachedPoints++;
+        }
+    }
+    return results;
+}
+
+bool ExperimentRunner::loadResult(const std::string& key, const std::string& config,
+                                  ExperimentResult& result) const {
+    std::ifstream input(cacheDir + "/" + key + ".result");
+    if (!input) {
+        return false;
+    }
+    std::map<std::string, std::string> fields;
+    std::string line;
+    while (std::getline(input, line)) {
+        size_t eq = line.find('=');
+        if (eq != std::string::npos) {
+            fields[line.substr(0, eq)] = line.substr(eq + 1);
+        }
+    }
+    // A hash collision or a hand-edited file must not be mistaken for this point
+    if (fields["config"] != config) {
+        return false;
+    }
+
+    try {
+        result.accesses = std::stoull(fields.at("accesses"));
+        result.l1Hits = std::stoull(fields.at("l1_hits"));
+        result.l1Misses = std::stoull(fields.at("l1_misses"));
+        result.l1iHits = std::stoull(fields.at("l1i_hits"));
+        result.l1iMisses = std::stoull(fields.at("l1i_misses"));
+        result.l2Hits = std::stoull(fields.at("l2_hits"));
+        result.l2Misses = std::stoull(fields.at("l2_misses"));
+        result.memoryReadBytes = std::stoull(fields.at("memory_read_bytes"));
+        result.memoryWriteBytes = std::stoull(fields.at("memory_write_bytes"));
+        result.mallocs = std::stoull(fields.at("mallocs"));
+        result.failedMallocs = std::stoull(fields.at("failed_mallocs"));
+        result.frees = std::stoull(fields.at("frees"));
+        result.usedBytes = std::stoull(fields.at("used_bytes"));
+        result.residentBytes = std::stoull(fields.at("rss_bytes"));
+        result.averageResidentBytes = std::stoull(fields.at("avg_rss_bytes"));
+        result.purgedPages = std::stoull(fields.at("purged_pages"));
+        result.refaults = std::stoull(fields.at("refaults"));
+        result.purgeCycles = std::stoull(fields.at("purge_cycles"));
+        result.internalFragmentation = std::stod(fields.at("internal_fragmentation"));
+        result.externalFragmentation = std::stod(fields.at("external_fragmentation"));
+    } catch (const std::exception&) {
+        return false;  // Truncated or corrupt entry: simulate again
+    }
+    return true;
+}
+
+void ExperimentRunner::storeResult(const std::string& key, const std::string& config,
+                                   const ExperimentResult& result) const {
+    std::error_code ignored;
+    std::filesystem::create_directories(cacheDir, ignored);
+
+    // Write then rename, so an interrupted run never leaves half a file behind
+    std::string path = cacheDir + "/" + key + ".result";
+    std::string temp = path + ".tmp";
+    {
+        std::ofstream output(temp);
+        if (!output) {
+            return;
+        }
+        output << "config=" << config << "\n"
+               << "accesses=" << result.accesses << "\n"
+               << "l1_hits=" << result.l1Hits << "\n"
+               << "l1_misses=" << result.l1Misses << "\n"
+               << "l1i_hits=" << result.l1iHits << "\n"
+               << "l1i_misses=" << result.l1iMisses << "\n"
+               << "l2_hits=" << result.l2Hits << "\n"
+               << "l2_misses=" << result.l2Misses << "\n"
+               << "memory_read_bytes=" << result.memoryReadBytes << "\n"
+               << "memory_write_bytes=" << result.memoryWriteBytes << "\n"
+               << "mallocs=" << result.mallocs << "\n"
+               << "failed_mallocs=" << result.failedMallocs << "\n"
+               << "frees=" << result.frees << "\n"
+               << "used_bytes=" << result.usedBytes << "\n"
+               << "rss_bytes=" << result.residentBytes << "\n"
+               << "avg_rss_bytes=" << result.averageResidentBytes << "\n"
+               << "purged_pages=" << result.purgedPages << "\n"
+               << "refaults=" << result.refaults << "\n"
+               << "purge_cycles=" << result.purgeCycles << "\n"
+               << "internal_fragmentation=" << exactDouble(result.internalFragmentation) << "\n"
+               << "external_fragmentation=" << exactDouble(result.externalFragmentation) << "\n";
+        if (!output) {
+            output.close();
+            std::filesystem::remove(temp, ignored);
+            return;
+        }
+    }
+    std::filesystem::rename(temp, path, ignored);
+}
@@ -0,0 +1,69 @@
+#ifndef EXPERIMENT_RUNNER_H
+#define EXPERIMENT_RUNNER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "ExperimentManifest.h"
+
+// Outcome of one ExperimentPoint
+struct ExperimentResult {
+    std::string key;        // Result-cache key (16 hex digits)
+    bool cached;            // Loaded from the result cache instead of simulated
+    std::string error;      // Non-empty if the point could not be run
+
+    uint64_t accesses;
+    uint64_t l1Hits, l1Misses;        // Data L1 when the point splits the L1
+    uint64_t l1iHits, l1iMisses;      // Split L1 instruction cache (0 if unified)
+    uint64_t l2Hits, l2Misses;
+    uint64_t memoryReadBytes, memoryWriteBytes;
+    uint64_t mallocs, failedMallocs, frees;
+    uint64_t usedBytes;
+    uint64_t residentBytes;           // Estimated heap RSS at 4 KB pages
+    uint64_t averageResidentBytes;    // RSS averaged over allocator operations
+    uint64_t purgedPages, refaults;
+    uint64_t purgeCycles;             // Purges and refaults (MemoryManager::PurgeStats)
+    double internalFragmentation;
+    double externalFragmentation;
+
+    ExperimentResult();
+};
+
+// Runs the points of a manifest on a pool of worker threads. Each point gets
+// its own MemoryManager and CacheSimulator, so results do not depend on
+// scheduling; synthetic workloads draw from a generator seeded by the point.
+//
+// Results are cached in `cache_dir`, one file per key. The key hashes the
+// point's canonical configuration with the content of its workload file, so
+// an unchanged point is loaded instead of simulated, while editing a trace or
+// any parameter produces a new key. Points sharing a key are simulated once.
+class ExperimentRunner {
+public:
+    ExperimentRunner(const std::string& cache_dir, size_t jobs, bool use_cache = true);
+
+    // One result per point, in manifest order
+    std::vector<ExperimentResult> run(const std::vector<ExperimentPoint>& points);
+
+    size_t getSimulatedCount() const { return simulated; }
+    size_t getCachedCount() const { return cachedPoints; }
+
+private:
+    std::string cacheDir;
+    size_t jobs;
+    bool useCache;
+    size_t simulated;
+    size_t cachedPoints;
+
+    // Runs fn(0) .. fn(count - 1) on up to `jobs` threads
+    template <typename Function>
+    void parallelFor(size_t count, Function fn) const;
+
+    bool loadResult(const std::string& key, const std::string& config, ExperimentResult& result) const;
+    void storeResult(const std::string& key, const std::string& config, const ExperimentResult& result) const;
+};
+
+// FNV-1a over a file's bytes; false if it cannot be read
+bool hashFileContent(const std::string& path, uint64_t& hash);
+
+#endif // EXPERIMENT_RUNNER_H
@@ -4,9 +4,23 @@
 #include <algorithm>
 #include <cctype>
 #include <map>
+#include <deque>
+#include <chrono>
+#include <iomanip>
+#include <fstream>
 #include "allocator/MemoryManager.h"
+#include "allocator/PageMap.h"
 #include "cache/CacheSimulator.h"
 #include "stats/StatsManager.h"
+#include "analysis/ReuseDistanceAnalyzer.h"
+#include "analysis/WorkingSetAnalyzer.h"
+#include "trace/TraceReader.h"
+#include "trace/TraceCodec.h"
+#include "trace/TracePipeline.h"
+#include "trace/StreamReader.h"
+#include "server/SimServer.h"
+#include "experiment/ExperimentManifest.h"
+#include "experiment/ExperimentRunner.h"
 
 class MemorySimulatorCLI {
 private:
@@ -18,6 +32,7 @@ private:
     size_t nextBlockId;
     std::map<size_t, void*> blockIdToAddress;
     std::map<void*, size_t> addressToBlockId;
+    std::deque<size_t> cachedBlocks;    // 'malloc <size> cached', oldest first: what reclaim frees
 
 public:
     MemorySimulatorCLI() 
@@ -59,12 +74,22 @@ public:
                 handleMalloc(tokens);
             } else if (command == "free") {
                 handleFree(tokens);
+            } else if (command == "handle") {
+                handleHandle(tokens);
             } else if (command == "dump") {
                 handleDump(tokens);
+            } else if (command == "verify") {
+                handleVerify(tokens);
             } else if (command == "stats") {
                 handleStats();
             } else if (command == "access") {
                 handleAccess(tokens);
+            } else if (command == "analyze") {
+                handleAnalyze(tokens);
+            } else if (command == "encode") {
+                handleEncode(tokens);
+            } else if (command == "replay") {
+                handleReplay(tokens);
             } else {
                 std::cout << "Unknown command: " << command << "\n";
                 std::cout << "Type 'help' for available commands\n";
@@ -74,7 +99,125 @@ public:
         std::cout << "Simulator exited.\n";
     }
     
+    // Non-interactive mode: consumes binary StreamRecords from stdin (see
+    // trace/StreamReader.h) as they arrive and prints a stats line every
+    // `interval` records. Only live blocks are tracked, so memory stays
+    // bounded however long the stream runs.
+    void runStream(size_t memorySize, size_t interval) {
+        memoryManager = new MemoryManager(memorySize, MemoryManager::FIRST_FIT);
+        cacheSimulator = new CacheSimulator(
+            16 * 1024, 64, 4,   // L1: 16KB, 64B block, 4-way
+            64 * 1024, 64, 8    // L2: 64KB, 64B block, 8-way
+        );
+        cacheSimulator->setEventLogging(false);
+        initialized = true;
+
+        std::cout << "Streaming records from stdin (memory " << memorySize
+                  << " bytes, stats every " << interval << " records)" << std::endl;
+
+        StreamCounters counters;
+        std::map<uint32_t, void*> handles;
+        StreamReader reader;
+        StreamRecord record;
+
+        while (reader.next(record)) {
+            switch (record.op) {
+                case StreamRecord::OP_READ:
+                case StreamRecord::OP_WRITE:
+                    cacheSimulator->access(record.value, record.op == StreamRecord::OP_WRITE);
+                    counters.accesses++;
+                    break;
+                case StreamRecord::OP_MALLOC: {
+                    if (handles.count(record.handle) != 0) {
+                        counters.rejected++;  // Handle still live
+                        break;
+                    }
+                    void* ptr = memoryManager->allocate(record.value);
+                    statsManager->logMemoryAllocation(record.value, ptr != nullptr);
+                    if (ptr != nullptr) {
+                        handles[record.handle] = ptr;
+                        counters.mallocs++;
+                    } else {
+                        counters.failedMallocs++;
+                    }
+                    break;
+                }
+                case StreamRecord::OP_FREE: {
+                    auto it = handles.find(record.handle);
+                    if (it != handles.end() && memoryManager->deallocate(it->second)) {
+                        handles.erase(it);
+                        counters.frees++;
+                    } else {
+                        counters.rejected++;
+                    }
+                    break;
+                }
+                default:
+                    counters.rejected++;
+                    break;
+            }
+
+            if (reader.getRecordCount() % interval == 0) {
+                printStreamStats(reader.getRecordCount(), counters);
+            }
+        }
+
+        if (reader.getRecordCount() % interval != 0) {
+            printStreamStats(reader.getRecordCount(), counters);
+        }
+        std::cout << "End of stream: " << reader.getRecordCount() << " records, "
+                  << reader.getBytesRead() << " bytes";
+        if (reader.getTrailingBytes() > 0) {
+            std::cout << " (" << reader.getTrailingBytes() << " trailing bytes ignored)";
+        }
+        std::cout << "\n";
+        cacheSimulator->setEventLogging(true);
+        handleStats();
+    }
+
 private:
+    // Running totals of a --stream session; `last*` hold the values at the
+    // previous stats line so each line also shows the interval's hit ratio
+    struct StreamCounters {
+        size_t accesses = 0;
+        size_t mallocs = 0;
+        size_t failedMallocs = 0;
+        size_t frees = 0;
+        size_t rejected = 0;
+        size_t lastL1Hits = 0;
+        size_t lastL1Misses = 0;
+    };
+
+    void printStreamStats(size_t records, StreamCounters& counters) {
+        size_t l1Hits = cacheSimulator->getHits(1);
+        size_t l1Misses = cacheSimulator->getMisses(1);
+        size_t l2Hits = cacheSimulator->getHits(2);
+        size_t l2Misses = cacheSimulator->getMisses(2);
+        size_t intervalHits = l1Hits - counters.lastL1Hits;
+        size_t intervalTotal = intervalHits + (l1Misses - counters.lastL1Misses);
+        counters.lastL1Hits = l1Hits;
+        counters.lastL1Misses = l1Misses;
+
+        auto ratio = [](size_t hits, size_t total) {
+            return total == 0 ? 0.0 : 100.0 * hits / total;
+        };
+
+        std::cout << std::fixed << std::setprecision(2)
+                  << "[stream] records=" << records
+                  << " accesses=" << counters.accesses
+                  << " L1=" << ratio(l1Hits, l1Hits + l1Misses) << "%"
+                  << " (interval " << ratio(intervalHits, intervalTotal) << "%)"
+                  << " L2=" << ratio(l2Hits, l2Hits + l2Misses) << "%"
+                  << " mallocs=" << counters.mallocs << "/" << counters.failedMallocs << " failed"
+                  << " frees=" << counters.frees
+                  << " used=" << memoryManager->getUsedMemory() << "B"
+                  << " ext_frag=" << memoryManager->getExternalFragmentation() << "%";
+        if (counters.rejected > 0) {
+            std::cout << " rejected=" << counters.rejected;
+        }
+        std::cout << std::endl;  // Flush so a watcher sees each line immediately
+    }
+
     std::vector<std::string> tokenize(const std::string& line) {
         std::vector<std::string> tokens;
         std::istringstream iss(line);
@@ -87,17 +230,32 @@ private:
     
     void printHelp() {
         std::cout << "\nAvailable commands:\n";
-        std::cout << "  init memory <size>            - Initialize memory system (RAM + Cache)\n";
-        std::cout << "  init cache <params...>        - Initialize L1/L2 cache hierarchy\n";
+        std::cout << "  init memory <size> [opts]     - Initialize memory system (RAM + Cache)\n";
+        std::cout << "                                  opts: index=list|tree|inband header=standard|compact page=<bytes>\n";
+        std::cout << "  init cache <params...> [opts] - Initialize L1/L2 cache hierarchy (opts: index=, sectors=, engine=, address_bits=, lfu_aging=, insertion=, bypass=, l1i=)\n";
         std::cout << "  set allocator <strategy>      - Set allocation strategy (first_fit, best_fit, worst_fit)\n";
-        std::cout << "  set cache_policy <policy>     - Set cache replacement policy (fifo, lru, lfu)\n";
-        std::cout << "  malloc <size>                 - Allocate memory block\n";
+        std::cout << "  set cache_policy <policy>     - Set cache replacement policy (fifo, lru, lfu, lfu_da, hawkeye)\n";
+        std::cout << "  set purge <opts>|off|now      - Decay-based page purging (dirty=, muzzy=, lazy_cost=, purge_cost=, refault_cost=)\n";
+        std::cout << "  set oom <opts>|off            - Allocation failure recovery (flush=, reclaim=, compact=, grow=, defer=)\n";
+        std::cout << "  malloc <size> [cached]        - Allocate memory block (cached: reclaimable under memory pressure)\n";
 
         std::cout << "  free <block_id>               - Free memory block by ID\n";
         std::cout << "  free 0x<address>              - Free memory block by address\n";
+        std::cout << "  handle alloc <size>           - Allocate a relocatable block, named by a generational handle\n";
+        std::cout << "  handle pin|unpin|free <h>     - Pin (get the address, block stays put), unpin or free a handle\n";
         std::cout << "  dump memory                   - Display memory layout\n";
+        std::cout << "  dump free                     - Histogram of free block sizes\n";
+        std::cout << "  dump pages [page_size]        - Resident, live and reclaimable OS pages (RSS estimate)\n";
+        std::cout << "  dump handles                  - Live handles, their blocks and pins\n";
+        std::cout << "  verify heap                   - Check block boundaries, tracking and free index\n";
         std::cout << "  stats                         - Display statistics\n";
-        std::cout << "  access <address>              - Simulate cache access (Physical Address)\n";
+        std::cout << "  access <address> [r|w|i]      - Simulate cache read/write/instruction fetch (Physical Address)\n";
+        std::cout << "  analyze <trace> [line] [page] [window]\n";
+        std::cout << "                                - Reuse-distance & working-set histograms of a trace\n";
+        std::cout << "  encode <trace> <out> [block]  - Compress a text trace (delta/stride/varint blocks)\n";
+        std::cout << "  replay <trace> [reader=async|sync] [opt=on]\n";
+        std::cout << "                                - Run a text or encoded trace through the cache\n";
+        std::cout << "                                  (opt=on: also compare FIFO/LRU/LFU with Belady's OPT)\n";
         std::cout << "  help                          - Show this help\n";
         std::cout << "  exit                          - Exit simulator\n\n";
     }
@@ -110,18 +268,42 @@ private:
 
         if (tokens[1] == "memory") {
             if (tokens.size() < 3) {
-                std::cout << "Usage: init memory <size>\n";
+                std::cout << "Usage: init memory <size> [index=list|tree|inband] [header=standard|compact] [page=<bytes>]\n";
                 return;
             }
             
             size_t size = std::stoull(tokens[2]);
+
+            MemoryManager::FreeIndex index = MemoryManager::FREE_LIST;
+            MemoryManager::HeaderLayout layout = MemoryManager::STANDARD_HEADER;
+            size_t pageSize = 4096;
+            for (size_t i = 3; i < tokens.size(); i++) {
+                if (!parseMemoryOption(tokens[i], index, layout, pageSize)) {
+                    return;
+                }
+            }
+            if (size > MemoryManager::getMaxHeapSize(layout)) {
+                std::cout << "Memory size exceeds the " << MemoryManager::getMaxHeapSize(layout)
+                          << "-byte limit of the compact header\n";
+                return;
+            }
             
             // Delete existing managers
             delete memoryManager;
             memoryManager = nullptr;
             
             // Initialize memory manager
-            memoryManager = new MemoryManager(size, MemoryManager::FIRST_FIT);
+            memoryManager = new MemoryManager(size, MemoryManager::FIRST_FIT, index, layout);
+            memoryManager->setPageSize(pageSize);
+            memoryManager->setReclaimCallback([this](size_t size) { return reclaimCachedBlocks(size); });
+            memoryManager->setRelocationCallback([this](void* from, void* to) {
+                auto it = addressToBlockId.find(from);
+                if (it == addressToBlockId.end()) return;
+                size_t blockId = it->second;
+                addressToBlockId.erase(it);
+                addressToBlockId[to] = blockId;
+                blockIdToAddress[blockId] = to;
+            });
             
             if (cacheSimulator == nullptr) {
                 // Initialize cache simulator (default sizes)
@@ -135,42 +317,315 @@ private:
             nextBlockId = 1;
             blockIdToAddress.clear();
             addressToBlockId.clear();
+            cachedBlocks.clear();
             
             std::cout << "Memory initialized with size: " << size << " bytes\n";
+            if (index != MemoryManager::FREE_LIST || layout != MemoryManager::STANDARD_HEADER) {
+                std::cout << "Free index: " << indexName(index)
+                          << ", header: " << (layout == MemoryManager::COMPACT_HEADER ? "compact" : "standard")
+                          << " (" << memoryManager->getHeaderSize() << " bytes)\n";
+            }
 
         } else if (tokens[1] == "cache") {
-            // init cache <l1_size> <l1_block_size> <l1_assoc> <l2_size> <l2_block_size> <l2_assoc>
+            // init cache <l1_size> <l1_block_size> <l1_assoc> <l2_size> <l2_block_size> <l2_assoc> [key=value...]
             if (tokens.size() < 8) {
-                std::cout << "Usage: init cache <l1_sz> <l1_blk> <l1_assoc> <l2_sz> <l2_blk> <l2_assoc>\n";
+                std::cout << "Usage: init cache <l1_sz> <l1_blk> <l1_assoc> <l2_sz> <l2_blk> <l2_assoc> [key=value...]\n";
+                std::cout << "Options: index=modulo|xor|skewed, sectors=N, l1_sectors=N, l2_sectors=N, engine=auto|generic|compact,\n";
+                std::cout << "         address_bits=N, lfu_aging=N, insertion=mru|lip|bip, l1_insertion=, l2_insertion=,\n";
+                std::cout << "         bip_period=N, bypass=on|off, l1i=<size>:<block>:<assoc>\n";
                 return;
             }
             
+            size_t l1_size, l1_block, l1_assoc, l2_size, l2_block, l2_assoc;
+            CacheSimulator::Options options;
             try {
-                size_t l1_size = std::stoull(tokens[2]);
-                size_t l1_block = std::stoull(tokens[3]);
-                size_t l1_assoc = std::stoull(tokens[4]);
-                size_t l2_size = std::stoull(tokens[5]);
-                size_t l2_block = std::stoull(tokens[6]);
-                size_t l2_assoc = std::stoull(tokens[7]);
-                
-                delete cacheSimulator;
-                cacheSimulator = new CacheSimulator(
+                l1_size = std::stoull(tokens[2]);
+                l1_block = std::stoull(tokens[3]);
+                l1_assoc = std::stoull(tokens[4]);
+                l2_size = std::stoull(tokens[5]);
+                l2_block = std::stoull(tokens[6]);
+                l2_assoc = std::stoull(tokens[7]);
+            } catch (const std::exception& e) {
+                std::cout << "Error parsing cache parameters: " << e.what() << "\n";
+                return;
+            }
+
+            for (size_t i = 8; i < tokens.size(); i++) {
+                if (!parseCacheOption(tokens[i], options)) {
+                    return;
+                }
+            }
+
+            CacheSimulator* configured = nullptr;
+            try {
+                configured = new CacheSimulator(
                     l1_size, l1_block, l1_assoc,
-                    l2_size, l2_block, l2_assoc
+                    l2_size, l2_block, l2_assoc,
+                    CacheSimulator::FIFO, options
                 );
-                
-                std::cout << "Cache initialized:\n";
-                std::cout << "L1: " << l1_size << "B, " << l1_block << "B blocks, " << l1_assoc << "-way\n";
-                std::cout << "L2: " << l2_size << "B, " << l2_block << "B blocks, " << l2_assoc << "-way\n";
-                
             } catch (const std::exception& e) {
-                std::cout << "Error parsing cache parameters: " << e.what() << "\n";
+                // Keep the previous cache rather than simulating a broken geometry
+                std::cout << "Invalid cache configuration: " << e.what() << "\n";
+                return;
+            }
+
+            delete cacheSimulator;
+            cacheSimulator = configured;
+            
+            std::cout << "Cache initialized:\n";
+            std::cout << (options.l1iSize != 0 ? "L1D: " : "L1: ") << l1_size << "B, " << l1_block << "B blocks, "
+                      << l1_assoc << "-way\n";
+            if (options.l1iSize != 0) {
+                std::cout << "L1I: " << options.l1iSize << "B, " << options.l1iBlockSize << "B blocks, "
+                          << options.l1iAssociativity << "-way\n";
+            }
+            std::cout << "L2: " << l2_size << "B, " << l2_block << "B blocks, " << l2_assoc << "-way\n";
+            if (options.l1Sectors > 1 || options.l2Sectors > 1) {
+                std::cout << "Sectors per block: L1=" << options.l1Sectors << ", L2=" << options.l2Sectors << "\n";
+            }
+            if (options.indexFunction != CacheSimulator::INDEX_MODULO) {
+                std::cout << "Index function: " << indexFunctionName(options.indexFunction) << "\n";
+            }
+            if (options.l1Insertion != CacheSimulator::INSERT_MRU || options.l2Insertion != CacheSimulator::INSERT_MRU) {
+                std::cout << "LRU insertion: L1=" << insertionPolicyName(options.l1Insertion)
+                          << ", L2=" << insertionPolicyName(options.l2Insertion) << "\n";
+            }
+            if (options.l2Bypass) {
+                std::cout << "L2 dead-block bypass: on\n";
+            }
+            for (size_t level = 1; level <= 2; level++) {
+                if (cacheSimulator->isCompact(level)) {
+                    std::cout << "L" << level << " compact tag store: " << std::fixed << std::setprecision(2)
+                              << cacheSimulator->getTagStoreBytes(level) / (1024.0 * 1024.0) << " MB\n";
+                } else if (cacheSimulator->getEngineKind(level) == CacheSimulator::ENGINE_FULLY_ASSOCIATIVE &&
+                           (level == 1 ? l1_assoc : l2_assoc) > 1) {
+                    std::cout << "L" << level << " fully associative: hashed tag lookup\n";
+                }
             }
         } else {
              std::cout << "Unknown init subcommand: " << tokens[1] << "\n";
         }
     }
     
+    // Parses one trailing "key=value" option of 'init cache'
+    bool parseCacheOption(const std::string& token, CacheSimulator::Options& options) {
+        size_t eq = token.find('=');
+        if (eq == std::string::npos) {
+            std::cout << "Invalid cache option '" << token << "' (expected key=value)\n";
+            return false;
+        }
+        std::string key = token.substr(0, eq);
+        std::string value = token.substr(eq + 1);
+        std::transform(value.begin(), value.end(), value.begin(), ::tolower);
+
+        if (key == "sectors" || key == "l1_sectors" || key == "l2_sectors") {
+            size_t sectors = 0;
+            try {
+                sectors = std::stoull(value);
+            } catch (const std::exception&) {
+                std::cout << "Invalid sector count: " << value << "\n";
+                return false;
+            }
+            if (key != "l2_sectors") options.l1Sectors = sectors;
+            if (key != "l1_sectors") options.l2Sectors = sectors;
+            return true;
+        }
+
+        if (key == "insertion" || key == "l1_insertion" || key == "l2_insertion") {
+            CacheSimulator::InsertionPolicy insertion;
+            if (value == "mru") {
+                insertion = CacheSimulator::INSERT_MRU;
+            } else if (value == "lip") {
+                insertion = CacheSimulator::INSERT_LIP;
+            } else if (value == "bip") {
+                insertion = CacheSimulator::INSERT_BIP;
+            } else {
+                std::cout << "Invalid insertion policy. Use: mru, lip, bip\n";
+                return false;
+            }
+            if (key != "l2_insertion") options.l1Insertion = insertion;
+            if (key != "l1_insertion") options.l2Insertion = insertion;
+            return true;
+        }
+
+        if (key == "l1i") {
+            // <size>:<block>:<assoc>, like the L1 geometry arguments
+            size_t first = value.find(':');
+            size_t second = first == std::string::npos ? first : value.find(':', first + 1);
+            try {
+                if (second == std::string::npos) throw std::invalid_argument("missing field");
+                options.l1iSize = std::stoull(value.substr(0, first));
+                options.l1iBlockSize = std::stoull(value.substr(first + 1, second - first - 1));
+                options.l1iAssociativity = std::stoull(value.substr(second + 1));
+            } catch (const std::exception&) {
+                std::cout << "Invalid L1I geometry '" << value << "' (expected size:block:assoc)\n";
+                return false;
+            }
+            if (options.l1iSize == 0) {
+                std::cout << "L1I size must be non-zero\n";
+                return false;
+            }
+            return true;
+        }
+
+        if (key == "bip_period") {
+            try {
+                options.bipPeriod = std::stoull(value);
+            } catch (const std::exception&) {
+                std::cout << "Invalid BIP period: " << value << "\n";
+                return false;
+            }
+            return true;
+        }
+
+        if (key == "bypass") {
+            if (value == "on") {
+                options.l2Bypass = true;
+            } else if (value == "off") {
+                options.l2Bypass = false;
+            } else {
+                std::cout << "Invalid bypass setting. Use: on, off\n";
+                return false;
+            }
+            return true;
+        }
+
+        if (key == "lfu_aging") {
+            try {
+                options.lfuAgingPeriod = std::stoull(value);
+            } catch (const std::exception&) {
+                std::cout << "Invalid LFU aging period: " << value << "\n";
+                return false;
+            }
+            return true;
+        }
+
+        if (key == "address_bits") {
+            try {
+                options.addressBits = std::stoull(value);
+            } catch (const std::exception&) {
+                std::cout << "Invalid address width: " << value << "\n";
+                return false;
+            }
+            return true;
+        }
+
+        if (key == "engine") {
+            if (value == "auto") {
+                options.specialize = true;
+            } else if (value == "generic") {
+                options.specialize = false;
+            } else if (value == "compact") {
+                options.specialize = true;
+                options.compact = true;
+            } else {
+                std::cout << "Invalid engine. Use: auto, generic, compact\n";
+                return false;
+            }
+            return true;
+        }
+
+        if (key == "index") {
+            if (value == "modulo") {
+                options.indexFunction = CacheSimulator::INDEX_MODULO;
+            } else if (value == "xor") {
+                options.indexFunction = CacheSimulator::INDEX_XOR;
+            } else if (value == "skewed") {
+                options.indexFunction = CacheSimulator::INDEX_SKEWED;
+            } else {
+                std::cout << "Invalid index function. Use: modulo, xor, skewed\n";
+                return false;
+            }
+            return true;
+        }
+
+        std::cout << "Unknown cache option: " << key << "\n";
+        return false;
+    }
+
+    // Parses one trailing "key=value" option of 'init memory'
+    bool parseMemoryOption(const std::string& token, MemoryManager::FreeIndex& index,
+                           MemoryManager::HeaderLayout& layout, size_t& pageSize) {
+        size_t eq = token.find('=');
+        if (eq == std::string::npos) {
+            std::cout << "Invalid memory option '" << token << "' (expected key=value)\n";
+            return false;
+        }
+        std::string key = token.substr(0, eq);
+        std::string value = token.substr(eq + 1);
+        std::transform(value.begin(), value.end(), value.begin(), ::tolower);
+
+        if (key == "index") {
+            if (value == "list") {
+                index = MemoryManager::FREE_LIST;
+            } else if (value == "tree") {
+                index = MemoryManager::SIZE_TREE;
+            } else if (value == "inband") {
+                index = MemoryManager::IN_BAND;
+            } else {
+                std::cout << "Invalid free index. Use: list, tree, inband\n";
+                return false;
+            }
+            return true;
+        }
+
+        if (key == "header") {
+            if (value == "standard") {
+                layout = MemoryManager::STANDARD_HEADER;
+            } else if (value == "compact") {
+                layout = MemoryManager::COMPACT_HEADER;
+            } else {
+                std::cout << "Invalid header layout. Use: standard, compact\n";
+                return false;
+            }
+            return true;
+        }
+
+        if (key == "page") {
+            size_t size = 0;
+            try {
+                size = std::stoull(value);
+            } catch (const std::exception&) {
+            }
+            if (!MemoryManager::isValidPageSize(size)) {
+                std::cout << "Invalid page size. Use a power of two of at least " << PageMap::GRANULE << " bytes\n";
+                return false;
+            }
+            pageSize = size;
+            return true;
+        }
+
+        std::cout << "Unknown memory option: " << key << "\n";
+        return false;
+    }
+
+    static const char* indexName(MemoryManager::FreeIndex index) {
+        switch (index) {
+            case MemoryManager::FREE_LIST: return "list";
+            case MemoryManager::SIZE_TREE: return "tree";
+            case MemoryManager::IN_BAND: return "inband";
+        }
+        return "unknown";
+    }
+
+    static const char* indexFunctionName(CacheSimulator::IndexFunction fn) {
+        switch (fn) {
+            case CacheSimulator::INDEX_MODULO: return "modulo";
+            case CacheSimulator::INDEX_XOR: return "xor";
+            case CacheSimulator::INDEX_SKEWED: return "skewed";
+        }
+        return "unknown";
+    }
+
+    static const char* insertionPolicyName(CacheSimulator::InsertionPolicy insertion) {
+        switch (insertion) {
+            case CacheSimulator::INSERT_MRU: return "mru";
+            case CacheSimulator::INSERT_LIP: return "lip";
+            case CacheSimulator::INSERT_BIP: return "bip";
+        }
+        return "unknown";
+    }
+    
     void handleSet(const std::vector<std::string>& tokens) {
         if (!initialized) {
             std::cout << "Error: Memory not initialized. Use 'init memory <size>' first.\n";
@@ -178,7 +633,7 @@ private:
         }
         
         if (tokens.size() >= 3 && tokens[1] == "cache_policy") {
-            // set cache_policy <fifo|lru|lfu>
+            // set cache_policy <fifo|lru|lfu|lfu_da|hawkeye>
             std::string policyName = tokens[2];
             std::transform(policyName.begin(), policyName.end(), policyName.begin(), ::tolower);
             
@@ -189,8 +644,12 @@ private:
                 policy = CacheSimulator::LRU;
             } else if (policyName == "lfu") {
                 policy = CacheSimulator::LFU;
+            } else if (policyName == "lfu_da") {
+                policy = CacheSimulator::LFU_DA;
+            } else if (policyName == "hawkeye") {
+                policy = CacheSimulator::HAWKEYE;
             } else {
-                std::cout << "Invalid policy. Use: fifo, lru, or lfu\n";
+                std::cout << "Invalid policy. Use: fifo, lru, lfu, lfu_da, or hawkeye\n";
                 return;
             }
             
@@ -203,10 +662,20 @@ private:
             return;
         }
 
+        if (tokens.size() >= 3 && tokens[1] == "purge") {
+            handleSetPurge(tokens);
+            return;
+        }
+
+        if (tokens.size() >= 3 && tokens[1] == "oom") {
+            handleSetOom(tokens);
+            return;
+        }
+
         if (tokens.size() < 3 || tokens[1] != "allocator") {
-            std::cout << "Usage: set allocator <strategy> OR set cache_policy <policy>\n";
+            std::cout << "Usage: set allocator <strategy> OR set cache_policy <policy> OR set purge <opts>\n";
             std::cout << "Strategies: first_fit, best_fit, worst_fit\n";
-            std::cout << "Policies: fifo, lru, lfu\n";
+            std::cout << "Policies: fifo, lru, lfu, lfu_da, hawkeye\n";
             return;
         }
         
@@ -229,24 +698,194 @@ private:
         std::cout << "Allocation strategy set to: " << strategy << "\n";
     }
     
+    // set purge off | now | dirty=<ops> [muzzy=<ops>] [lazy_cost=N] [purge_cost=N] [refault_cost=N]
+    void handleSetPurge(const std::vector<std::string>& tokens) {
+        if (tokens[2] == "now") {
+            uint64_t before = memoryManager->getPurgeStats().purges;
+            memoryManager->purgeNow();
+            std::cout << "Purged " << memoryManager->getPurgeStats().purges - before << " pages\n";
+            return;
+        }
+
+        MemoryManager::PurgeConfig config = memoryManager->getPurgeConfig();
+        if (tokens[2] == "off") {
+            config.dirtyDecay = MemoryManager::NEVER;
+        } else {
+            for (size_t i = 2; i < tokens.size(); i++) {
+                size_t eq = tokens[i].find('=');
+                std::string key = tokens[i].substr(0, eq);
+                std::string value = eq == std::string::npos ? "" : tokens[i].substr(eq + 1);
+                uint64_t number = MemoryManager::NEVER;
+                if (value != "never") {
+                    try {
+                        number = std::stoull(value);
+                    } catch (const std::exception&) {
+                        std::cout << "Invalid purge option '" << tokens[i] << "' (expected key=<number>)\n";
+                        return;
+                    }
+                }
+                if (key == "dirty") {
+                    config.dirtyDecay = number;
+                } else if (key == "muzzy") {
+                    config.muzzyDecay = number;
+                } else if (key == "lazy_cost" && number != MemoryManager::NEVER) {
+                    config.lazyPurgeCost = number;
+                } else if (key == "purge_cost" && number != MemoryManager::NEVER) {
+                    config.purgeCost = number;
+                } else if (key == "refault_cost" && number != MemoryManager::NEVER) {
+                    config.refaultCost = number;
+                } else {
+                    std::cout << "Unknown purge option: " << tokens[i] << "\n";
+                    std::cout << "Options: dirty=<ops>|never, muzzy=<ops>|never, lazy_cost=, purge_cost=, refault_cost=\n";
+                    return;
+                }
+            }
+        }
+        memoryManager->setPurgeConfig(config);
+
+        if (config.dirtyDecay == MemoryManager::NEVER) {
+            std::cout << "Purging disabled\n";
+            return;
+        }
+        std::cout << "Purging " << memoryManager->getPageSize() << "-byte pages: dirty decay "
+                  << config.dirtyDecay << " ops, muzzy decay ";
+        if (config.muzzyDecay == MemoryManager::NEVER) {
+            std::cout << "never";
+        } else {
+            std::cout << config.muzzyDecay << " ops";
+        }
+        std::cout << " (costs: lazy " << config.lazyPurgeCost << ", purge " << config.purgeCost
+                  << ", refault " << config.refaultCost << " cycles/page)\n";
+    }
+
+    // set oom off | [flush=on|off] [reclaim=on|off] [compact=on|off] [grow=<limit>|off] [defer=<n>]
+    //               [flush_cost=N] [reclaim_cost=N] [compact_block_cost=N] [compact_kib_cost=N] [grow_cost=N]
+    void handleSetOom(const std::vector<std::string>& tokens) {
+        MemoryManager::OomPolicy policy = memoryManager->getOomPolicy();
+        size_t defer = memoryManager->getDeferredFreeCapacity();
+        if (tokens[2] == "off") {
+            policy = MemoryManager::OomPolicy();
+            defer = 0;
+        } else {
+            for (size_t i = 2; i < tokens.size(); i++) {
+                size_t eq = tokens[i].find('=');
+                std::string key = tokens[i].substr(0, eq);
+                std::string value = eq == std::string::npos ? "" : tokens[i].substr(eq + 1);
+                std::transform(value.begin(), value.end(), value.begin(), ::tolower);
+                bool on = value == "on";
+                bool flag = on || value == "off";
+                uint64_t number = 0;
+                if (!flag) {
+                    try {
+                        number = std::stoull(value);
+                    } catch (const std::exception&) {
+                        std::cout << "Invalid oom option '" << tokens[i] << "' (expected key=on|off or key=<number>)\n";
+                        return;
+                    }
+                }
+                if (key == "flush" && flag) {
+                    policy.flushDeferred = on;
+                } else if (key == "reclaim" && flag) {
+                    policy.reclaim = on;
+                } else if (key == "compact" && flag) {
+                    policy.compact = on;
+                } else if (key == "grow" && (value == "off" || !flag)) {
+                    policy.growLimit = number;
+                } else if (key == "defer" && !flag) {
+                    defer = number;
+                } else if (key == "flush_cost" && !flag) {
+                    policy.flushCost = number;
+                } else if (key == "reclaim_cost" && !flag) {
+                    policy.reclaimCost = number;
+                } else if (key == "compact_block_cost" && !flag) {
+                    policy.compactBlockCost = number;
+                } else if (key == "compact_kib_cost" && !flag) {
+                    policy.compactKiBCost = number;
+                } else if (key == "grow_cost" && !flag) {
+                    policy.growCost = number;
+                } else {
+                    std::cout << "Unknown oom option: " << tokens[i] << "\n";
+                    std::cout << "Options: flush=, reclaim=, compact= (on|off), grow=<limit>|off, defer=<n>, *_cost=<cycles>\n";
+                    return;
+                }
+            }
+        }
+
+        if (policy.growLimit != 0 && policy.growLimit <= memoryManager->getTotalMemory()) {
+            std::cout << "Growth limit must be larger than the heap (" << memoryManager->getTotalMemory() << " bytes)\n";
+            return;
+        }
+        if (policy.growLimit > MemoryManager::getMaxHeapSize(memoryManager->getHeaderLayout())) {
+            std::cout << "Growth limit exceeds the " << MemoryManager::getMaxHeapSize(memoryManager->getHeaderLayout())
+                      << "-byte limit of the compact header\n";
+            return;
+        }
+        if (!memoryManager->setOomPolicy(policy)) {
+            std::cout << "Heap growth beyond the reserved size must be enabled before the first allocation\n";
+            return;
+        }
+        memoryManager->setDeferredFrees(defer);
+
+        std::cout << "On allocation failure:";
+        if (policy.flushDeferred) std::cout << " flush deferred frees (" << policy.flushCost << " cycles each),";
+        if (policy.reclaim) std::cout << " reclaim cached blocks (" << policy.reclaimCost << " cycles),";
+        if (policy.compact) {
+            std::cout << " compact (" << policy.compactBlockCost << " cycles/block + "
+                      << policy.compactKiBCost << " cycles/KiB),";
+        }
+        if (policy.growLimit != 0) std::cout << " grow up to " << policy.growLimit << " bytes (" << policy.growCost << " cycles),";
+        if (!policy.flushDeferred && !policy.reclaim && !policy.compact && policy.growLimit == 0) std::cout << " fail,";
+        std::cout << " deferred frees: " << (defer == 0 ? std::string("off") : "batches of " + std::to_string(defer)) << "\n";
+    }
+
+    // Reclaim callback: frees cached blocks, oldest first, until `size`
+    // bytes have been freed or none are left
+    size_t reclaimCachedBlocks(size_t size) {
+        size_t freed = 0;
+        while (freed < size && !cachedBlocks.empty()) {
+            size_t blockId = cachedBlocks.front();
+            cachedBlocks.pop_front();
+            auto it = blockIdToAddress.find(blockId);
+            if (it == blockIdToAddress.end()) continue;
+            size_t bytes = memoryManager->getBlockInfo(it->second).size;
+            if (!memoryManager->deallocate(it->second)) continue;
+            freed += bytes;
+            addressToBlockId.erase(it->second);
+            blockIdToAddress.erase(it);
+            std::cout << "  Reclaimed cached block " << blockId << " (" << bytes << " bytes)\n";
+        }
+        return freed;
+    }
+
     void handleMalloc(const std::vector<std::string>& tokens) {
         if (!initialized) {
             std::cout << "Error: Memory not initialized. Use 'init memory <size>' first.\n";
             return;
         }
         
-        if (tokens.size() < 2) {
-            std::cout << "Usage: malloc <size>\n";
+        if (tokens.size() < 2 || (tokens.size() > 2 && tokens[2] != "cached")) {
+            std::cout << "Usage: malloc <size> [cached]\n";
             return;
         }
         
         size_t size = std::stoull(tokens[1]);
+        const MemoryManager::OomStats& oom = memoryManager->getOomStats();
+        uint64_t pressureBefore = oom.pressureEvents;
+        uint64_t cyclesBefore = oom.recoveryCycles;
         void* ptr = memoryManager->allocate(size);
+        if (oom.pressureEvents != pressureBefore) {
+            std::cout << "  Memory pressure: " << (oom.lastStep ? std::string("recovered by ") + oom.lastStep
+                                                                 : std::string("recovery failed"))
+                      << " (+" << oom.recoveryCycles - cyclesBefore << " cycles)\n";
+        }
         
         if (ptr != nullptr) {
             size_t blockId = nextBlockId++;
             blockIdToAddress[blockId] = ptr;
             addressToBlockId[ptr] = blockId;
+            if (tokens.size() > 2) {
+                cachedBlocks.push_back(blockId);
+            }
             
             statsManager->logMemoryAllocation(size, true);
             std::cout << "Allocated block id=" << blockId << " at address=0x" 
@@ -257,6 +896,11 @@ private:
         }
     }
     
+    // With deferred frees, a free that did not fill the queue only queued the block
+    const char* freedText() const {
+        return memoryManager->getDeferredFreeCount() > 0 ? " queued (deferred free)" : " freed and merged";
+    }
+
     void handleFree(const std::vector<std::string>& tokens) {
         if (!initialized) {
             std::cout << "Error: Memory not initialized.\n";
@@ -283,12 +927,12 @@ private:
                     size_t blockId = it->second;
                     blockIdToAddress.erase(blockId);
                     addressToBlockId.erase(ptr);
-                    std::cout << "Block " << blockId << " freed and merged\n";
+                    std::cout << "Block " << blockId << freedText() << "\n";
                 }
             } else {
                 success = memoryManager->deallocate(ptr);
                 if (success) {
-                    std::cout << "Address 0x" << std::hex << addr << std::dec << " freed and merged\n";
+                    std::cout << "Address 0x" << std::hex << addr << std::dec << freedText() << "\n";
                 }
             }
         } else {
@@ -300,7 +944,7 @@ private:
                 if (success) {
                     addressToBlockId.erase(it->second);
                     blockIdToAddress.erase(blockId);
-                    std::cout << "Block " << blockId << " freed and merged\n";
+                    std::cout << "Block " << blockId << freedText() << "\n";
                 }
             } else {
                 std::cout << "Block ID " << blockId << " not found\n";
@@ -312,19 +956,179 @@ private:
         }
     }
     
+    static std::string handleText(MemoryManager::Handle handle) {
+        std::ostringstream out;
+        out << "0x" << std::hex << std::setw(8) << std::setfill('0') << handle;
+        return out.str();
+    }
+
+    void handleHandle(const std::vector<std::string>& tokens) {
+        if (!initialized) {
+            std::cout << "Error: Memory not initialized.\n";
+            return;
+        }
+
+        std::string action = tokens.size() == 3 ? tokens[1] : "";
+        if (action != "alloc" && action != "pin" && action != "unpin" && action != "free") {
+            std::cout << "Usage: handle alloc <size> | handle pin|unpin|free <handle>\n";
+            return;
+        }
+
+        if (action == "alloc") {
+            size_t size = std::stoull(tokens[2]);
+            MemoryManager::Handle handle = memoryManager->allocHandle(size);
+            statsManager->logMemoryAllocation(size, handle != MemoryManager::NULL_HANDLE);
+            if (handle == MemoryManager::NULL_HANDLE) {
+                std::cout << "Failed to allocate " << size << " bytes\n";
+                return;
+            }
+            nextBlockId++;  // Handle blocks use up block ids too; keep ours in step with the heap's
+            MemoryManager::BlockInfo info = memoryManager->getHandleInfo(handle);
+            std::cout << "Allocated handle " << handleText(handle) << " (block id=" << info.block_id
+                      << ", " << info.size << " bytes)\n";
+            return;
+        }
+
+        MemoryManager::Handle handle = 0;
+        try {
+            handle = static_cast<MemoryManager::Handle>(std::stoul(tokens[2], nullptr, 0));
+        } catch (const std::exception&) {
+            std::cout << "Invalid handle: " << tokens[2] << "\n";
+            return;
+        }
+
+        if (action == "pin") {
+            void* ptr = memoryManager->pin(handle);
+            if (ptr == nullptr) {
+                std::cout << "Stale handle " << handleText(handle) << "\n";
+                return;
+            }
+            std::cout << "Handle " << handleText(handle) << " pinned at address=0x" << std::hex
+                      << reinterpret_cast<uintptr_t>(ptr) << std::dec << " (pins: "
+                      << memoryManager->getPinCount(handle) << ")\n";
+        } else if (action == "unpin") {
+            if (memoryManager->unpin(handle)) {
+                std::cout << "Handle " << handleText(handle) << " unpinned (pins: "
+                          << memoryManager->getPinCount(handle) << ")\n";
+            } else if (memoryManager->isLiveHandle(handle)) {
+                std::cout << "Handle " << handleText(handle) << " is not pinned\n";
+            } else {
+                std::cout << "Stale handle " << handleText(handle) << "\n";
+            }
+        } else if (memoryManager->freeHandle(handle)) {
+            std::cout << "Handle " << handleText(handle) << freedText() << "\n";
+        } else {
+            std::cout << "Stale handle " << handleText(handle) << "\n";
+        }
+    }
+
     void handleDump(const std::vector<std::string>& tokens) {
         if (!initialized) {
             std::cout << "Error: Memory not initialized.\n";
             return;
         }
         
-        if (tokens.size() < 2 || tokens[1] != "memory") {
-            std::cout << "Usage: dump memory\n";
+        if (tokens.size() < 2 || (tokens[1] != "memory" && tokens[1] != "free" && tokens[1] != "pages" &&
+                                  tokens[1] != "handles")) {
+            std::cout << "Usage: dump memory | dump free | dump pages [page_size] | dump handles\n";
+            return;
+        }
+
+        if (tokens[1] == "handles") {
+            MemoryManager::HandleStats stats = memoryManager->getHandleStats();
+            std::cout << "Handles: " << stats.live << " live, " << stats.pinned << " pinned, "
+                      << stats.slots << " slots, " << stats.relocations << " moved by compaction, "
+                      << stats.staleUses << " stale uses rejected\n";
+            for (MemoryManager::Handle handle : memoryManager->getLiveHandles()) {
+                MemoryManager::BlockInfo info = memoryManager->getHandleInfo(handle);
+                size_t pins = memoryManager->getPinCount(handle);
+                std::cout << "  " << handleText(handle) << " -> block id=" << info.block_id
+                          << " at address=0x" << std::hex << reinterpret_cast<uintptr_t>(info.address) << std::dec
+                          << " (" << info.size << " bytes";
+                if (pins > 0) {
+                    std::cout << ", pinned x" << pins;
+                }
+                std::cout << ")\n";
+            }
+            return;
+        }
+
+        if (tokens[1] == "pages") {
+            size_t pageSize = memoryManager->getPageSize();
+            if (tokens.size() > 2) {
+                try {
+                    pageSize = std::stoull(tokens[2], nullptr, 0);
+                } catch (const std::exception&) {
+                    pageSize = 0;
+                }
+                if (!MemoryManager::isValidPageSize(pageSize)) {
+                    std::cout << "Invalid page size. Use a power of two of at least " << PageMap::GRANULE << " bytes\n";
+                    return;
+                }
+            }
+            MemoryManager::PageStats pages = memoryManager->getPageStats(pageSize);
+            std::cout << "Pages (" << pages.pageSize << " bytes): " << pages.pages << " total, "
+                      << pages.residentPages << " resident, " << pages.livePages << " live, "
+                      << pages.freePages << " free, " << pages.reclaimablePages << " reclaimable\n";
+            std::cout << "Estimated RSS: " << pages.residentBytes << " bytes ("
+                      << std::fixed << std::setprecision(1)
+                      << (memoryManager->getTotalMemory() == 0 ? 0.0
+                          : 100.0 * pages.residentBytes / memoryManager->getTotalMemory())
+                      << "% of heap), live data " << memoryManager->getUsedMemory() << " bytes\n";
+            if (pages.reclaimablePages > 0) {
+                std::cout << "  " << pages.reclaimablePages * pages.pageSize
+                          << " bytes could be returned with madvise\n";
+            }
+
+            MemoryManager::PurgeStats purge = memoryManager->getPurgeStats();
+            if (memoryManager->getPurgeConfig().dirtyDecay != MemoryManager::NEVER || purge.purges > 0) {
+                std::cout << "Purging (" << purge.pageSize << "-byte pages, " << purge.clock << " ops): "
+                          << purge.dirtyPages << " dirty, " << purge.muzzyPages << " muzzy, average "
+                          << std::setprecision(1) << purge.averageResidentPages << " resident\n";
+                std::cout << "  " << purge.lazyPurges << " lazy purges, " << purge.purges << " purges, "
+                          << purge.refaults << " refaults, " << purge.purgeCycles << " cycles\n";
+            }
+            return;
+        }
+
+        if (tokens[1] == "free") {
+            MemoryManager::HeapSnapshot snapshot = memoryManager->getHeapSnapshot();
+            std::cout << "Free blocks: " << snapshot.freeBlocks << " (" << snapshot.freeBytes
+                      << " usable bytes, largest " << snapshot.largestFreeBlock << ")\n";
+            snapshot.freeSizes.print("Free block sizes", "B");
             return;
         }
         
         memoryManager->dumpMemory();
     }
+
+    // Walks the whole heap and checks block boundaries against the block
+    // start bitmap, block tracking and the free index
+    void handleVerify(const std::vector<std::string>& tokens) {
+        if (!initialized) {
+            std::cout << "Error: Memory not initialized.\n";
+            return;
+        }
+        if (tokens.size() < 2 || tokens[1] != "heap") {
+            std::cout << "Usage: verify heap\n";
+            return;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::string> problems = memoryManager->verifyHeap();
+        MemoryManager::HeapSnapshot snapshot = memoryManager->getHeapSnapshot();
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << "Heap " << (problems.empty() ? "OK" : "CORRUPT") << ": " << snapshot.blocks << " blocks ("
+                  << snapshot.usedBlocks << " allocated, " << snapshot.freeBlocks << " free), checked in "
+                  << std::fixed << std::setprecision(2) << ms << " ms\n";
+        for (const std::string& problem : problems) {
+            std::cout << "  " << problem << "\n";
+        }
+        if (snapshot.uncoalescedFree > 0) {
+            std::cout << "  Note: " << snapshot.uncoalescedFree << " free blocks directly follow another free block\n";
+        }
+    }
     
     void handleStats() {
         if (!initialized) {
@@ -355,6 +1159,28 @@ private:
         }
         
         statsManager->printStats();
+
+        const MemoryManager::OomStats& oom = memoryManager->getOomStats();
+        if (oom.pressureEvents > 0) {
+            std::cout << "Memory pressure: " << oom.pressureEvents << " failed first attempts, "
+                      << oom.recovered << " recovered, " << oom.recoveryCycles << " recovery cycles\n";
+            std::cout << "  flush: " << oom.flushes << " (" << oom.flushedFrees << " frees), reclaim: "
+                      << oom.reclaims << " (" << oom.reclaimedBytes << " bytes), compact: " << oom.compactions
+                      << " (" << oom.movedBlocks << " blocks, " << oom.movedBytes << " bytes), grow: "
+                      << oom.grows << " (" << oom.grownBytes << " bytes, heap now "
+                      << memoryManager->getTotalMemory() << ")\n";
+            std::cout << "  cycles by step: flush " << oom.flushCycles << ", reclaim " << oom.reclaimCycles
+                      << ", compact " << oom.compactCycles << ", grow " << oom.growCycles << "\n";
+            oom.latency.print("Recovery latency", "cycles");
+            const Histogram* stepLatency[] = {&oom.flushLatency, &oom.reclaimLatency, &oom.compactLatency,
+                                              &oom.growLatency};
+            const char* stepNames[] = {"flush", "reclaim", "compact", "grow"};
+            for (size_t step = 0; step < 4; step++) {
+                if (stepLatency[step]->getTotalWeight() > 0.0) {
+                    stepLatency[step]->print(std::string("Recovery latency (") + stepNames[step] + ")", "cycles");
+                }
+            }
+        }
         
         if (cacheSimulator) {
             cacheSimulator->printStatistics();
@@ -368,18 +1194,32 @@ private:
         }
         
         if (tokens.size() < 2) {
-            std::cout << "Usage: access <address>\n";
+            std::cout << "Usage: access <address> [r|w|i] [pc=<address>]\n";
             return;
         }
         
         size_t physicalAddress = std::stoull(tokens[1], nullptr, 0);
+        bool isWrite = tokens.size() > 2 && (tokens[2] == "w" || tokens[2] == "W" || tokens[2] == "write");
+        bool isFetch = tokens.size() > 2 && (tokens[2] == "i" || tokens[2] == "I" || tokens[2] == "fetch");
+        uint64_t pc = 0;
+        const std::string& last = tokens.back();
+        if (tokens.size() > 2 && last.compare(0, 3, "pc=") == 0) {
+            try {
+                pc = std::stoull(last.substr(3), nullptr, 0);
+            } catch (const std::exception&) {
+                std::cout << "Invalid PC: " << last << "\n";
+                return;
+            }
+        }
         
         if (cacheSimulator) {
             // Access cache
-            CacheSimulator::CacheAccessReport report = cacheSimulator->access(physicalAddress);
+            CacheSimulator::CacheAccessReport report = isFetch ? cacheSimulator->fetch(physicalAddress)
+                                                               : cacheSimulator->access(physicalAddress, isWrite, pc);
+            const char* l1Name = !cacheSimulator->hasSplitL1() ? "L1" : isFetch ? "L1I" : "L1D";
             
             std::cout << "Physical address 0x" << std::hex << physicalAddress << std::dec << "\n";
-            std::cout << "  L1: " << (report.l1Hit ? "HIT" : "MISS") << "\n";
+            std::cout << "  " << l1Name << ": " << (report.l1Hit ? "HIT" : "MISS") << "\n";
             if (!report.l1Hit) {
                 std::cout << "  L2: " << (report.l2Accessed ? (report.l2Hit ? "HIT" : "MISS") : "-") << "\n";
             }
@@ -400,10 +1240,427 @@ private:
              std::cout << "Cache simulator not initialized.\n";
         }
     }
+
+    void handleAnalyze(const std::vector<std::string>& tokens) {
+        if (tokens.size() < 2) {
+            std::cout << "Usage: analyze <trace_file> [line_bytes] [page_bytes] [window]\n";
+            return;
+        }
+
+        uint64_t lineBytes = 64;
+        uint64_t pageBytes = 4096;
+        size_t window = 10000;
+        try {
+            if (tokens.size() > 2) lineBytes = std::stoull(tokens[2]);
+            if (tokens.size() > 3) pageBytes = std::stoull(tokens[3]);
+            if (tokens.size() > 4) window = std::stoull(tokens[4]);
+        } catch (const std::exception& e) {
+            std::cout << "Error parsing analyze parameters: " << e.what() << "\n";
+            return;
+        }
+        if (lineBytes == 0 || pageBytes == 0 || window == 0) {
+            std::cout << "Line size, page size and window must be non-zero\n";
+            return;
+        }
+
+        TraceReader reader;
+        if (!reader.open(tokens[1])) {
+            std::cout << "Cannot open trace file: " << tokens[1] << "\n";
+            return;
+        }
+
+        // Single streaming pass feeds all four analyses
+        ReuseDistanceAnalyzer lineReuse(lineBytes);
+        ReuseDistanceAnalyzer pageReuse(pageBytes);
+        WorkingSetAnalyzer lineWss(lineBytes, window);
+        WorkingSetAnalyzer pageWss(pageBytes, window);
+
+        TraceRecord record;
+        while (reader.next(record)) {
+            lineReuse.record(record.address);
+            pageReuse.record(record.address);
+            lineWss.record(record.address);
+            pageWss.record(record.address);
+        }
+
+        std::cout << "\n=== Trace Analysis: " << tokens[1] << " ===\n";
+        std::cout << "Records: " << reader.getRecordCount();
+        if (reader.getSkippedLines() > 0) {
+            std::cout << " (" << reader.getSkippedLines() << " unparsable lines skipped)";
+        }
+        std::cout << "\n\n";
+        lineReuse.print("line");
+        std::cout << "\n";
+        pageReuse.print("page");
+        std::cout << "\n";
+        lineWss.print("line");
+        std::cout << "\n";
+        pageWss.print("page");
+        std::cout << "==============================\n\n";
+    }
+
+    void handleEncode(const std::vector<std::string>& tokens) {
+        if (tokens.size() < 3) {
+            std::cout << "Usage: encode <text_trace> <output> [records_per_block]\n";
+            return;
+        }
+
+        size_t blockRecords = TraceCodec::DEFAULT_BLOCK_RECORDS;
+        try {
+            if (tokens.size() > 3) blockRecords = std::stoull(tokens[3]);
+        } catch (const std::exception& e) {
+            std::cout << "Error parsing block size: " << e.what() << "\n";
+            return;
+        }
+        if (blockRecords == 0 || blockRecords > TraceCodec::MAX_BLOCK_RECORDS) {
+            std::cout << "Records per block must be between 1 and " << TraceCodec::MAX_BLOCK_RECORDS << "\n";
+            return;
+        }
+
+        TraceReader reader;
+        if (!reader.open(tokens[1])) {
+            std::cout << "Cannot open trace file: " << tokens[1] << "\n";
+            return;
+        }
+        TraceEncoder encoder(blockRecords);
+        if (!encoder.open(tokens[2])) {
+            std::cout << "Cannot create output file: " << tokens[2] << "\n";
+            return;
+        }
+
+        TraceRecord record;
+        while (reader.next(record)) {
+            encoder.add(record);
+        }
+        if (!encoder.close()) {
+            std::cout << "Error writing " << tokens[2] << "\n";
+            return;
+        }
+
+        std::cout << "Encoded " << encoder.getRecordCount() << " records into " << encoder.getBlockCount()
+                  << " blocks, " << encoder.getBytesWritten() << " bytes";
+        if (encoder.getRecordCount() > 0) {
+            std::cout << " (" << std::fixed << std::setprecision(2)
+                      << static_cast<double>(encoder.getBytesWritten()) / encoder.getRecordCount()
+                      << " bytes/record, " << encoder.getRunCount() << " stride runs)";
+        }
+        std::cout << "\n";
+        if (reader.getSkippedLines() > 0) {
+            std::cout << reader.getSkippedLines() << " unparsable lines skipped\n";
+        }
+    }
+
+    // Feeds a trace through the cache without per-access output. Encoded
+    // traces are decoded one block at a time straight into the access loop.
+    void handleReplay(const std::vector<std::string>& tokens) {
+        if (!initialized || cacheSimulator == nullptr) {
+            std::cout << "System not initialized. Use 'init memory <size>'\n";
+            return;
+        }
+        if (tokens.size() < 2) {
+            std::cout << "Usage: replay <trace_file> [reader=async|sync] [opt=on]\n";
+            return;
+        }
+
+        bool asyncReader = true;
+        bool comparePolicies = false;
+        for (size_t i = 2; i < tokens.size(); i++) {
+            if (tokens[i] == "reader=async") {
+                asyncReader = true;
+            } else if (tokens[i] == "reader=sync") {
+                asyncReader = false;
+            } else if (tokens[i] == "opt=on" || tokens[i] == "opt=off") {
+                comparePolicies = tokens[i] == "opt=on";
+            } else {
+                std::cout << "Unknown replay option: " << tokens[i] << " (use reader=async|sync, opt=on|off)\n";
+                return;
+            }
+        }
+
+        size_t records = 0;
+        size_t startL1Hits = cacheSimulator->getHits(1);
+        size_t startL1Misses = cacheSimulator->getMisses(1);
+        size_t startL1iHits = cacheSimulator->getHits(CacheSimulator::L1I_LEVEL);
+        size_t startL1iMisses = cacheSimulator->getMisses(CacheSimulator::L1I_LEVEL);
+        // OPT needs the whole trace: keep the references for the offline comparison
+        std::vector<uint64_t> addresses;
+        std::vector<bool> fetches;
+        auto replayRecord = [this, comparePolicies, &addresses, &fetches](const TraceRecord& record) {
+            if (record.is_fetch) {
+                cacheSimulator->fetch(record.address);
+            } else {
+                cacheSimulator->access(record.address, record.is_write, record.pc);
+            }
+            if (comparePolicies) {
+                addresses.push_back(record.address);
+                fetches.push_back(record.is_fetch);
+            }
+        };
+        auto start = std::chrono::steady_clock::now();
+        cacheSimulator->setEventLogging(false);
+
+        if (TraceCodec::isEncodedTrace(tokens[1]) && asyncReader) {
+            // Reading and decoding overlap with simulation on their own threads
+            TracePipeline pipeline;
+            if (!pipeline.open(tokens[1])) {
+                std::cout << "Cannot open trace file: " << tokens[1] << "\n";
+                cacheSimulator->setEventLogging(true);
+                return;
+            }
+            while (const std::vector<TraceRecord>* chunk = pipeline.next()) {
+                for (const TraceRecord& record : *chunk) {
+                    replayRecord(record);
+                }
+            }
+            records = pipeline.getRecordCount();
+            if (pipeline.hasError()) {
+                std::cout << "Replay stopped: " << pipeline.getError() << "\n";
+            }
+        } else if (TraceCodec::isEncodedTrace(tokens[1])) {
+            TraceDecoder decoder;
+            if (!decoder.open(tokens[1])) {
+                std::cout << "Cannot open trace file: " << tokens[1] << "\n";
+                cacheSimulator->setEventLogging(true);
+                return;
+            }
+            std::vector<TraceRecord> chunk;
+            while (decoder.nextChunk(chunk)) {
+                for (const TraceRecord& record : chunk) {
+                    replayRecord(record);
+                }
+            }
+            records = decoder.getRecordCount();
+            if (decoder.hasError()) {
+                std::cout << "Replay stopped: " << decoder.getError() << "\n";
+            }
+        } else {
+            TraceReader reader;
+            if (!reader.open(tokens[1])) {
+                std::cout << "Cannot open trace file: " << tokens[1] << "\n";
+                cacheSimulator->setEventLogging(true);
+                return;
+            }
+            TraceRecord record;
+            while (reader.next(record)) {
+                replayRecord(record);
+            }
+            records = reader.getRecordCount();
+        }
+
+        cacheSimulator->setEventLogging(true);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        statsManager->setCacheStats(
+            cacheSimulator->getHits(1),
+            cacheSimulator->getMisses(1),
+            cacheSimulator->getHits(2),
+            cacheSimulator->getMisses(2)
+        );
+
+        size_t l1Hits = cacheSimulator->getHits(1) - startL1Hits;
+        size_t l1Misses = cacheSimulator->getMisses(1) - startL1Misses;
+        size_t l1iHits = cacheSimulator->getHits(CacheSimulator::L1I_LEVEL) - startL1iHits;
+        size_t l1iMisses = cacheSimulator->getMisses(CacheSimulator::L1I_LEVEL) - startL1iMisses;
+        auto ratio = [](size_t hits, size_t misses) {
+            return hits + misses == 0 ? 0.0 : 100.0 * hits / (hits + misses);
+        };
+        std::cout << "Replayed " << records << " accesses";
+        if (records > 0) {
+            std::cout << std::fixed << std::setprecision(2);
+            if (cacheSimulator->hasSplitL1()) {
+                std::cout << " (L1D hit ratio " << ratio(l1Hits, l1Misses) << "%, L1I hit ratio "
+                          << ratio(l1iHits, l1iMisses) << "%, ";
+            } else {
+                std::cout << " (L1 hit ratio " << ratio(l1Hits, l1Misses) << "%, ";
+            }
+            std::cout << std::setprecision(1) << records / seconds / 1e6 << "M accesses/s)" << std::setprecision(2);
+        }
+        std::cout << "\n";
+
+        if (comparePolicies) {
+            std::string error;
+            if (!cacheSimulator->comparePolicies(addresses, fetches, error)) {
+                std::cout << "Policy comparison skipped: " << error << "\n";
+                return;
+            }
+            const CacheSimulator::PolicyComparisonResult& result = cacheSimulator->getPolicyComparison();
+            std::cout << "Offline memory reads:";
+            for (size_t p = 0; p < PolicyComparison::POLICY_COUNT; p++) {
+                std::cout << (p == 0 ? " " : ", ")
+                          << PolicyComparison::policyName(static_cast<PolicyComparison::Policy>(p))
+                          << " " << result.l2Misses[p];
+            }
+            std::cout << " (see stats)\n";
+        }
+    }
 };
 
-int main() {
+static void printUsage() {
+    std::cout << "Usage: MemoryManagementSimulator                      (interactive)\n";
+    std::cout << "       MemoryManagementSimulator --stream [--memory=<bytes>] [--interval=<records>]\n";
+    std::cout << "         Reads 16-byte binary access/allocation records from stdin\n";
+    std::cout << "       MemoryManagementSimulator --server=<socket_path>\n";
+    std::cout << "         Serves batched binary command frames on a Unix domain socket\n";
+    std::cout << "       MemoryManagementSimulator --experiments=<manifest> [--jobs=<n>] [--cache-dir=<dir>]\n";
+    std::cout << "                                 [--csv=<file>] [--no-cache]\n";
+    std::cout << "         Runs a manifest of experiment points in parallel, reusing cached results\n";
+}
+
+// --experiments mode: parses the manifest, runs it and prints one row per
+// point in manifest order (so output does not depend on thread scheduling)
+static int runExperiments(int argc, char* argv[]) {
+    std::string manifest = std::string(argv[1]).substr(14);
+    std::string cacheDir = ".memsim-cache";
+    std::string csvPath;
+    size_t jobs = 0;
+    bool useCache = true;
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        try {
+            if (arg.compare(0, 7, "--jobs=") == 0) {
+                jobs = std::stoull(arg.substr(7));
+            } else if (arg.compare(0, 12, "--cache-dir=") == 0) {
+                cacheDir = arg.substr(12);
+            } else if (arg.compare(0, 6, "--csv=") == 0) {
+                csvPath = arg.substr(6);
+            } else if (arg == "--no-cache") {
+                useCache = false;
+            } else {
+                printUsage();
+                return 1;
+            }
+        } catch (const std::exception&) {
+            std::cout << "Invalid value in " << arg << "\n";
+            return 1;
+        }
+    }
+
+    std::vector<ExperimentPoint> points;
+    std::string error;
+    if (!parseManifest(manifest, points, error)) {
+        std::cout << "Manifest error: " << error << "\n";
+        return 1;
+    }
+
+    ExperimentRunner runner(cacheDir, jobs, useCache);
+    auto start = std::chrono::steady_clock::now();
+    std::vector<ExperimentResult> results = runner.run(points);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    auto ratio = [](uint64_t hits, uint64_t misses) {
+        return hits + misses == 0 ? 0.0 : 100.0 * hits / (hits + misses);
+    };
+
+    std::ofstream csv;
+    if (!csvPath.empty()) {
+        csv.open(csvPath);
+        if (!csv) {
+            std::cout << "Cannot write " << csvPath << "\n";
+            return 1;
+        }
+        csv << "name,key,status,accesses,l1_hits,l1_misses,l2_hits,l2_misses,memory_read_bytes,"
+               "memory_write_bytes,mallocs,failed_mallocs,frees,used_bytes,internal_fragmentation,"
+               "external_fragmentation,l1i_hits,l1i_misses,rss_bytes,"
+               "avg_rss_bytes,purged_pages,refaults,purge_cycles\n";
+    }
+
+    size_t failed = 0;
+    std::cout << std::left << std::setw(16) << "Point" << std::setw(8) << "Status"
+              << std::right << std::setw(12) << "Accesses" << std::setw(9) << "L1 hit%"
+              << std::setw(9) << "L2 hit%" << std::setw(10) << "Mallocs" << std::setw(8) << "Failed"
+              << std::setw(10) << "Ext frag%" << "  Key\n";
+    for (size_t i = 0; i < points.size(); i++) {
+        const ExperimentResult& result = results[i];
+        std::string status = !result.error.empty() ? "error" : result.cached ? "cached" : "run";
+        std::cout << std::left << std::setw(16) << points[i].name << std::setw(8) << status << std::right;
+        if (!result.error.empty()) {
+            std::cout << "  line " << points[i].line << ": " << result.error << "\n";
+            failed++;
+            continue;
+        }
+        std::cout << std::fixed << std::setprecision(2)
+                  << std::setw(12) << result.accesses
+                  << std::setw(9) << ratio(result.l1Hits, result.l1Misses)
+                  << std::setw(9) << ratio(result.l2Hits, result.l2Misses)
+                  << std::setw(10) << result.mallocs << std::setw(8) << result.failedMallocs
+                  << std::setw(10) << result.externalFragmentation << "  " << result.key << "\n";
+        if (csv.is_open()) {
+            csv << points[i].name << "," << result.key << "," << status << "," << result.accesses << ","
+                << result.l1Hits << "," << result.l1Misses << "," << result.l2Hits << "," << result.l2Misses << ","
+                << result.memoryReadBytes << "," << result.memoryWriteBytes << "," << result.mallocs << ","
+                << result.failedMallocs << "," << result.frees << "," << result.usedBytes << ","
+                << std::setprecision(4) << result.internalFragmentation << ","
+                << result.externalFragmentation << std::setprecision(2) << ","
+                << result.l1iHits << "," << result.l1iMisses << "," << result.residentBytes << ","
+                << result.averageResidentBytes << "," << result.purgedPages << "," << result.refaults << ","
+                << result.purgeCycles << "\n";
+        }
+    }
+
+    std::cout << points.size() << " points: " << runner.getCachedCount() << " cached, "
+              << runner.getSimulatedCount() << " simulated";
+    if (failed > 0) {
+        std::cout << ", " << failed << " failed";
+    }
+    std::cout << " (" << std::setprecision(2) << seconds << "s)\n";
+    return failed == 0 ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
     MemorySimulatorCLI cli;
+
+    if (argc > 1 && std::string(argv[1]).compare(0, 9, "--server=") == 0) {
+        if (argc > 2) {
+            printUsage();
+            return 1;
+        }
+        SimServer server(std::string(argv[1]).substr(9));
+        if (!server.start()) {
+            std::cout << "Cannot start server: " << server.getError() << "\n";
+            return 1;
+        }
+        std::cout << "Listening on " << std::string(argv[1]).substr(9) << std::endl;
+        server.run();
+        return 0;
+    }
+
+    if (argc > 1 && std::string(argv[1]).compare(0, 14, "--experiments=") == 0) {
+        return runExperiments(argc, argv);
+    }
+
+    if (argc > 1) {
+        if (std::string(argv[1]) != "--stream") {
+            printUsage();
+            return 1;
+        }
+
+        size_t memorySize = 1024 * 1024;
+        size_t interval = 1000000;
+        for (int i = 2; i < argc; i++) {
+            std::string arg = argv[i];
+            try {
+                if (arg.compare(0, 9, "--memory=") == 0) {
+                    memorySize = std::stoull(arg.substr(9));
+                } else if (arg.compare(0, 11, "--interval=") == 0) {
+                    interval = std::stoull(arg.substr(11));
+                } else {
+                    printUsage();
+                    return 1;
+                }
+            } catch (const std::exception&) {
+                std::cout << "Invalid value in " << arg << "\n";
+                return 1;
+            }
+        }
+        if (memorySize == 0 || interval == 0) {
+            std::cout << "Memory size and interval must be non-zero\n";
+            return 1;
+        }
+
+        cli.runStream(memorySize, interval);
+        return 0;
+    }
+
     cli.run();
     return 0;
 }
@@ -0,0 +1,501 @@
+// CPython extension 'memsim' over the libmemsim C API.
+//
+// Batch methods take any object exporting the buffer protocol (numpy arrays,
+// array.array, memoryview, bytes) and read it in place; results are written
+// to a caller-supplied buffer or to a new bytearray, which numpy wraps
+// without a copy (np.frombuffer). The GIL is released while a batch runs.
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include <cstring>
+#include "../api/memsim.h"
+
+namespace {
+
+// A handle must not run two batches at once (memsim.h); 'busy' is only read
+// and written with the GIL held, so it is enough to reject the second caller.
+struct CacheObject {
+    PyObject_HEAD
+    memsim_cache* cache;
+    bool busy;
+};
+
+struct HeapObject {
+    PyObject_HEAD
+    memsim_heap* heap;
+    bool busy;
+};
+
+// ---------------------------------------------------------------------------
+// Buffer helpers
+// ---------------------------------------------------------------------------
+
+// Integer format codes, with an optional byte-order/alignment prefix
+bool isIntegerFormat(const char* format) {
+    if (format == nullptr) return false;
+    if (*format == '@' || *format == '=' || *format == '<') format++;
+    return format[0] != '\0' && format[1] == '\0' && std::strchr("bBhHiIlLqQnN?", format[0]) != nullptr;
+}
+
+// Gets a 1-D contiguous buffer of 'itemsize'-byte integers
+bool getVector(PyObject* object, Py_buffer* view, Py_ssize_t itemsize, const char* name) {
+    if (PyObject_GetBuffer(object, view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) != 0) {
+        return false;
+    }
+    if (view->ndim > 1 || view->itemsize != itemsize || !isIntegerFormat(view->format)) {
+        PyErr_Format(PyExc_TypeError, "%s must be a 1-D contiguous buffer of %zd-byte integers",
+                     name, itemsize);
+        PyBuffer_Release(view);
+        return false;
+    }
+    return true;
+}
+
+Py_ssize_t itemCount(const Py_buffer& view) {
+    return view.len / view.itemsize;
+}
+
+// Uses 'out' if given (checked against count), otherwise allocates a bytearray
+PyObject* resultBuffer(PyObject* out, Py_buffer* view, Py_ssize_t count, Py_ssize_t itemsize, const char* name) {
+    PyObject* result = out;
+    if (result == nullptr || result == Py_None) {
+        result = PyByteArray_FromStringAndSize(nullptr, count * itemsize);
+        if (result == nullptr) return nullptr;
+    } else {
+        Py_INCREF(result);
+    }
+    if (PyObject_GetBuffer(result, view, PyBUF_C_CONTIGUOUS | PyBUF_WRITABLE) != 0) {
+        Py_DECREF(result);
+        return nullptr;
+    }
+    if (view->len < count * itemsize) {
+        PyErr_Format(PyExc_ValueError, "%s holds %zd bytes, %zd needed", name, view->len, count * itemsize);
+        PyBuffer_Release(view);
+        Py_DECREF(result);
+        return nullptr;
+    }
+    return result;
+}
+
+// Casts a method implementation to the PyCFunction slot type
+template <typename Function>
+PyCFunction method(Function function) {
+    return reinterpret_cast<PyCFunction>(reinterpret_cast<void (*)(void)>(function));
+}
+
+bool claim(bool& busy) {
+    if (busy) {
+        PyErr_SetString(PyExc_RuntimeError, "object is in use by another thread");
+        return false;
+    }
+    busy = true;
+    return true;
+}
+
+// Accepts the enum value or its name
+bool parseChoice(PyObject* value, const char* const names[], int count, int* result, const char* what) {
+    if (PyLong_Check(value)) {
+        long number = PyLong_AsLong(value);
+        if (number >= 0 && number < count) {
+            *result = static_cast<int>(number);
+            return true;
+        }
+    } else if (PyUnicode_Check(value)) {
+        const char* text = PyUnicode_AsUTF8(value);
+        for (int i = 0; text != nullptr && i < count; i++) {
+            if (std::strcmp(text, names[i]) == 0) {
+                *result = i;
+                return true;
+            }
+        }
+    }
+    if (!PyErr_Occurred()) {
+        PyErr_Format(PyExc_ValueError, "unknown %s", what);
+    }
+    return false;
+}
+
+const char* const POLICY_NAMES[] = {"fifo", "lru", "lfu", "lfu_da", "hawkeye"};
+const char* const STRATEGY_NAMES[] = {"first", "best", "worst"};
+
+PyObject* raiseStatus(int status) {
+    PyObject* type = status == MEMSIM_ERR_ARGUMENT ? PyExc_ValueError :
+                     status == MEMSIM_ERR_NO_MEMORY ? PyExc_MemoryError : PyExc_RuntimeError;
+    PyErr_SetString(type, memsim_status_string(status));
+    return nullptr;
+}
+
+// ---------------------------------------------------------------------------
+// Cache
+// ---------------------------------------------------------------------------
+
+int Cache_init(CacheObject* self, PyObject* args, PyObject* kwargs) {
+    static const char* keywords[] = {"l1_size", "l1_block", "l1_assoc", "l2_size", "l2_block", "l2_assoc",
+                                     "policy", "l1_sectors", "l2_sectors", nullptr};
+    memsim_cache_config config;
+    memsim_cache_config_init(&config);
+    unsigned long long l1[3] = {config.l1_size, config.l1_block_size, config.l1_associativity};
+    unsigned long long l2[3] = {config.l2_size, config.l2_block_size, config.l2_associativity};
+    PyObject* policy = nullptr;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|KKKKKKOii", const_cast<char**>(keywords),
+                                     &l1[0], &l1[1], &l1[2], &l2[0], &l2[1], &l2[2], &policy,
+                                     &config.l1_sectors, &config.l2_sectors)) {
+        return -1;
+    }
+    config.l1_size = l1[0];
+    config.l1_block_size = l1[1];
+    config.l1_associativity = l1[2];
+    config.l2_size = l2[0];
+    config.l2_block_size = l2[1];
+    config.l2_associativity = l2[2];
+    if (policy != nullptr && !parseChoice(policy, POLICY_NAMES, 5, &config.policy, "policy")) {
+        return -1;
+    }
+
+    if (self->busy) {
+        PyErr_SetString(PyExc_RuntimeError, "object is in use by another thread");
+        return -1;
+    }
+    memsim_cache* cache = nullptr;
+    int status = memsim_cache_create(&config, &cache);
+    if (status != MEMSIM_OK) {
+        raiseStatus(status);
+        return -1;
+    }
+    memsim_cache_destroy(self->cache);
+    self->cache = cache;
+    return 0;
+}
+
+void Cache_dealloc(CacheObject* self) {
+    PyTypeObject* type = Py_TYPE(self);
+    memsim_cache_destroy(self->cache);
+    type->tp_free(reinterpret_cast<PyObject*>(self));
+    Py_DECREF(type);  // Instances of heap types own a type reference
+}
+
+bool checkCache(CacheObject* self) {
+    if (self->cache == nullptr) {
+        PyErr_SetString(PyExc_RuntimeError, "Cache was not initialized");
+        return false;
+    }
+    return claim(self->busy);
+}
+
+PyObject* Cache_access(CacheObject* self, PyObject* args) {
+    unsigned long long address;
+    int isWrite = 0;
+    if (!PyArg_ParseTuple(args, "K|p", &address, &isWrite) || !checkCache(self)) {
+        return nullptr;
+    }
+    int result = memsim_cache_access(self->cache, address, isWrite);
+    self->busy = false;
+    return result < 0 ? raiseStatus(result) : PyLong_FromLong(result);
+}
+
+PyObject* Cache_access_batch(CacheObject* self, PyObject* args, PyObject* kwargs) {
+    static const char* keywords[] = {"addresses", "is_write", "out", nullptr};
+    PyObject* addressObject;
+    PyObject* writeObject = Py_None;
+    PyObject* out = Py_None;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|OO", const_cast<char**>(keywords),
+                                     &addressObject, &writeObject, &out)) {
+        return nullptr;
+    }
+
+    Py_buffer addresses, writes, results;
+    if (!getVector(addressObject, &addresses, 8, "addresses")) {
+        return nullptr;
+    }
+    Py_ssize_t count = itemCount(addresses);
+    bool haveWrites = writeObject != Py_None;
+    if (haveWrites) {
+        if (!getVector(writeObject, &writes, 1, "is_write")) {
+            PyBuffer_Release(&addresses);
+            return nullptr;
+        }
+        if (itemCount(writes) != count) {
+            PyErr_SetString(PyExc_ValueError, "is_write and addresses differ in length");
+            PyBuffer_Release(&writes);
+            PyBuffer_Release(&addresses);
+            return nullptr;
+        }
+    }
+    PyObject* result = resultBuffer(out, &results, count, 1, "out");
+    if (result == nullptr || !checkCache(self)) {
+        if (result != nullptr) {
+            PyBuffer_Release(&results);
+            Py_DECREF(result);
+        }
+        if (haveWrites) PyBuffer_Release(&writes);
+        PyBuffer_Release(&addresses);
+        return nullptr;
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    memsim_cache_access_batch(self->cache, static_cast<const uint64_t*>(addresses.buf),
+                              haveWrites ? static_cast<const uint8_t*>(writes.buf) : nullptr,
+                              static_cast<uint8_t*>(results.buf), static_cast<size_t>(count));
+    Py_END_ALLOW_THREADS
+
+    self->busy = false;
+    PyBuffer_Release(&results);
+    if (haveWrites) PyBuffer_Release(&writes);
+    PyBuffer_Release(&addresses);
+    return result;
+}
+
+PyObject* Cache_set_policy(CacheObject* self, PyObject* args, PyObject* kwargs) {
+    static const char* keywords[] = {"policy", "level", nullptr};
+    PyObject* policyObject;
+    int level = 0;
+    int policy;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|i", const_cast<char**>(keywords), &policyObject, &level) ||
+        !parseChoice(policyObject, POLICY_NAMES, 5, &policy, "policy") || !checkCache(self)) {
+        return nullptr;
+    }
+    int status = memsim_cache_set_policy(self->cache, level, policy);
+    self->busy = false;
+    if (status != MEMSIM_OK) return raiseStatus(status);
+    Py_RETURN_NONE;
+}
+
+PyObject* Cache_info(CacheObject* self, PyObject*) {
+    memsim_cache_info info;
+    if (memsim_cache_get_info(self->cache, &info) != MEMSIM_OK) {
+        PyErr_SetString(PyExc_RuntimeError, "Cache was not initialized");
+        return nullptr;
+    }
+    return Py_BuildValue("{s:K,s:K,s:K,s:K,s:K,s:K,s:K,s:K,s:K,s:K}",
+                         "l1_hits", (unsigned long long)info.l1_hits,
+                         "l1_misses", (unsigned long long)info.l1_misses,
+                         "l2_hits", (unsigned long long)info.l2_hits,
+                         "l2_misses", (unsigned long long)info.l2_misses,
+                         "l1_fill_bytes", (unsigned long long)info.l1_fill_bytes,
+                         "l2_fill_bytes", (unsigned long long)info.l2_fill_bytes,
+                         "l1_writeback_bytes", (unsigned long long)info.l1_writeback_bytes,
+                         "l2_writeback_bytes", (unsigned long long)info.l2_writeback_bytes,
+                         "memory_read_bytes", (unsigned long long)info.memory_read_bytes,
+                         "memory_write_bytes", (unsigned long long)info.memory_write_bytes);
+}
+
+PyMethodDef CacheMethods[] = {
+    {"access", method(Cache_access), METH_VARARGS,
+     "access(address, is_write=False) -> L1_HIT/L2_HIT bits"},
+    {"access_batch", method(Cache_access_batch),
+     METH_VARARGS | METH_KEYWORDS,
+     "access_batch(addresses, is_write=None, out=None) -> uint8 buffer of L1_HIT/L2_HIT bits per access"},
+    {"set_policy", method(Cache_set_policy),
+     METH_VARARGS | METH_KEYWORDS, "set_policy(policy, level=0); level 0 sets both levels"},
+    {"info", method(Cache_info), METH_NOARGS, "Hit, miss and traffic counters"},
+    {nullptr, nullptr, 0, nullptr}
+};
+
+PyType_Slot CacheSlots[] = {
+    {Py_tp_doc, const_cast<char*>("Cache(l1_size=16384, l1_block=64, l1_assoc=4, l2_size=65536, l2_block=64, "
+                                  "l2_assoc=8, policy='fifo', l1_sectors=1, l2_sectors=1)")},
+    {Py_tp_new, reinterpret_cast<void*>(PyType_GenericNew)},
+    {Py_tp_init, reinterpret_cast<void*>(Cache_init)},
+    {Py_tp_dealloc, reinterpret_cast<void*>(Cache_dealloc)},
+    {Py_tp_methods, CacheMethods},
+    {0, nullptr}
+};
+
+PyType_Spec CacheSpec = {"memsim.Cache", sizeof(CacheObject), 0, Py_TPFLAGS_DEFAULT, CacheSlots};
+
+// ---------------------------------------------------------------------------
+// Heap
+// ---------------------------------------------------------------------------
+
+int Heap_init(HeapObject* self, PyObject* args, PyObject* kwargs) {
+    static const char* keywords[] = {"size", "strategy", "size_tree", "compact_header", nullptr};
+    unsigned long long size;
+    PyObject* strategy = nullptr;
+    memsim_heap_config config;
+    memsim_heap_config_init(&config);
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "K|Opp", const_cast<char**>(keywords),
+                                     &size, &strategy, &config.size_tree, &config.compact_header)) {
+        return -1;
+    }
+    if (strategy != nullptr && !parseChoice(strategy, STRATEGY_NAMES, 3, &config.strategy, "strategy")) {
+        return -1;
+    }
+
+    if (!claim(self->busy)) {
+        return -1;
+    }
+    memsim_heap* heap = nullptr;
+    int status;
+    Py_BEGIN_ALLOW_THREADS  // Large heaps take a while to zero
+    status = memsim_heap_create(size, &config, &heap);
+    Py_END_ALLOW_THREADS
+    self->busy = false;
+    if (status != MEMSIM_OK) {
+        raiseStatus(status);
+        return -1;
+    }
+    memsim_heap_destroy(self->heap);
+    self->heap = heap;
+    return 0;
+}
+
+void Heap_dealloc(HeapObject* self) {
+    PyTypeObject* type = Py_TYPE(self);
+    memsim_heap_destroy(self->heap);
+    type->tp_free(reinterpret_cast<PyObject*>(self));
+    Py_DECREF(type);  // Instances of heap types own a type reference
+}
+
+bool checkHeap(HeapObject* self) {
+    if (self->heap == nullptr) {
+        PyErr_SetString(PyExc_RuntimeError, "Heap was not initialized");
+        return false;
+    }
+    return claim(self->busy);
+}
+
+PyObject* Heap_malloc(HeapObject* self, PyObject* args) {
+    unsigned long long size;
+    if (!PyArg_ParseTuple(args, "K", &size) || !checkHeap(self)) {
+        return nullptr;
+    }
+    uint64_t address;
+    int status = memsim_malloc(self->heap, size, &address);
+    self->busy = false;
+    if (status == MEMSIM_ERR_NO_MEMORY) Py_RETURN_NONE;
+    return status == MEMSIM_OK ? PyLong_FromUnsignedLongLong(address) : raiseStatus(status);
+}
+
+PyObject* Heap_free(HeapObject* self, PyObject* args) {
+    unsigned long long address;
+    if (!PyArg_ParseTuple(args, "K", &address) || !checkHeap(self)) {
+        return nullptr;
+    }
+    int status = memsim_free(self->heap, address);
+    self->busy = false;
+    return PyBool_FromLong(status == MEMSIM_OK);
+}
+
+PyObject* Heap_malloc_batch(HeapObject* self, PyObject* args, PyObject* kwargs) {
+    static const char* keywords[] = {"sizes", "out", nullptr};
+    PyObject* sizeObject;
+    PyObject* out = Py_None;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|O", const_cast<char**>(keywords), &sizeObject, &out)) {
+        return nullptr;
+    }
+
+    Py_buffer sizes, addresses;
+    if (!getVector(sizeObject, &sizes, 8, "sizes")) {
+        return nullptr;
+    }
+    Py_ssize_t count = itemCount(sizes);
+    PyObject* result = resultBuffer(out, &addresses, count, 8, "out");
+    if (result == nullptr || !checkHeap(self)) {
+        if (result != nullptr) {
+            PyBuffer_Release(&addresses);
+            Py_DECREF(result);
+        }
+        PyBuffer_Release(&sizes);
+        return nullptr;
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    memsim_malloc_batch(self->heap, static_cast<const uint64_t*>(sizes.buf),
+                        static_cast<uint64_t*>(addresses.buf), static_cast<size_t>(count));
+    Py_END_ALLOW_THREADS
+
+    self->busy = false;
+    PyBuffer_Release(&addresses);
+    PyBuffer_Release(&sizes);
+    return result;
+}
+
+PyObject* Heap_free_batch(HeapObject* self, PyObject* args) {
+    PyObject* addressObject;
+    Py_buffer addresses;
+    if (!PyArg_ParseTuple(args, "O", &addressObject) || !getVector(addressObject, &addresses, 8, "addresses")) {
+        return nullptr;
+    }
+    if (!checkHeap(self)) {
+        PyBuffer_Release(&addresses);
+        return nullptr;
+    }
+
+    size_t freed;
+    Py_BEGIN_ALLOW_THREADS
+    freed = memsim_free_batch(self->heap, static_cast<const uint64_t*>(addresses.buf),
+                              static_cast<size_t>(itemCount(addresses)));
+    Py_END_ALLOW_THREADS
+
+    self->busy = false;
+    PyBuffer_Release(&addresses);
+    return PyLong_FromSize_t(freed);
+}
+
+PyObject* Heap_info(HeapObject* self, PyObject*) {
+    memsim_heap_info info;
+    if (memsim_heap_get_info(self->heap, &info) != MEMSIM_OK) {
+        PyErr_SetString(PyExc_RuntimeError, "Heap was not initialized");
+        return nullptr;
+    }
+    return Py_BuildValue("{s:K,s:K,s:K,s:K,s:K,s:K,s:d,s:d,s:d}",
+                         "total_bytes", (unsigned long long)info.total_bytes,
+                         "used_bytes", (unsigned long long)info.used_bytes,
+                         "free_bytes", (unsigned long long)info.free_bytes,
+                         "allocations_ok", (unsigned long long)info.allocations_ok,
+                         "allocations_failed", (unsigned long long)info.allocations_failed,
+                         "header_bytes", (unsigned long long)info.header_bytes,
+                         "internal_fragmentation", info.internal_fragmentation,
+                         "external_fragmentation", info.external_fragmentation,
+                         "utilization", info.utilization);
+}
+
+PyMethodDef HeapMethods[] = {
+    {"malloc", method(Heap_malloc), METH_VARARGS,
+     "malloc(size) -> physical address, or None if it does not fit"},
+    {"free", method(Heap_free), METH_VARARGS,
+     "free(address) -> True if a block was allocated at address"},
+    {"malloc_batch", method(Heap_malloc_batch),
+     METH_VARARGS | METH_KEYWORDS,
+     "malloc_batch(sizes, out=None) -> uint64 buffer of addresses (NULL_ADDRESS where allocation failed)"},
+    {"free_batch", method(Heap_free_batch), METH_VARARGS,
+     "free_batch(addresses) -> number of blocks freed"},
+    {"info", method(Heap_info), METH_NOARGS, "Usage and fragmentation figures"},
+    {nullptr, nullptr, 0, nullptr}
+};
+
+PyType_Slot HeapSlots[] = {
+    {Py_tp_doc, const_cast<char*>("Heap(size, strategy='first', size_tree=False, compact_header=False)")},
+    {Py_tp_new, reinterpret_cast<void*>(PyType_GenericNew)},
+    {Py_tp_init, reinterpret_cast<void*>(Heap_init)},
+    {Py_tp_dealloc, reinterpret_cast<void*>(Heap_dealloc)},
+    {Py_tp_methods, HeapMethods},
+    {0, nullptr}
+};
+
+PyType_Spec HeapSpec = {"memsim.Heap", sizeof(HeapObject), 0, Py_TPFLAGS_DEFAULT, HeapSlots};
+
+PyModuleDef MemsimModule = {
+    PyModuleDef_HEAD_INIT, "memsim",
+    "Cache hierarchy and heap allocator simulator (libmemsim bindings).\n\n"
+    "Batch methods read numpy arrays (or any buffer) in place and return\n"
+    "bytearrays; wrap them with np.frombuffer(result, dtype=np.uint8/np.uint64).",
+    -1, nullptr, nullptr, nullptr, nullptr, nullptr
+};
+
+} // namespace
+
+PyMODINIT_FUNC PyInit_memsim(void) {
+    PyObject* module = PyModule_Create(&MemsimModule);
+    if (module == nullptr) {
+        return nullptr;
+    }
+    if (PyModule_AddObject(module, "Cache", PyType_FromSpec(&CacheSpec)) < 0 ||
+        PyModule_AddObject(module, "Heap", PyType_FromSpec(&HeapSpec)) < 0 ||
+        PyModule_AddIntConstant(module, "L1_HIT", MEMSIM_L1_HIT) < 0 ||
+        PyModule_AddIntConstant(module, "L2_HIT", MEMSIM_L2_HIT) < 0 ||
+        PyModule_AddObject(module, "NULL_ADDRESS", PyLong_FromUnsignedLongLong(MEMSIM_NULL_ADDRESS)) < 0) {
+        Py_DECREF(module);
+        return nullptr;
+    }
+    return module;
+}
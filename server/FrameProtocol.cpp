@@ -0,0 +1,82 @@
+#include "FrameProtocol.h"
+
+namespace {
+
+uint64_t getU64(const uint8_t* in) {
+    return static_cast<uint64_t>(FrameProtocol::getU32(in)) |
+           (static_cast<uint64_t>(FrameProtocol::getU32(in + 4)) << 32);
+}
+
+void putU32(std::vector<uint8_t>& out, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+void putU64(std::vector<uint8_t>& out, uint64_t value) {
+    for (int i = 0; i < 8; i++) {
+        out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+} // namespace
+
+uint32_t FrameProtocol::getU32(const uint8_t* in) {
+    return static_cast<uint32_t>(in[0]) | (static_cast<uint32_t>(in[1]) << 8) |
+           (static_cast<uint32_t>(in[2]) << 16) | (static_cast<uint32_t>(in[3]) << 24);
+}
+
+bool FrameProtocol::parseRequest(const uint8_t* body, size_t bytes, std::vector<Command>& commands) {
+    commands.clear();
+    if (bytes < 4) {
+        return false;
+    }
+    uint32_t count = getU32(body);
+    const uint8_t* pos = body + 4;
+    const uint8_t* end = body + bytes;
+
+    // Each command takes at least 4 bytes, which bounds the reservation
+    if (count > bytes / 4) {
+        return false;
+    }
+    commands.reserve(count);
+
+    for (uint32_t i = 0; i < count; i++) {
+        if (end - pos < 4) {
+            return false;
+        }
+        Command command;
+        command.op = pos[0];
+        command.arg_count = pos[1];
+        pos += 4;
+        if (command.arg_count > MAX_ARGS || static_cast<size_t>(end - pos) < command.arg_count * 8u) {
+            return false;
+        }
+        for (uint8_t a = 0; a < command.arg_count; a++) {
+            command.args[a] = getU64(pos);
+            pos += 8;
+        }
+        commands.push_back(command);
+    }
+    return pos == end;
+}
+
+void FrameProtocol::appendReplyFrame(const std::vector<Reply>& replies, std::vector<uint8_t>& out) {
+    size_t lengthAt = out.size();
+    putU32(out, 0); // Patched below
+    putU32(out, static_cast<uint32_t>(replies.size()));
+    for (const Reply& reply : replies) {
+        out.push_back(reply.status);
+        out.push_back(reply.value_count);
+        out.push_back(0);
+        out.push_back(0);
+        for (uint8_t v = 0; v < reply.value_count; v++) {
+            putU64(out, reply.values[v]);
+        }
+    }
+
+    uint32_t bodyBytes = static_cast<uint32_t>(out.size() - lengthAt - 4);
+    for (int i = 0; i < 4; i++) {
+        out[lengthAt + i] = static_cast<uint8_t>(bodyBytes >> (8 * i));
+    }
+}
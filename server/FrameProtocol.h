@@ -0,0 +1,81 @@
+#ifndef FRAME_PROTOCOL_H
+#define FRAME_PROTOCOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Batched binary frames exchanged with the simulator server (little endian).
+//
+//   frame   := u32 body_bytes, body
+//   request body := u32 command_count, command*
+//   command := u8 op, u8 arg_count, u16 reserved, u64 arg[arg_count]
+//   reply body   := u32 reply_count, reply*
+//   reply   := u8 status, u8 value_count, u16 reserved, u64 value[value_count]
+//
+// Every request frame gets exactly one reply frame with one reply per
+// command, in order.
+namespace FrameProtocol {
+    enum Op {
+        OP_INIT_MEMORY = 1,    // size [, strategy, free_index, header_layout]
+        OP_INIT_CACHE = 2,     // l1_size, l1_block, l1_assoc, l2_size, l2_block, l2_assoc [, policy]
+        OP_SET_ALLOCATOR = 3,  // strategy (0 first, 1 best, 2 worst fit)
+        OP_SET_POLICY = 4,     // policy (0 FIFO, 1 LRU, 2 LFU, 3 LFU-DA, 4 Hawkeye)
+        OP_MALLOC = 5,         // size -> block_id, physical address
+        OP_FREE = 6,           // block_id
+        OP_ACCESS = 7,         // address [, is_write, pc] -> l1_hit, l2_hit
+        OP_STATS = 8           // -> see STAT_* below
+    };
+
+    enum Status {
+        STATUS_OK = 0,
+        STATUS_NOT_INITIALIZED = 1,  // No init memory yet
+        STATUS_BAD_ARGUMENTS = 2,    // Wrong argument count or invalid value
+        STATUS_FAILED = 3,           // Allocation failed, unknown block id
+        STATUS_UNKNOWN_OP = 4
+    };
+
+    // Value order of an OP_STATS reply; fragmentation is in basis points
+    enum StatValue {
+        STAT_L1_HITS, STAT_L1_MISSES, STAT_L2_HITS, STAT_L2_MISSES,
+        STAT_USED_BYTES, STAT_FREE_BYTES, STAT_ALLOC_SUCCESS, STAT_ALLOC_FAILURE,
+        STAT_INTERNAL_FRAG_BP, STAT_EXTERNAL_FRAG_BP,
+        STAT_COUNT
+    };
+
+    const size_t MAX_ARGS = 8;
+    const size_t MAX_VALUES = 16;
+    const size_t MAX_FRAME_BYTES = 16 << 20;
+
+    struct Command {
+        uint8_t op;
+        uint8_t arg_count;
+        uint64_t args[MAX_ARGS];
+    };
+
+    struct Reply {
+        uint8_t status;
+        uint8_t value_count;
+        uint64_t values[MAX_VALUES];
+
+        static Reply make(uint8_t status) {
+            Reply reply;
+            reply.status = status;
+            reply.value_count = 0;
+            return reply;
+        }
+        void push(uint64_t value) {
+            if (value_count < MAX_VALUES) values[value_count++] = value;
+        }
+    };
+
+    // Parses a request body (after the length prefix); false if malformed
+    bool parseRequest(const uint8_t* body, size_t bytes, std::vector<Command>& commands);
+
+    // Appends a complete reply frame (length prefix included) to `out`
+    void appendReplyFrame(const std::vector<Reply>& replies, std::vector<uint8_t>& out);
+
+    uint32_t getU32(const uint8_t* in);
+}
+
+#endif // FRAME_PROTOCOL_H
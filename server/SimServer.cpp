@@ -0,0 +1,263 @@
+#include "SimServer.h"
+#include <iostream>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <exception>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+volatile sig_atomic_t stopRequested = 0;
+
+void onStopSignal(int) {
+    stopRequested = 1;
+}
+
+// Stop reading from a client whose replies are not being drained
+const size_t MAX_PENDING_OUTPUT = 4 << 20;
+
+bool setNonBlocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+} // namespace
+
+SimServer::SimServer(const std::string& socket_path, size_t max_sessions)
+    : socketPath(socket_path), maxSessions(max_sessions), listenFd(-1), nextConnectionId(1) {
+}
+
+SimServer::~SimServer() {
+    while (!connections.empty()) {
+        closeConnection(connections.size() - 1);
+    }
+    if (listenFd >= 0) {
+        ::close(listenFd);
+        unlink(socketPath.c_str());
+    }
+}
+
+bool SimServer::start() {
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (socketPath.empty() || socketPath.size() >= sizeof(address.sun_path)) {
+        error = "socket path must be 1-" + std::to_string(sizeof(address.sun_path) - 1) + " characters";
+        return false;
+    }
+    std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size());
+
+    // Replace a stale socket from a previous run, but never a regular file
+    struct stat info;
+    if (lstat(socketPath.c_str(), &info) == 0) {
+        if (!S_ISSOCK(info.st_mode)) {
+            error = socketPath + " exists and is not a socket";
+            return false;
+        }
+        unlink(socketPath.c_str());
+    }
+
+    listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd < 0 ||
+        bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        listen(listenFd, 16) != 0 || !setNonBlocking(listenFd)) {
+        error = std::string("cannot listen on ") + socketPath + ": " + std::strerror(errno);
+        if (listenFd >= 0) {
+            ::close(listenFd);
+            listenFd = -1;
+        }
+        return false;
+    }
+    return true;
+}
+
+void SimServer::run() {
+    struct sigaction action;
+    std::memset(&action, 0, sizeof(action));
+    action.sa_handler = onStopSignal;
+    sigaction(SIGINT, &action, nullptr);   // No SA_RESTART: poll() returns EINTR
+    sigaction(SIGTERM, &action, nullptr);
+    signal(SIGPIPE, SIG_IGN);              // A vanished client is an EPIPE, not a crash
+    stopRequested = 0;
+
+    std::vector<pollfd> fds;
+    while (!stopRequested) {
+        fds.clear();
+        fds.push_back(pollfd{listenFd, POLLIN, 0});
+        for (const auto& connection : connections) {
+            short events = 0;
+            if (connection->output.size() - connection->outputPos < MAX_PENDING_OUTPUT) {
+                events |= POLLIN;
+            }
+            if (connection->outputPos < connection->output.size()) {
+                events |= POLLOUT;
+            }
+            fds.push_back(pollfd{connection->fd, events, 0});
+        }
+
+        if (poll(fds.data(), fds.size(), -1) < 0) {
+            if (errno == EINTR) continue;
+            std::cout << "poll failed: " << std::strerror(errno) << "\n";
+            break;
+        }
+
+        // Walk backwards so closing a connection does not shift unvisited entries
+        for (size_t i = connections.size(); i-- > 0;) {
+            short revents = fds[i + 1].revents;
+            if (revents == 0) continue;
+            Connection& connection = *connections[i];
+            bool keep = true;
+            if (revents & POLLIN) {
+                keep = readFrom(connection) && processFrames(connection);
+            } else if (revents & (POLLHUP | POLLERR | POLLNVAL)) {
+                keep = false;
+            }
+            if (keep && connection.outputPos < connection.output.size()) {
+                keep = writeTo(connection);
+            }
+            if (!keep) {
+                closeConnection(i);
+            }
+        }
+
+        if (fds[0].revents & POLLIN) {
+            acceptClients();
+        }
+    }
+    std::cout << "Server stopping\n";
+}
+
+void SimServer::acceptClients() {
+    while (true) {
+        int fd = accept(listenFd, nullptr, nullptr);
+        if (fd < 0) {
+            return; // EAGAIN: no more pending clients
+        }
+        if (connections.size() >= maxSessions || !setNonBlocking(fd)) {
+            std::cout << "Rejected client: session limit (" << maxSessions << ") reached\n";
+            ::close(fd);
+            continue;
+        }
+
+        std::unique_ptr<Connection> connection(new Connection());
+        connection->fd = fd;
+        connection->id = nextConnectionId++;
+        connection->outputPos = 0;
+        connection->frames = 0;
+        connection->session.reset(new SimulatorSession());
+        std::cout << "Session " << connection->id << " connected (" << connections.size() + 1
+                  << " active)" << std::endl;
+        connections.push_back(std::move(connection));
+    }
+}
+
+bool SimServer::readFrom(Connection& connection) {
+    uint8_t buffer[64 * 1024];
+    while (true) {
+        ssize_t n = read(connection.fd, buffer, sizeof(buffer));
+        if (n > 0) {
+            connection.input.insert(connection.input.end(), buffer, buffer + n);
+            if (connection.input.size() > FrameProtocol::MAX_FRAME_BYTES + 4 + sizeof(buffer)) {
+                return true; // Let processFrames drain before reading more
+            }
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return true;
+        // EOF: execute whatever complete frames arrived, then close
+        processFrames(connection);
+        writeTo(connection);
+        return false;
+    }
+}
+
+bool SimServer::processFrames(Connection& connection) {
+    size_t pos = 0;
+    while (connection.input.size() - pos >= 4) {
+        uint32_t bodyBytes = FrameProtocol::getU32(connection.input.data() + pos);
+        if (bodyBytes > FrameProtocol::MAX_FRAME_BYTES) {
+            std::cout << "Session " << connection.id << ": frame of " << bodyBytes
+                      << " bytes exceeds the limit, closing\n";
+            return false;
+        }
+        if (connection.input.size() - pos - 4 < bodyBytes) {
+            break; // Wait for the rest of the frame
+        }
+
+        const uint8_t* body = connection.input.data() + pos + 4;
+        if (!FrameProtocol::parseRequest(body, bodyBytes, commands)) {
+            std::cout << "Session " << connection.id << ": malformed frame, closing\n";
+            return false;
+        }
+
+        replies.clear();
+        replies.reserve(commands.size());
+        for (const FrameProtocol::Command& command : commands) {
+            // A command that throws fails on its own instead of taking every
+            // session down with the server
+            try {
+                replies.push_back(connection.session->execute(command));
+            } catch (const std::exception& e) {
+                std::cout << "Session " << connection.id << ": command failed: " << e.what() << "\n";
+                replies.push_back(FrameProtocol::Reply::make(FrameProtocol::STATUS_FAILED));
+            }
+        }
+        FrameProtocol::appendReplyFrame(replies, connection.output);
+        connection.frames++;
+        pos += 4 + bodyBytes;
+    }
+    connection.input.erase(connection.input.begin(), connection.input.begin() + pos);
+    return true;
+}
+
+bool SimServer::writeTo(Connection& connection) {
+    while (connection.outputPos < connection.output.size()) {
+        ssize_t n = write(connection.fd, connection.output.data() + connection.outputPos,
+                          connection.output.size() - connection.outputPos);
+        if (n > 0) {
+            connection.outputPos += static_cast<size_t>(n);
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return true;
+        return false;
+    }
+    connection.output.clear();
+    connection.outputPos = 0;
+    return true;
+}
+
+void SimServer::closeConnection(size_t index) {
+    Connection& connection = *connections[index];
+    ::close(connection.fd);
+    std::cout << "Session " << connection.id << " closed (" << connection.frames << " frames, "
+              << connection.session->getCommandCount() << " commands)" << std::endl;
+    connections.erase(connections.begin() + index);
+}
+
+#else // _WIN32
+
+SimServer::SimServer(const std::string& socket_path, size_t max_sessions)
+    : socketPath(socket_path), maxSessions(max_sessions), listenFd(-1), nextConnectionId(1) {
+}
+
+SimServer::~SimServer() {
+}
+
+bool SimServer::start() {
+    error = "server mode requires Unix domain sockets (not supported on this platform)";
+    return false;
+}
+
+void SimServer::run() {
+}
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef SIM_SERVER_H
+#define SIM_SERVER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "FrameProtocol.h"
+#include "SimulatorSession.h"
+
+// Serves FrameProtocol requests on a Unix domain socket. Every connection is
+// a session with its own MemoryManager and CacheSimulator. One poll() loop
+// multiplexes all sessions; frames are executed as soon as they are complete
+// and replies are written back without blocking the other clients.
+class SimServer {
+public:
+    static const size_t DEFAULT_MAX_SESSIONS = 64;
+
+    explicit SimServer(const std::string& socket_path, size_t max_sessions = DEFAULT_MAX_SESSIONS);
+    ~SimServer();
+
+    // Creates and binds the socket; false (see getError) on failure
+    bool start();
+    // Serves clients until SIGINT/SIGTERM
+    void run();
+
+    const std::string& getError() const { return error; }
+
+private:
+    struct Connection {
+        int fd;
+        size_t id;
+        std::vector<uint8_t> input;
+        std::vector<uint8_t> output;
+        size_t outputPos;
+        size_t frames;
+        std::unique_ptr<SimulatorSession> session;
+    };
+
+    std::string socketPath;
+    size_t maxSessions;
+    int listenFd;
+    size_t nextConnectionId;
+    std::vector<std::unique_ptr<Connection>> connections;
+    std::vector<FrameProtocol::Command> commands;
+    std::vector<FrameProtocol::Reply> replies;
+    std::string error;
+
+    void acceptClients();
+    // False if the connection should be closed
+    bool readFrom(Connection& connection);
+    bool processFrames(Connection& connection);
+    bool writeTo(Connection& connection);
+    void closeConnection(size_t index);
+};
+
+#endif // SIM_SERVER_H
@@ -0,0 +1,158 @@
+#include "SimulatorSession.h"
+#include <stdexcept>
+
+using FrameProtocol::Command;
+using FrameProtocol::Reply;
+
+SimulatorSession::SimulatorSession() : nextBlockId(1), commandCount(0) {
+}
+
+Reply SimulatorSession::execute(const Command& command) {
+    commandCount++;
+
+    switch (command.op) {
+        case FrameProtocol::OP_INIT_MEMORY:
+            return initMemory(command);
+        case FrameProtocol::OP_INIT_CACHE:
+            return initCache(command);
+        default:
+            break;
+    }
+
+    if (!memory) {
+        bool known = command.op >= FrameProtocol::OP_SET_ALLOCATOR && command.op <= FrameProtocol::OP_STATS;
+        return Reply::make(known ? FrameProtocol::STATUS_NOT_INITIALIZED : FrameProtocol::STATUS_UNKNOWN_OP);
+    }
+
+    switch (command.op) {
+        case FrameProtocol::OP_SET_ALLOCATOR:
+            if (command.arg_count != 1 || command.args[0] > MemoryManager::WORST_FIT) {
+                return Reply::make(FrameProtocol::STATUS_BAD_ARGUMENTS);
+            }
+            memory->setAllocationStrategy(static_cast<MemoryManager::AllocationStrategy>(command.args[0]));
+            return Reply::make(FrameProtocol::STATUS_OK);
+
+        case FrameProtocol::OP_SET_POLICY:
+            if (command.arg_count != 1 || command.args[0] > CacheSimulator::HAWKEYE) {
+                return Reply::make(FrameProtocol::STATUS_BAD_ARGUMENTS);
+            }
+            cache->setReplacementPolicy(static_cast<CacheSimulator::ReplacementPolicy>(command.args[0]));
+            return Reply::make(FrameProtocol::STATUS_OK);
+
+        case FrameProtocol::OP_MALLOC: {
+            if (command.arg_count != 1) {
+                return Reply::make(FrameProtocol::STATUS_BAD_ARGUMENTS);
+            }
+            void* ptr = memory->allocate(command.args[0]);
+            if (ptr == nullptr) {
+                return Reply::make(FrameProtocol::STATUS_FAILED);
+            }
+            uint64_t id = nextBlockId++;
+            blocks[id] = ptr;
+            Reply reply = Reply::make(FrameProtocol::STATUS_OK);
+            reply.push(id);
+            reply.push(memory->getOffset(ptr));
+            return reply;
+        }
+
+        case FrameProtocol::OP_FREE: {
+            if (command.arg_count != 1) {
+                return Reply::make(FrameProtocol::STATUS_BAD_ARGUMENTS);
+            }
+            auto it = blocks.find(command.args[0]);
+            if (it == blocks.end() || !memory->deallocate(it->second)) {
+                return Reply::make(FrameProtocol::STATUS_FAILED);
+            }
+            blocks.erase(it);
+            return Reply::make(FrameProtocol::STATUS_OK);
+        }
+
+        case FrameProtocol::OP_ACCESS: {
+            if (command.arg_count < 1 || command.arg_count > 3) {
+                return Reply::make(FrameProtocol::STATUS_BAD_ARGUMENTS);
+            }
+            bool isWrite = command.arg_count > 1 && command.args[1] != 0;
+            uint64_t pc = command.arg_count > 2 ? command.args[2] : 0;
+            CacheSimulator::CacheAccessReport report = cache->access(command.args[0], isWrite, pc);
+            Reply reply = Reply::make(FrameProtocol::STATUS_OK);
+            reply.push(report.l1Hit ? 1 : 0);
+            reply.push(report.l2Hit ? 1 : 0);
+            return reply;
+        }
+
+        case FrameProtocol::OP_STATS:
+            return stats();
+
+        default:
+            return Reply::make(FrameProtocol::STATUS_UNKNOWN_OP);
+    }
+}
+
+Reply SimulatorSession::initMemory(const Command& command) {
+    if (command.arg_count < 1 || command.arg_count > 4 || command.args[0] == 0 ||
+        (command.arg_count > 1 && command.args[1] > MemoryManager::WORST_FIT) ||
+        (command.arg_count > 2 && command.args[2] > MemoryManager::IN_BAND) ||
+        (command.arg_count > 3 && command.args[3] > MemoryManager::COMPACT_HEADER)) {
+        return Reply::make(FrameProtocol::STATUS_BAD_ARGUMENTS);
+    }
+
+    MemoryManager::AllocationStrategy strategy = command.arg_count > 1 ?
+        static_cast<MemoryManager::AllocationStrategy>(command.args[1]) : MemoryManager::FIRST_FIT;
+    MemoryManager::FreeIndex index = command.arg_count > 2 ?
+        static_cast<MemoryManager::FreeIndex>(command.args[2]) : MemoryManager::FREE_LIST;
+    MemoryManager::HeaderLayout layout = command.arg_count > 3 ?
+        static_cast<MemoryManager::HeaderLayout>(command.args[3]) : MemoryManager::STANDARD_HEADER;
+    if (command.args[0] > MemoryManager::getMaxHeapSize(layout)) {
+        return Reply::make(FrameProtocol::STATUS_BAD_ARGUMENTS);
+    }
+
+    // The standard header has no size limit, so a huge heap is only caught
+    // when it fails to allocate
+    try {
+        memory.reset(new MemoryManager(command.args[0], strategy, index, layout));
+    } catch (const std::exception&) {
+        return Reply::make(FrameProtocol::STATUS_FAILED);  // Previous heap is kept
+    }
+    blocks.clear();
+    nextBlockId = 1;
+
+    // Same default hierarchy as the CLI's 'init memory'
+    if (!cache) {
+        cache.reset(new CacheSimulator(16 * 1024, 64, 4, 64 * 1024, 64, 8));
+        cache->setEventLogging(false);
+    }
+    return Reply::make(FrameProtocol::STATUS_OK);
+}
+
+Reply SimulatorSession::initCache(const Command& command) {
+    if (command.arg_count < 6 || command.arg_count > 7 ||
+        (command.arg_count > 6 && command.args[6] > CacheSimulator::HAWKEYE)) {
+        return Reply::make(FrameProtocol::STATUS_BAD_ARGUMENTS);
+    }
+    CacheSimulator::ReplacementPolicy policy = command.arg_count > 6 ?
+        static_cast<CacheSimulator::ReplacementPolicy>(command.args[6]) : CacheSimulator::FIFO;
+
+    try {
+        cache.reset(new CacheSimulator(command.args[0], command.args[1], command.args[2],
+                                       command.args[3], command.args[4], command.args[5], policy));
+    } catch (const std::exception&) {
+        return Reply::make(FrameProtocol::STATUS_BAD_ARGUMENTS);  // Previous cache is kept
+    }
+    cache->setEventLogging(false);
+    return Reply::make(FrameProtocol::STATUS_OK);
+}
+
+Reply SimulatorSession::stats() const {
+    Reply reply = Reply::make(FrameProtocol::STATUS_OK);
+    reply.push(cache->getHits(1));
+    reply.push(cache->getMisses(1));
+    reply.push(cache->getHits(2));
+    reply.push(cache->getMisses(2));
+    reply.push(memory->getUsedMemory());
+    reply.push(memory->getFreeMemory());
+    reply.push(memory->getAllocationSuccessCount());
+    reply.push(memory->getAllocationFailureCount());
+    reply.push(static_cast<uint64_t>(memory->getInternalFragmentation() * 100.0 + 0.5));
+    reply.push(static_cast<uint64_t>(memory->getExternalFragmentation() * 100.0 + 0.5));
+    return reply;
+}
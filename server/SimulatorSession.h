@@ -0,0 +1,35 @@
+#ifndef SIMULATOR_SESSION_H
+#define SIMULATOR_SESSION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include "FrameProtocol.h"
+#include "../allocator/MemoryManager.h"
+#include "../cache/CacheSimulator.h"
+
+// Simulator state owned by one server client: a heap, a cache hierarchy and
+// the block ids handed out to that client. State stays warm between frames
+// for as long as the connection is open.
+class SimulatorSession {
+public:
+    SimulatorSession();
+
+    FrameProtocol::Reply execute(const FrameProtocol::Command& command);
+
+    size_t getCommandCount() const { return commandCount; }
+
+private:
+    std::unique_ptr<MemoryManager> memory;
+    std::unique_ptr<CacheSimulator> cache;
+    uint64_t nextBlockId;
+    std::unordered_map<uint64_t, void*> blocks;
+    size_t commandCount;
+
+    FrameProtocol::Reply initMemory(const FrameProtocol::Command& command);
+    FrameProtocol::Reply initCache(const FrameProtocol::Command& command);
+    FrameProtocol::Reply stats() const;
+};
+
+#endif // SIMULATOR_SESSION_H
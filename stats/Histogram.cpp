@@ -0,0 +1,74 @@
+#include "Histogram.h"
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+
+Histogram::Histogram() : totalWeight(0.0) {
+}
+
+size_t Histogram::bucketFor(uint64_t value) {
+    size_t bucket = 0;
+    while (value != 0) {
+        bucket++;
+        value >>= 1;
+    }
+    return bucket;
+}
+
+void Histogram::add(uint64_t value, double weight) {
+    size_t bucket = bucketFor(value);
+    if (bucket >= buckets.size()) {
+        buckets.resize(bucket + 1, 0.0);
+    }
+    buckets[bucket] += weight;
+    totalWeight += weight;
+}
+
+void Histogram::merge(const Histogram& other) {
+    if (other.buckets.size() > buckets.size()) {
+        buckets.resize(other.buckets.size(), 0.0);
+    }
+    for (size_t i = 0; i < other.buckets.size(); i++) {
+        buckets[i] += other.buckets[i];
+    }
+    totalWeight += other.totalWeight;
+}
+
+void Histogram::clear() {
+    buckets.clear();
+    totalWeight = 0.0;
+}
+
+double Histogram::getBucketWeight(size_t bucket) const {
+    if (bucket >= buckets.size()) return 0.0;
+    return buckets[bucket];
+}
+
+uint64_t Histogram::getBucketLow(size_t bucket) {
+    if (bucket == 0) return 0;
+    return 1ULL << (bucket - 1);
+}
+
+uint64_t Histogram::getBucketHigh(size_t bucket) {
+    if (bucket == 0) return 1;
+    if (bucket >= 64) return UINT64_MAX;
+    return 1ULL << bucket;
+}
+
+void Histogram::print(const std::string& title, const std::string& unit, uint64_t unitScale) const {
+    std::cout << title << ":\n";
+    if (totalWeight <= 0.0) {
+        std::cout << "  (empty)\n";
+        return;
+    }
+
+    for (size_t i = 0; i < buckets.size(); i++) {
+        if (buckets[i] <= 0.0) continue;
+
+        double pct = (buckets[i] / totalWeight) * 100.0;
+        std::cout << "  [" << std::setw(10) << getBucketLow(i) * unitScale << ", "
+                  << std::setw(10) << getBucketHigh(i) * unitScale << ") " << unit << ": "
+                  << std::setw(12) << static_cast<uint64_t>(std::llround(buckets[i]))
+                  << " (" << std::fixed << std::setprecision(2) << pct << "%)\n";
+    }
+}
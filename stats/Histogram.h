@@ -0,0 +1,37 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <string>
+
+// Power-of-two bucketed histogram.
+// Bucket 0 holds the value 0, bucket k (k >= 1) holds values in [2^(k-1), 2^k).
+// Weights are doubles so that sampled analyses can scale each observation.
+class Histogram {
+public:
+    Histogram();
+
+    void add(uint64_t value, double weight = 1.0);
+    void merge(const Histogram& other);
+    void clear();
+
+    double getTotalWeight() const { return totalWeight; }
+    size_t getBucketCount() const { return buckets.size(); }
+    double getBucketWeight(size_t bucket) const;
+    static uint64_t getBucketLow(size_t bucket);
+    static uint64_t getBucketHigh(size_t bucket); // Exclusive
+
+    // Prints non-empty buckets as "[lo, hi) count (pct%)".
+    // unitScale multiplies bucket bounds (e.g. lines -> bytes) for display.
+    void print(const std::string& title, const std::string& unit, uint64_t unitScale = 1) const;
+
+private:
+    std::vector<double> buckets;
+    double totalWeight;
+
+    static size_t bucketFor(uint64_t value);
+};
+
+#endif // HISTOGRAM_H
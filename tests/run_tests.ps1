@@ -2,7 +2,7 @@ $ErrorActionPreference = "Stop"
 
 $BinPath = Join-Path $PSScriptRoot "..\bin\MemoryManagementSimulator.exe"
 $TestDir = $PSScriptRoot
-$Tests = @("workload_allocation", "workload_cache")
+$Tests = @("workload_allocation", "workload_cache", "workload_inband", "workload_pressure", "workload_trace")
 
 if (-not (Test-Path $BinPath)) {
     Write-Error "Simulator binary not found at $BinPath. Please build the project first."
@@ -10,6 +10,9 @@ if (-not (Test-Path $BinPath)) {
 
 Write-Host "Running Tests..." -ForegroundColor Cyan
 
+# Workloads name their trace files relative to this directory
+Push-Location $TestDir
+
 foreach ($test in $Tests) {
     $InputFile = Join-Path $TestDir "$test.txt"
     $OutputFile = Join-Path $TestDir "$test.out"
@@ -26,4 +29,6 @@ foreach ($test in $Tests) {
     }
 }
 
+Pop-Location
+
 Write-Host "`nAll tests completed." -ForegroundColor Cyan
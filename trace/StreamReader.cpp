@@ -0,0 +1,73 @@
+#include "StreamReader.h"
+#include <cerrno>
+#include <cstring>
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+
+uint32_t getU32(const uint8_t* in) {
+    return static_cast<uint32_t>(in[0]) | (static_cast<uint32_t>(in[1]) << 8) |
+           (static_cast<uint32_t>(in[2]) << 16) | (static_cast<uint32_t>(in[3]) << 24);
+}
+
+uint64_t getU64(const uint8_t* in) {
+    return static_cast<uint64_t>(getU32(in)) | (static_cast<uint64_t>(getU32(in + 4)) << 32);
+}
+
+} // namespace
+
+StreamReader::StreamReader(int fd, size_t chunk_bytes)
+    : fd(fd), buffer(chunk_bytes < StreamRecord::WIRE_BYTES ? StreamRecord::WIRE_BYTES : chunk_bytes),
+      pos(0), end(0), recordCount(0), bytesRead(0), eof(false) {
+#ifdef _WIN32
+    _setmode(fd, _O_BINARY);
+#endif
+}
+
+bool StreamReader::fill() {
+    // Move the partial record to the front, then read whatever has arrived
+    if (pos > 0) {
+        std::memmove(buffer.data(), buffer.data() + pos, end - pos);
+        end -= pos;
+        pos = 0;
+    }
+
+    while (!eof) {
+#ifdef _WIN32
+        int n = _read(fd, buffer.data() + end, static_cast<unsigned>(buffer.size() - end));
+#else
+        ssize_t n = read(fd, buffer.data() + end, buffer.size() - end);
+#endif
+        if (n > 0) {
+            end += static_cast<size_t>(n);
+            bytesRead += static_cast<uint64_t>(n);
+            return true;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        eof = true;
+    }
+    return false;
+}
+
+bool StreamReader::next(StreamRecord& record) {
+    while (end - pos < StreamRecord::WIRE_BYTES) {
+        if (!fill()) {
+            return false;
+        }
+    }
+
+    const uint8_t* in = buffer.data() + pos;
+    record.op = in[0];
+    record.handle = getU32(in + 4);
+    record.value = getU64(in + 8);
+    pos += StreamRecord::WIRE_BYTES;
+    recordCount++;
+    return true;
+}
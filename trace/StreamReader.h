@@ -0,0 +1,60 @@
+#ifndef STREAM_READER_H
+#define STREAM_READER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// One record of a live binary stream (`producer | MemoryManagementSimulator --stream`).
+//
+// Wire format: fixed 16-byte records, little endian
+//   offset 0   uint8   op        (StreamRecord::Op)
+//   offset 1   uint8   reserved[3]
+//   offset 4   uint32  handle    malloc/free: block handle chosen by the producer
+//   offset 8   uint64  value     read/write: physical address, malloc: size
+struct StreamRecord {
+    enum Op {
+        OP_READ = 0,
+        OP_WRITE = 1,
+        OP_MALLOC = 2,
+        OP_FREE = 3
+    };
+
+    static const size_t WIRE_BYTES = 16;
+
+    uint8_t op;
+    uint32_t handle;
+    uint64_t value;
+};
+
+// Reads StreamRecords from a file descriptor (stdin by default) in fixed-size
+// chunks. Records are returned as soon as their bytes arrive, records split
+// across reads are reassembled, and memory use is one chunk buffer however
+// long the stream runs.
+class StreamReader {
+public:
+    static const size_t DEFAULT_CHUNK_BYTES = 64 * 1024;
+
+    explicit StreamReader(int fd = 0, size_t chunk_bytes = DEFAULT_CHUNK_BYTES);
+
+    // Blocks until a full record is available; false at end of stream
+    bool next(StreamRecord& record);
+
+    size_t getRecordCount() const { return recordCount; }
+    uint64_t getBytesRead() const { return bytesRead; }
+    // Bytes of an incomplete record left at end of stream
+    size_t getTrailingBytes() const { return end - pos; }
+
+private:
+    int fd;
+    std::vector<uint8_t> buffer;
+    size_t pos;
+    size_t end;
+    size_t recordCount;
+    uint64_t bytesRead;
+    bool eof;
+
+    bool fill();
+};
+
+#endif // STREAM_READER_H
@@ -0,0 +1,294 @@
+#include "TraceCodec.h"
+#include <cstring>
+
+namespace {
+
+const char MAGIC[8] = {'M', 'S', 'T', 'R', 'A', 'C', 'E', '1'};
+
+// A record further than this from every stream starts a new stream in the
+// least recently used slot instead of disturbing the closest one
+const uint64_t NEW_STREAM_DISTANCE = 1 << 20;
+
+void putVarint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+bool getVarint(const uint8_t*& pos, const uint8_t* end, uint64_t& value) {
+    value = 0;
+    for (unsigned shift = 0; shift < 64 && pos < end; shift += 7) {
+        uint8_t byte = *pos++;
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false; // Truncated or longer than 10 bytes
+}
+
+uint64_t zigzag(uint64_t delta) {
+    return (delta << 1) ^ static_cast<uint64_t>(static_cast<int64_t>(delta) >> 63);
+}
+
+uint64_t unzigzag(uint64_t value) {
+    return (value >> 1) ^ (~(value & 1) + 1);
+}
+
+uint64_t distance(uint64_t a, uint64_t b) {
+    return a > b ? a - b : b - a;
+}
+
+void putU32(char* out, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        out[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+    }
+}
+
+uint32_t getU32(const unsigned char* in) {
+    return static_cast<uint32_t>(in[0]) | (static_cast<uint32_t>(in[1]) << 8) |
+           (static_cast<uint32_t>(in[2]) << 16) | (static_cast<uint32_t>(in[3]) << 24);
+}
+
+} // namespace
+
+bool TraceCodec::isEncodedTrace(const std::string& path) {
+    std::ifstream input(path, std::ios::binary);
+    char magic[sizeof(MAGIC)];
+    return input.read(magic, sizeof(magic)) && isMagic(magic);
+}
+
+bool TraceCodec::isMagic(const char* bytes) {
+    return std::memcmp(bytes, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+bool TraceCodec::parseBlockHeader(const unsigned char* header, uint32_t& record_count, uint32_t& payload_bytes) {
+    record_count = getU32(header);
+    payload_bytes = getU32(header + 4);
+    // A token covers at least one record and takes at most three 10-byte varints
+    return record_count != 0 && record_count <= MAX_BLOCK_RECORDS &&
+           payload_bytes <= record_count * size_t(30);
+}
+
+bool TraceCodec::decodeBlock(const uint8_t* payload, size_t payload_bytes,
+                             size_t record_count, TraceRecord* out) {
+    uint64_t streams[STREAM_COUNT] = {};
+    const uint8_t* pos = payload;
+    const uint8_t* end = payload + payload_bytes;
+    size_t produced = 0;
+
+    while (pos < end) {
+        uint64_t tag, stride, count = 1;
+        if (!getVarint(pos, end, tag) || !getVarint(pos, end, stride)) {
+            return false;
+        }
+        if ((tag & 1) && !getVarint(pos, end, count)) {
+            return false;
+        }
+        size_t stream = static_cast<size_t>((tag >> 2) & (STREAM_COUNT - 1));
+        if ((tag >> 5) != 0 || count == 0 || count > record_count - produced) {
+            return false;
+        }
+
+        bool is_write = (tag & 2) != 0;
+        bool is_fetch = (tag & 16) != 0;
+        uint64_t delta = unzigzag(stride);
+        uint64_t address = streams[stream];
+        for (uint64_t i = 0; i < count; i++) {
+            address += delta;
+            out[produced].address = address;
+            out[produced].is_write = is_write;
+            out[produced].is_fetch = is_fetch;
+            out[produced].pc = 0;   // Not encoded
+            produced++;
+        }
+        streams[stream] = address;
+    }
+    return produced == record_count;
+}
+
+// ---------------------------------------------------------------------------
+// TraceEncoder
+// ---------------------------------------------------------------------------
+
+TraceEncoder::TraceEncoder(size_t records_per_block)
+    : recordsPerBlock(records_per_block == 0 ? 1 :
+                      (records_per_block > TraceCodec::MAX_BLOCK_RECORDS ? TraceCodec::MAX_BLOCK_RECORDS
+                                                                         : records_per_block)),
+      pending{0, 0, false, false, 0}, blockRecords(0), recordCount(0), blockCount(0),
+      tokenCount(0), runCount(0), bytesWritten(0) {
+    resetStreams();
+}
+
+TraceEncoder::~TraceEncoder() {
+    if (output.is_open()) {
+        close();
+    }
+}
+
+bool TraceEncoder::open(const std::string& path) {
+    output.open(path, std::ios::binary | std::ios::trunc);
+    if (!output.is_open()) {
+        return false;
+    }
+    output.write(MAGIC, sizeof(MAGIC));
+    bytesWritten = sizeof(MAGIC);
+    resetStreams();
+    payload.clear();
+    pending.count = 0;
+    blockRecords = 0;
+    recordCount = blockCount = tokenCount = runCount = 0;
+    return static_cast<bool>(output);
+}
+
+void TraceEncoder::resetStreams() {
+    for (size_t i = 0; i < TraceCodec::STREAM_COUNT; i++) {
+        streams[i].last_address = 0;
+        streams[i].last_use = 0;
+    }
+}
+
+size_t TraceEncoder::chooseStream(uint64_t address) const {
+    size_t closest = 0;
+    size_t oldest = 0;
+    for (size_t i = 1; i < TraceCodec::STREAM_COUNT; i++) {
+        if (distance(address, streams[i].last_address) < distance(address, streams[closest].last_address)) {
+            closest = i;
+        }
+        if (streams[i].last_use < streams[oldest].last_use) {
+            oldest = i;
+        }
+    }
+    return distance(address, streams[closest].last_address) <= NEW_STREAM_DISTANCE ? closest : oldest;
+}
+
+void TraceEncoder::add(const TraceRecord& record) {
+    size_t stream = chooseStream(record.address);
+    uint64_t stride = record.address - streams[stream].last_address;
+    streams[stream].last_address = record.address;
+    streams[stream].last_use = ++recordCount;
+
+    if (pending.count > 0 && pending.stream == stream && pending.stride == stride &&
+        pending.is_write == record.is_write && pending.is_fetch == record.is_fetch) {
+        pending.count++;
+    } else {
+        flushRun();
+        pending = PendingRun{stream, stride, record.is_write, record.is_fetch, 1};
+    }
+
+    if (++blockRecords == recordsPerBlock) {
+        flushBlock();
+    }
+}
+
+void TraceEncoder::flushRun() {
+    if (pending.count == 0) {
+        return;
+    }
+    bool has_count = pending.count > 1;
+    putVarint(payload, (has_count ? 1 : 0) | (pending.is_write ? 2 : 0) | (pending.stream << 2) |
+                           (pending.is_fetch ? 16 : 0));
+    putVarint(payload, zigzag(pending.stride));
+    if (has_count) {
+        putVarint(payload, pending.count);
+        runCount++;
+    }
+    tokenCount++;
+    pending.count = 0;
+}
+
+void TraceEncoder::flushBlock() {
+    flushRun();
+    if (blockRecords == 0) {
+        return;
+    }
+
+    char header[8];
+    putU32(header, static_cast<uint32_t>(blockRecords));
+    putU32(header + 4, static_cast<uint32_t>(payload.size()));
+    output.write(header, sizeof(header));
+    output.write(reinterpret_cast<const char*>(payload.data()), payload.size());
+    bytesWritten += sizeof(header) + payload.size();
+    blockCount++;
+
+    // The next block is self-contained
+    payload.clear();
+    blockRecords = 0;
+    resetStreams();
+}
+
+bool TraceEncoder::close() {
+    flushBlock();
+    bool ok = static_cast<bool>(output);
+    output.close();
+    return ok;
+}
+
+// ---------------------------------------------------------------------------
+// TraceDecoder
+// ---------------------------------------------------------------------------
+
+TraceDecoder::TraceDecoder() : recordCount(0), blockCount(0) {
+}
+
+bool TraceDecoder::open(const std::string& path) {
+    close();
+    error.clear();
+    recordCount = 0;
+    blockCount = 0;
+
+    input.open(path, std::ios::binary);
+    if (!input.is_open()) {
+        return false;
+    }
+    char magic[sizeof(MAGIC)];
+    if (!input.read(magic, sizeof(magic)) || !TraceCodec::isMagic(magic)) {
+        error = "not an encoded trace";
+        close();
+        return false;
+    }
+    return true;
+}
+
+void TraceDecoder::close() {
+    if (input.is_open()) {
+        input.close();
+    }
+    input.clear();
+}
+
+bool TraceDecoder::nextChunk(std::vector<TraceRecord>& chunk) {
+    if (!input.is_open() || hasError()) {
+        return false;
+    }
+
+    unsigned char header[TraceCodec::BLOCK_HEADER_BYTES];
+    if (!input.read(reinterpret_cast<char*>(header), sizeof(header))) {
+        if (input.gcount() != 0) {
+            error = "truncated block header";
+        }
+        return false;
+    }
+    uint32_t records, bytes;
+    if (!TraceCodec::parseBlockHeader(header, records, bytes)) {
+        error = "corrupt block header in block " + std::to_string(blockCount);
+        return false;
+    }
+
+    payload.resize(bytes);
+    if (!input.read(reinterpret_cast<char*>(payload.data()), bytes)) {
+        error = "truncated block " + std::to_string(blockCount);
+        return false;
+    }
+
+    chunk.resize(records);
+    if (!TraceCodec::decodeBlock(payload.data(), bytes, records, chunk.data())) {
+        error = "corrupt payload in block " + std::to_string(blockCount);
+        return false;
+    }
+    recordCount += records;
+    blockCount++;
+    return true;
+}
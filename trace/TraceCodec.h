@@ -0,0 +1,127 @@
+#ifndef TRACE_CODEC_H
+#define TRACE_CODEC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "TraceReader.h"
+
+// Compressed binary address trace.
+//
+//   file    := "MSTRACE1" block*
+//   block   := u32 record_count, u32 payload_bytes, payload   (little endian)
+//   payload := token*
+//   token   := varint tag, zigzag varint stride, [varint count]
+//   tag     := has_count | is_write << 1 | stream << 2 | is_fetch << 4
+//
+// A token stands for `count` records (1 when has_count is clear), each one
+// `stride` bytes after the previous address of its stream. The encoder keeps
+// STREAM_COUNT streams (the last address of each) and sends every record
+// through the stream it is closest to, so interleaved sequential walks each
+// keep a small delta, and a run of equal deltas collapses into one token.
+//
+// Streams restart at address 0 at every block boundary, so each block decodes
+// on its own: blocks can be split across threads or skipped without reading
+// their payload.
+//
+// The fetch bit sits above the 2-bit stream number, so traces written before
+// instruction fetches were recorded decode unchanged.
+namespace TraceCodec {
+    const size_t STREAM_COUNT = 4;
+    const size_t DEFAULT_BLOCK_RECORDS = 65536;
+    const size_t MAX_BLOCK_RECORDS = 1 << 22;
+    const size_t MAGIC_BYTES = 8;
+    const size_t BLOCK_HEADER_BYTES = 8;
+
+    // True if the file starts with the encoded-trace magic
+    bool isEncodedTrace(const std::string& path);
+    bool isMagic(const char* bytes);
+
+    // Parses a BLOCK_HEADER_BYTES block header; false if the sizes are implausible
+    bool parseBlockHeader(const unsigned char* header, uint32_t& record_count, uint32_t& payload_bytes);
+
+    // Decodes one block payload into out[0, record_count); false if malformed
+    bool decodeBlock(const uint8_t* payload, size_t payload_bytes,
+                     size_t record_count, TraceRecord* out);
+}
+
+// Writes records into an encoded trace, one block at a time.
+class TraceEncoder {
+public:
+    explicit TraceEncoder(size_t records_per_block = TraceCodec::DEFAULT_BLOCK_RECORDS);
+    ~TraceEncoder();
+
+    bool open(const std::string& path);
+    void add(const TraceRecord& record);
+    // Flushes the last block; false if any write failed
+    bool close();
+
+    size_t getRecordCount() const { return recordCount; }
+    size_t getBlockCount() const { return blockCount; }
+    size_t getTokenCount() const { return tokenCount; }
+    size_t getRunCount() const { return runCount; }
+    uint64_t getBytesWritten() const { return bytesWritten; }
+
+private:
+    struct Stream {
+        uint64_t last_address;
+        size_t last_use;
+    };
+
+    // Records waiting to be emitted as one token
+    struct PendingRun {
+        size_t stream;
+        uint64_t stride;
+        bool is_write;
+        bool is_fetch;
+        size_t count;
+    };
+
+    std::ofstream output;
+    size_t recordsPerBlock;
+    Stream streams[TraceCodec::STREAM_COUNT];
+    PendingRun pending;
+    std::vector<uint8_t> payload;
+    size_t blockRecords;
+
+    size_t recordCount;
+    size_t blockCount;
+    size_t tokenCount;
+    size_t runCount;
+    uint64_t bytesWritten;
+
+    size_t chooseStream(uint64_t address) const;
+    void flushRun();
+    void flushBlock();
+    void resetStreams();
+};
+
+// Reads an encoded trace block by block. Only one block's payload and
+// records are held at a time, so memory stays bounded by the block size.
+class TraceDecoder {
+public:
+    TraceDecoder();
+
+    bool open(const std::string& path);
+    void close();
+
+    // Decodes the next block into `chunk` (resized to the block's record
+    // count). Returns false at end of trace or on a malformed block.
+    bool nextChunk(std::vector<TraceRecord>& chunk);
+
+    bool hasError() const { return !error.empty(); }
+    const std::string& getError() const { return error; }
+    size_t getRecordCount() const { return recordCount; }
+    size_t getBlockCount() const { return blockCount; }
+
+private:
+    std::ifstream input;
+    std::vector<uint8_t> payload;
+    std::string error;
+    size_t recordCount;
+    size_t blockCount;
+};
+
+#endif // TRACE_CODEC_H
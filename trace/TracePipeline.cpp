@@ -0,0 +1,242 @@
+#include "TracePipeline.h"
+#include <fcntl.h>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+
+// How far ahead of the reader the kernel is asked to prefetch
+const uint64_t READAHEAD_BYTES = 8 << 20;
+
+int openReadOnly(const std::string& path) {
+#ifdef _WIN32
+    return _open(path.c_str(), _O_RDONLY | _O_BINARY);
+#else
+    return ::open(path.c_str(), O_RDONLY);
+#endif
+}
+
+void closeFile(int fd) {
+#ifdef _WIN32
+    _close(fd);
+#else
+    ::close(fd);
+#endif
+}
+
+void adviseSequential(int fd) {
+#ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#else
+    (void)fd;
+#endif
+}
+
+void adviseWillNeed(int fd, uint64_t offset, uint64_t length) {
+#ifdef POSIX_FADV_WILLNEED
+    posix_fadvise(fd, static_cast<off_t>(offset), static_cast<off_t>(length), POSIX_FADV_WILLNEED);
+#else
+    (void)fd;
+    (void)offset;
+    (void)length;
+#endif
+}
+
+} // namespace
+
+TracePipeline::TracePipeline(size_t slot_count)
+    : slots(slot_count < 2 ? 2 : slot_count), fd(-1), filled(0), decoded(0), consumed(0),
+      readerDone(false), decoderDone(false), stopRequested(false), holdingSlot(false),
+      recordCount(0), blockCount(0), consumerWaits(0), readerWaits(0) {
+}
+
+TracePipeline::~TracePipeline() {
+    close();
+}
+
+bool TracePipeline::open(const std::string& path) {
+    close();
+    error.clear();
+
+    fd = openReadOnly(path);
+    if (fd < 0) {
+        return false;
+    }
+    char magic[TraceCodec::MAGIC_BYTES];
+    if (readAt(0, magic, sizeof(magic)) != sizeof(magic) || !TraceCodec::isMagic(magic)) {
+        error = "not an encoded trace";
+        close();
+        return false;
+    }
+    adviseSequential(fd);
+
+    readerThread = std::thread(&TracePipeline::readerLoop, this);
+    decoderThread = std::thread(&TracePipeline::decoderLoop, this);
+    return true;
+}
+
+void TracePipeline::close() {
+    stopRequested.store(true, std::memory_order_release);
+    signal();
+    if (readerThread.joinable()) readerThread.join();
+    if (decoderThread.joinable()) decoderThread.join();
+    if (fd >= 0) {
+        closeFile(fd);
+        fd = -1;
+    }
+
+    filled.store(0);
+    decoded.store(0);
+    consumed.store(0);
+    readerDone.store(false);
+    decoderDone.store(false);
+    stopRequested.store(false);
+    readerError.clear();
+    decoderError.clear();
+    holdingSlot = false;
+    recordCount = 0;
+    blockCount = 0;
+    consumerWaits = 0;
+    readerWaits = 0;
+}
+
+size_t TracePipeline::readAt(uint64_t offset, void* buffer, size_t length) {
+    char* out = static_cast<char*>(buffer);
+    size_t total = 0;
+    while (total < length) {
+#ifdef _WIN32
+        // Only the reader thread touches the descriptor, so seek + read is safe
+        size_t remaining = length - total;
+        if (_lseeki64(fd, static_cast<__int64>(offset), SEEK_SET) < 0) break;
+        int n = _read(fd, out, static_cast<unsigned>(remaining > (1u << 30) ? (1u << 30) : remaining));
+#else
+        ssize_t n = pread(fd, out, length - total, static_cast<off_t>(offset));
+#endif
+        if (n <= 0) {
+            break;
+        }
+        out += n;
+        offset += static_cast<uint64_t>(n);
+        total += static_cast<size_t>(n);
+    }
+    return total;
+}
+
+void TracePipeline::readerLoop() {
+    uint64_t offset = TraceCodec::MAGIC_BYTES;
+    uint64_t hintedUpTo = offset;
+    size_t index = 0;
+
+    while (!stopRequested.load(std::memory_order_acquire)) {
+        // Wait for the consumer to hand a slot back
+        if (index - consumed.load(std::memory_order_acquire) >= slots.size()) {
+            readerWaits++;
+            park([this, index] {
+                return stopRequested.load(std::memory_order_acquire) ||
+                       index - consumed.load(std::memory_order_acquire) < slots.size();
+            });
+            continue;
+        }
+
+        if (offset + READAHEAD_BYTES / 2 >= hintedUpTo) {
+            adviseWillNeed(fd, hintedUpTo, READAHEAD_BYTES);
+            hintedUpTo += READAHEAD_BYTES;
+        }
+
+        unsigned char header[TraceCodec::BLOCK_HEADER_BYTES];
+        uint32_t records, bytes;
+        size_t got = readAt(offset, header, sizeof(header));
+        if (got == 0) {
+            break; // End of trace
+        }
+        if (got != sizeof(header)) {
+            readerError = "truncated block header in block " + std::to_string(index);
+            break;
+        }
+        if (!TraceCodec::parseBlockHeader(header, records, bytes)) {
+            readerError = "corrupt block header in block " + std::to_string(index);
+            break;
+        }
+
+        Slot& slot = slots[index % slots.size()];
+        slot.payload.resize(bytes);
+        if (bytes > 0 && readAt(offset + sizeof(header), slot.payload.data(), bytes) != bytes) {
+            readerError = "truncated block " + std::to_string(index);
+            break;
+        }
+        slot.record_count = records;
+        offset += sizeof(header) + bytes;
+
+        filled.store(++index, std::memory_order_release);
+        signal();
+    }
+    readerDone.store(true, std::memory_order_release);
+    signal();
+}
+
+void TracePipeline::decoderLoop() {
+    size_t index = 0;
+
+    while (!stopRequested.load(std::memory_order_acquire)) {
+        if (index == filled.load(std::memory_order_acquire)) {
+            // The reader publishes `filled` before `readerDone`, so re-check
+            if (readerDone.load(std::memory_order_acquire) &&
+                index == filled.load(std::memory_order_acquire)) {
+                decoderError = readerError;
+                break;
+            }
+            park([this, index] {
+                return stopRequested.load(std::memory_order_acquire) ||
+                       index != filled.load(std::memory_order_acquire) ||
+                       readerDone.load(std::memory_order_acquire);
+            });
+            continue;
+        }
+
+        Slot& slot = slots[index % slots.size()];
+        slot.records.resize(slot.record_count);
+        if (!TraceCodec::decodeBlock(slot.payload.data(), slot.payload.size(),
+                                     slot.record_count, slot.records.data())) {
+            decoderError = "corrupt payload in block " + std::to_string(index);
+            break;
+        }
+        decoded.store(++index, std::memory_order_release);
+        signal();
+    }
+    decoderDone.store(true, std::memory_order_release);
+    signal();
+}
+
+const std::vector<TraceRecord>* TracePipeline::next() {
+    if (fd < 0) {
+        return nullptr;
+    }
+    if (holdingSlot) {
+        consumed.store(consumed.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        holdingSlot = false;
+        signal();
+    }
+
+    size_t index = consumed.load(std::memory_order_relaxed);
+    while (index == decoded.load(std::memory_order_acquire)) {
+        if (decoderDone.load(std::memory_order_acquire) &&
+            index == decoded.load(std::memory_order_acquire)) {
+            error = decoderError;
+            return nullptr;
+        }
+        consumerWaits++;
+        park([this, index] {
+            return index != decoded.load(std::memory_order_acquire) ||
+                   decoderDone.load(std::memory_order_acquire);
+        });
+    }
+
+    Slot& slot = slots[index % slots.size()];
+    holdingSlot = true;
+    recordCount += slot.records.size();
+    blockCount++;
+    return &slot.records;
+}
@@ -0,0 +1,108 @@
+#ifndef TRACE_PIPELINE_H
+#define TRACE_PIPELINE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "TraceCodec.h"
+
+// Three-stage ingestion of an encoded trace:
+//
+//   reader thread   - pread()s block headers and payloads (with sequential
+//                     readahead hints) into free slots
+//   decoder thread  - decodes filled slots into TraceRecord chunks
+//   consumer        - the caller of next(), i.e. the simulation loop
+//
+// Slots form a fixed ring. Each stage owns one monotonically increasing
+// counter (filled, decoded, consumed) and only reads the others, so every
+// hand-off is a single-producer/single-consumer step on an atomic with no
+// locks. A stage that has to wait parks on a condition variable, which each
+// stage signals after advancing its counter, instead of spinning. Memory is
+// bounded by the slot count times the block size.
+class TracePipeline {
+public:
+    static const size_t DEFAULT_SLOTS = 4;
+
+    explicit TracePipeline(size_t slots = DEFAULT_SLOTS);
+    ~TracePipeline();
+
+    // Validates the header and starts the reader and decoder threads
+    bool open(const std::string& path);
+    void close();
+
+    // Next decoded chunk, valid until the following call; nullptr at end of
+    // trace or on error. Waits if the decoder has not caught up.
+    const std::vector<TraceRecord>* next();
+
+    bool hasError() const { return !error.empty(); }
+    const std::string& getError() const { return error; }
+    size_t getRecordCount() const { return recordCount; }
+    size_t getBlockCount() const { return blockCount; }
+
+    // Times a stage parked because the ring was empty (consumer) or full (reader)
+    size_t getConsumerWaits() const { return consumerWaits; }
+    size_t getReaderWaits() const { return readerWaits; }
+
+private:
+    struct Slot {
+        std::vector<uint8_t> payload;
+        uint32_t record_count;
+        std::vector<TraceRecord> records;
+    };
+
+    std::vector<Slot> slots;
+    int fd;
+
+    // Stage counters; slot i lives at slots[i % slots.size()]
+    std::atomic<size_t> filled;
+    std::atomic<size_t> decoded;
+    std::atomic<size_t> consumed;
+
+    // Set by a stage once it will produce nothing more; its error (if any)
+    // is written before the flag is released
+    std::atomic<bool> readerDone;
+    std::atomic<bool> decoderDone;
+    std::atomic<bool> stopRequested;
+    std::string readerError;
+    std::string decoderError;
+
+    // Parking for stages that have nothing to do; the counters stay atomic
+    std::mutex parkMutex;
+    std::condition_variable progress;
+
+    std::thread readerThread;
+    std::thread decoderThread;
+    bool holdingSlot;
+
+    std::string error;
+    size_t recordCount;
+    size_t blockCount;
+    size_t consumerWaits;
+    size_t readerWaits;
+
+    void readerLoop();
+    void decoderLoop();
+    // Bytes read at `offset`, short only at end of file or on an error
+    size_t readAt(uint64_t offset, void* buffer, size_t length);
+
+    // Wakes every parked stage; called after a counter or flag changes
+    void signal() {
+        std::lock_guard<std::mutex> lock(parkMutex);
+        progress.notify_all();
+    }
+
+    // Parks until `ready()` holds; it is re-checked under the lock, so a
+    // signal() after the state change cannot be missed
+    template <class Ready>
+    void park(Ready ready) {
+        std::unique_lock<std::mutex> lock(parkMutex);
+        progress.wait(lock, ready);
+    }
+};
+
+#endif // TRACE_PIPELINE_H
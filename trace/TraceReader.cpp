@@ -0,0 +1,112 @@
+#include "TraceReader.h"
+#include <sstream>
+
+TraceReader::TraceReader() : recordCount(0), skippedLines(0), lastFetch(0) {
+}
+
+bool TraceReader::open(const std::string& path) {
+    close();
+    input.open(path);
+    recordCount = 0;
+    skippedLines = 0;
+    lastFetch = 0;
+    return input.is_open();
+}
+
+void TraceReader::close() {
+    if (input.is_open()) {
+        input.close();
+    }
+    input.clear();
+}
+
+bool TraceReader::next(TraceRecord& record) {
+    std::string line;
+    while (std::getline(input, line)) {
+        if (parseLine(line, record)) {
+            recordCount++;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool TraceReader::parseLine(const std::string& line, TraceRecord& record) {
+    std::istringstream iss(line);
+    std::string token;
+    if (!(iss >> token) || token[0] == '#') {
+        return false; // Blank line or comment
+    }
+
+    if (token == "access" && !(iss >> token)) {
+        skippedLines++;
+        return false;
+    }
+
+    // Lackey lines put the type first; the address that follows is bare hex
+    char lackeyType = 0;
+    if (token == "I" || token == "L" || token == "S" || token == "M") {
+        lackeyType = token[0];
+        if (!(iss >> token)) {
+            skippedLines++;
+            return false;
+        }
+        token = token.substr(0, token.find(','));
+    }
+
+    try {
+        size_t consumed = 0;
+        record.address = std::stoull(token, &consumed, lackeyType != 0 ? 16 : 0);
+        if (consumed != token.size()) {
+            skippedLines++;
+            return false;
+        }
+    } catch (const std::exception&) {
+        skippedLines++;
+        return false;
+    }
+
+    if (lackeyType != 0) {
+        record.is_fetch = lackeyType == 'I';
+        record.is_write = lackeyType == 'S' || lackeyType == 'M';
+        if (record.is_fetch) {
+            lastFetch = record.address;
+        }
+        record.pc = lastFetch;
+        return true;
+    }
+
+    // Optional access type, then an optional PC; a missing type is a read
+    std::string type;
+    std::string pcToken;
+    if (iss >> token) {
+        if (token.compare(0, 3, "pc=") == 0) {
+            pcToken = token;
+        } else {
+            type = token;
+            if (iss >> token && token.compare(0, 3, "pc=") == 0) {
+                pcToken = token;
+            }
+        }
+    }
+    record.is_write = type == "w" || type == "W" || type == "write" ||
+                      type == "s" || type == "S" || type == "store";
+    record.is_fetch = type == "i" || type == "I" || type == "fetch";
+    record.pc = 0;
+    if (record.is_fetch) {
+        record.pc = record.address;
+    } else if (!pcToken.empty()) {
+        try {
+            size_t consumed = 0;
+            record.pc = std::stoull(pcToken.substr(3), &consumed, 0);
+            if (consumed != pcToken.size() - 3) {
+                skippedLines++;
+                return false;
+            }
+        } catch (const std::exception&) {
+            skippedLines++;
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,52 @@
+#ifndef TRACE_READER_H
+#define TRACE_READER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+// A single memory reference from an address trace.
+struct TraceRecord {
+    uint64_t address;
+    bool is_write;
+    bool is_fetch;      // Instruction fetch (never also a write)
+    uint64_t pc;        // Instruction that made the reference, 0 if the trace does not say
+};
+
+// Streams records out of a text address trace, one record per line.
+// Accepted line forms (blank lines and '#' comments are skipped):
+//   0x1a40
+//   6720
+//   access 0x1a40        (so CLI workload files can be replayed directly)
+//   0x1a40 w             (optional access type: r/l load (default), w/s store, i fetch)
+//   0x1a40 w pc=0x4005d0 (optional PC of the instruction, after the type)
+//   I 0400d7d4,8         (Valgrind Lackey: I fetch, L load, S store, M modify;
+//                         hex address, size ignored; M counts as a store)
+// A fetch is its own PC; Lackey data references take the PC of the last
+// preceding I line.
+// Records are produced one at a time; the trace is never held in memory.
+class TraceReader {
+public:
+    TraceReader();
+
+    bool open(const std::string& path);
+    bool isOpen() const { return input.is_open(); }
+    void close();
+
+    // Returns false at end of trace.
+    bool next(TraceRecord& record);
+
+    size_t getRecordCount() const { return recordCount; }
+    size_t getSkippedLines() const { return skippedLines; }
+
+private:
+    std::ifstream input;
+    size_t recordCount;
+    size_t skippedLines;
+    uint64_t lastFetch;     // Lackey: address of the last I record
+
+    bool parseLine(const std::string& line, TraceRecord& record);
+};
+
+#endif // TRACE_READER_H